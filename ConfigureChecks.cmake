@@ -98,6 +98,8 @@ include(CheckStructHasMember)
 check_struct_has_member("struct stat"     st_blksize     sys/stat.h   HAVE_STRUCT_STAT_ST_BLKSIZE)
 check_struct_has_member("struct stat"     st_birthtime   sys/stat.h   HAVE_STRUCT_STAT_ST_BIRTHTIME)
 check_struct_has_member("struct stat"     __st_birthtime sys/stat.h   HAVE_STRUCT_STAT___ST_BIRTHTIME)
+check_struct_has_member("struct stat"     st_mtim        sys/stat.h   HAVE_STRUCT_STAT_ST_MTIM)
+check_struct_has_member("struct stat"     st_mtimespec   sys/stat.h   HAVE_STRUCT_STAT_ST_MTIMESPEC)
 check_struct_has_member("struct tm"       tm_zone        time.h       HAVE_STRUCT_TM_TM_ZONE)
 
 #Symbols but NOT enums or types
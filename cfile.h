@@ -60,6 +60,7 @@ struct packet_provider_data {
   frame_data  *prev_cap;
   frame_data_sequence *frames;         /* Sequence of frames, if we're keeping that information */
   GTree       *frames_modified_blocks; /* BST with modified blocks for frames (key = frame_data) */
+  GArray      *frames_time_shifts;     /* Time shifts of frames (nstime_t, index = frame number - 1), or NULL if none */
 };
 
 typedef struct _capture_file {
@@ -83,6 +84,7 @@ typedef struct _capture_file {
   guint32                     marked_count;         /* Number of marked frames */
   guint32                     ignored_count;        /* Number of ignored frames */
   guint32                     ref_time_count;       /* Number of time referenced frames */
+  guint32                     frames_state_gen;     /* Bumped when marks, comments, time references or time shifts change */
   gboolean                    drops_known;          /* TRUE if we know how many packets were dropped */
   guint32                     drops;                /* Dropped packets */
   nstime_t                    elapsed_time;         /* Elapsed time */
@@ -133,6 +135,8 @@ const char *cap_file_provider_get_interface_name(struct packet_provider_data *pr
 const char *cap_file_provider_get_interface_description(struct packet_provider_data *prov, guint32 interface_id);
 wtap_block_t cap_file_provider_get_modified_block(struct packet_provider_data *prov, const frame_data *fd);
 void cap_file_provider_set_modified_block(struct packet_provider_data *prov, frame_data *fd, const wtap_block_t new_block);
+const nstime_t *cap_file_provider_get_time_shift(struct packet_provider_data *prov, const frame_data *fd);
+void cap_file_provider_set_time_shift(struct packet_provider_data *prov, frame_data *fd, const nstime_t *shift);
 
 #ifdef __cplusplus
 }
@@ -19,9 +19,11 @@
 #include <glib.h>
 
 #include <epan/epan.h>
+#include <epan/epan_dissect.h>
 #include <epan/timestamp.h>
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
+#include <epan/proto.h>
 
 #ifdef HAVE_PLUGINS
 #include <wsutil/plugins.h>
@@ -30,16 +32,122 @@
 #include <wsutil/privileges.h>
 #include <wsutil/report_message.h>
 #include <wsutil/wslog.h>
+#include <wsutil/ws_getopt.h>
 
 #include <wiretap/wtap.h>
 
 #include "ui/util.h"
 #include "ui/cmdarg_err.h"
 #include "ui/failure_message.h"
+#include "ui/clopts_common.h"
 
 static void dftest_cmdarg_err(const char *fmt, va_list ap);
 static void dftest_cmdarg_err_cont(const char *fmt, va_list ap);
 
+/*
+ * Add a zero-valued item for a field used by the filter to a protocol
+ * tree, so that the benchmark exercises the comparisons and not only
+ * the field lookup. Fields of other types are left out of the tree.
+ */
+static void
+add_benchmark_field(proto_tree *tree, header_field_info *hfinfo)
+{
+	static const guint8 zero_bytes[FT_ETHER_LEN];
+
+	switch (hfinfo->type) {
+		case FT_PROTOCOL:
+			proto_tree_add_protocol_format(tree, hfinfo->id, NULL, 0, 0, "%s", hfinfo->name);
+			break;
+		case FT_CHAR:
+		case FT_UINT8:
+		case FT_UINT16:
+		case FT_UINT24:
+		case FT_UINT32:
+		case FT_FRAMENUM:
+			proto_tree_add_uint(tree, hfinfo->id, NULL, 0, 0, 0);
+			break;
+		case FT_INT8:
+		case FT_INT16:
+		case FT_INT24:
+		case FT_INT32:
+			proto_tree_add_int(tree, hfinfo->id, NULL, 0, 0, 0);
+			break;
+		case FT_UINT40:
+		case FT_UINT48:
+		case FT_UINT56:
+		case FT_UINT64:
+			proto_tree_add_uint64(tree, hfinfo->id, NULL, 0, 0, 0);
+			break;
+		case FT_INT40:
+		case FT_INT48:
+		case FT_INT56:
+		case FT_INT64:
+			proto_tree_add_int64(tree, hfinfo->id, NULL, 0, 0, 0);
+			break;
+		case FT_IPv4:
+			proto_tree_add_ipv4(tree, hfinfo->id, NULL, 0, 0, 0);
+			break;
+		case FT_ETHER:
+			proto_tree_add_ether(tree, hfinfo->id, NULL, 0, 0, zero_bytes);
+			break;
+		case FT_BYTES:
+			proto_tree_add_bytes(tree, hfinfo->id, NULL, 0, 0, zero_bytes);
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Apply the filter "count" times to a synthetic protocol tree with
+ * each backend and print the time per application. Returns FALSE if
+ * the backends disagree.
+ */
+static gboolean
+run_benchmark(dfilter_t *df, int count)
+{
+	epan_dissect_t	*edt;
+	const int	*fields;
+	int		num_fields, i;
+	gboolean	passed_threaded, passed_interpreted;
+	gint64		start, threaded_us, interpreted_us;
+
+	edt = epan_dissect_new(NULL, TRUE, FALSE);
+	epan_dissect_prime_with_dfilter(edt, df);
+	fields = dfilter_get_interesting_fields(df, &num_fields);
+	for (i = 0; i < num_fields; i++) {
+		add_benchmark_field(edt->tree, proto_registrar_get_nth(fields[i]));
+	}
+
+	passed_threaded = dfilter_apply_edt(df, edt);
+	passed_interpreted = dfilter_apply_edt_interpreted(df, edt);
+	if (passed_threaded != passed_interpreted) {
+		fprintf(stderr, "dftest: backends disagree: threaded %s, interpreted %s\n",
+			passed_threaded ? "TRUE" : "FALSE",
+			passed_interpreted ? "TRUE" : "FALSE");
+	}
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < count; i++) {
+		dfilter_apply_edt_interpreted(df, edt);
+	}
+	interpreted_us = g_get_monotonic_time() - start;
+
+	start = g_get_monotonic_time();
+	for (i = 0; i < count; i++) {
+		dfilter_apply_edt(df, edt);
+	}
+	threaded_us = g_get_monotonic_time() - start;
+
+	printf("\nBenchmark: %d iterations, filter %s\n", count,
+		passed_threaded ? "passes" : "fails");
+	printf("Interpreted: %.1f ns/iteration\n", interpreted_us * 1000.0 / count);
+	printf("Threaded:    %.1f ns/iteration\n", threaded_us * 1000.0 / count);
+
+	epan_dissect_free(edt);
+	return passed_threaded == passed_interpreted;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -59,6 +167,9 @@ main(int argc, char **argv)
 	char		*text;
 	dfilter_t	*df;
 	gchar		*err_msg;
+	int		opt;
+	int		bench_count = 0;
+	int		exit_status = 0;
 
 	cmdarg_err_init(dftest_cmdarg_err, dftest_cmdarg_err_cont);
 
@@ -121,14 +232,26 @@ main(int argc, char **argv)
 	line that its preferences have changed. */
 	prefs_apply_all();
 
+	/* Stop at the first non-option, the filter may start with "-" */
+	while ((opt = ws_getopt(argc, argv, "+b:")) != -1) {
+		switch (opt) {
+			case 'b':	/* Benchmark the backends */
+				bench_count = get_positive_int(ws_optarg, "benchmark iteration count");
+				break;
+			default:
+				fprintf(stderr, "Usage: dftest [-b <count>] <filter>\n");
+				exit(1);
+		}
+	}
+
 	/* Check for filter on command line */
-	if (argc <= 1) {
-		fprintf(stderr, "Usage: dftest <filter>\n");
+	if (argc <= ws_optind) {
+		fprintf(stderr, "Usage: dftest [-b <count>] <filter>\n");
 		exit(1);
 	}
 
 	/* Get filter text */
-	text = get_args_as_string(argc, argv, 1);
+	text = get_args_as_string(argc, argv, ws_optind);
 
 	printf("Filter: %s\n", text);
 
@@ -145,13 +268,16 @@ main(int argc, char **argv)
 
 	if (df == NULL)
 		printf("Filter is empty\n");
-	else
+	else {
 		dfilter_dump(df);
+		if (bench_count > 0 && !run_benchmark(df, bench_count))
+			exit_status = 3;
+	}
 
 	dfilter_free(df);
 	epan_cleanup();
 	g_free(text);
-	exit(0);
+	exit(exit_status);
 }
 
 /*
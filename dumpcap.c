@@ -31,6 +31,15 @@
 #include <signal.h>
 #include <errno.h>
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/if_packet.h>
+#ifdef PACKET_FANOUT
+#define HAVE_PACKET_FANOUT
+#endif
+#endif
+
 #include <ui/cmdarg_err.h>
 #include <wsutil/strtoi.h>
 #include <cli_main.h>
@@ -108,11 +117,18 @@ FILE *debug_log;   /* for logging debug messages to  */
                    /*  is defined                    */
 #endif
 
-static GAsyncQueue *pcap_queue;
-static gint64 pcap_queue_bytes;
-static gint64 pcap_queue_packets;
+/*
+ * These are updated with g_atomic_pointer_add(), so they're pointer-sized;
+ * the packets they count are held in memory, so they can't overflow.
+ */
+static gsize pcap_queue_bytes;
+static gsize pcap_queue_packets;
 static gint64 pcap_queue_byte_limit = 0;
 static gint64 pcap_queue_packet_limit = 0;
+static gsize pcap_queue_seq;               /* next sequence number for a queued packet */
+static GMutex pcap_queue_mtx;
+static GCond pcap_queue_cond;              /* signalled when a packet is queued ... */
+static gint pcap_queue_writer_waiting;     /* ... if the main thread is waiting for one */
 
 static gboolean capture_child = FALSE; /* FALSE: standalone call, TRUE: this is an Wireshark capture child */
 static const char *report_capture_filename = NULL; /* capture child file name */
@@ -178,6 +194,56 @@ typedef struct _pcapng_pipe_info {
 
 struct _loop_data; /* forward declaration so we can use it in the cap_pipe_dispatch function pointer */
 
+/*
+ * When we use threads, each capture thread hands the packets it captures
+ * to the main thread, which writes them, through a ring buffer of its own.
+ * A ring has exactly one producer and one consumer, so neither side needs
+ * to take a lock; packets are copied into the ring once, and written
+ * straight from it.
+ *
+ * The ring holds records, each consisting of a pcap_ring_rec followed by
+ * the packet data, padded to a multiple of 8 bytes.  A record never wraps
+ * around the end of the buffer; if there's no room for it there, the space
+ * at the end is skipped, and is marked with a record with a length of
+ * PCAP_RING_WRAP if there's room for one.
+ *
+ * Without a byte limit the queue is unbounded, as it was when it was a
+ * GAsyncQueue: when a ring fills up, the capture thread starts a new one
+ * twice its size and links it to the full one, and the main thread moves
+ * on to the new ring once it has drained the old one, and frees it.
+ *
+ * The rings are private to dumpcap.  Packets reach Wireshark and TShark
+ * only through the capture file, which they read with ordinary reads;
+ * they need that file for random access to frames and for saving, so
+ * also handing them the packets through shared memory would add a copy
+ * rather than remove one.
+ */
+typedef struct _pcap_ring_rec {
+    gsize                   seq;       /**< Order in which the packets were queued, over all rings */
+    guint32                 len;       /**< Length of the data following this record */
+    union {
+        struct pcap_pkthdr     phdr;
+        pcapng_block_header_t  bh;
+    } u;
+} pcap_ring_rec;
+
+#define PCAP_RING_ALIGN(len)    (((gsize)(len) + 7) & ~(gsize)7)
+#define PCAP_RING_REC_SIZE      PCAP_RING_ALIGN(sizeof(pcap_ring_rec))
+#define PCAP_RING_REC_DATA(rec) ((u_char *)(rec) + PCAP_RING_REC_SIZE)
+#define PCAP_RING_WRAP          G_MAXUINT32
+
+/* Initial size of the data part of the ring if we don't have a byte limit */
+#define PCAP_RING_DEFAULT_SIZE  (16 * 1024 * 1024)
+
+typedef struct _pcap_ring {
+    guint8                     *buf;
+    gsize                       size;      /**< Size of buf, a power of two */
+    gsize                       head;      /**< Bytes published by the capture thread */
+    gsize                       tail;      /**< Bytes released by the main thread */
+    gsize                       reserved;  /**< head once the reserved record is published */
+    struct _pcap_ring          *next;      /**< Ring the capture thread moved on to, if any */
+} pcap_ring;
+
 /*
  * A source of packets from which we're capturing.
  */
@@ -192,9 +258,12 @@ typedef struct _capture_src {
     gboolean                     pcap_err;
     guint                        interface_id;
     GThread                     *tid;
+    pcap_ring                   *ring;                   /**< Ring into which the thread queues packets */
+    pcap_ring                   *ring_out;               /**< Ring from which the main thread writes them */
     int                          snaplen;
     int                          linktype;
     gboolean                     ts_nsec;                /**< TRUE if we're using nanosecond precision. */
+    gint64                       fanout_join_time;       /**< If not 0, when a --fanout member joined its group, in microseconds */
                                                          /**< capture pipe (unix only "input file") */
     gboolean                     from_cap_pipe;          /**< TRUE if we are capturing data from a capture pipe */
     gboolean                     from_cap_socket;        /**< TRUE if we're capturing from socket */
@@ -267,15 +336,6 @@ typedef struct _loop_data {
     int      interval_s;
 } loop_data;
 
-typedef struct _pcap_queue_element {
-    capture_src        *pcap_src;
-    union {
-        struct pcap_pkthdr  phdr;
-        pcapng_block_header_t  bh;
-    } u;
-    u_char             *pd;
-} pcap_queue_element;
-
 /*
  * This needs to be static, so that the SIGINT handler can clear the "go"
  * flag and for saved_shb_idb_lock.
@@ -329,6 +389,7 @@ static capture_options global_capture_opts;
 static GPtrArray *capture_comments = NULL;
 static gboolean quiet = FALSE;
 static gboolean use_threads = FALSE;
+static int fanout_count = 1;     /* number of threads capturing on each interface */
 static guint64 start_time;
 
 static void capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
@@ -443,6 +504,10 @@ print_usage(FILE *output)
     fprintf(output, "  -C <byte_limit>          maximum number of bytes used for buffering packets\n");
     fprintf(output, "                           within dumpcap\n");
     fprintf(output, "  -t                       use a separate thread per interface\n");
+#ifdef HAVE_PACKET_FANOUT
+    fprintf(output, "  --fanout <count>         capture on each interface with <count> threads,\n");
+    fprintf(output, "                           spreading the flows over them\n");
+#endif
     fprintf(output, "  -q                       don't report packet capture counts\n");
     fprintf(output, "  -v, --version            print version information and exit\n");
     fprintf(output, "  -h, --help               display this help and exit\n");
@@ -2756,6 +2821,208 @@ pcapng_pipe_dispatch(loop_data *ld, capture_src *pcap_src, char *errmsg, size_t
     return -1;
 }
 
+#ifdef HAVE_PACKET_FANOUT
+/*
+ * Have the kernel spread the packets of the interface of a capture socket
+ * over all the sockets in a fanout group.  The packets are distributed by
+ * a hash of their flow, so that the packets of a flow stay in order.
+ *
+ * Fanout group IDs are shared by the whole network namespace, so if *group
+ * is 0, a new group is created and *group is set to the ID the kernel gave
+ * it; otherwise, the socket joins group *group.
+ */
+static gboolean
+join_fanout_group(pcap_t *pcap_h, guint16 *group, const char *name,
+                  char *errmsg, size_t errmsg_len)
+{
+    int     fd = pcap_fileno(pcap_h);
+    int     mode = PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_DEFRAG;
+    int     arg;
+    guint16 id;
+    int     tries;
+
+    if (*group == 0) {
+#ifdef PACKET_FANOUT_FLAG_UNIQUEID
+        socklen_t arg_len = sizeof arg;
+
+        arg = (mode | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+        if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof arg) == 0) {
+            if (getsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, &arg_len) == -1) {
+                g_snprintf(errmsg, (gulong) errmsg_len,
+                           "Couldn't get the packet fanout group of %s: %s.", name, g_strerror(errno));
+                return FALSE;
+            }
+            *group = (guint16)(arg & 0xffff);
+            return TRUE;
+        }
+        if (errno != EINVAL) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "Couldn't set up packet fanout on %s: %s.", name, g_strerror(errno));
+            return FALSE;
+        }
+#endif
+        /*
+         * The kernel can't pick an ID (it's older than 4.20); try IDs
+         * until we find one that isn't in use by a group with another mode
+         * or on another interface, or that is full.  A group with the same
+         * mode on the same interface can't be told apart from a new one,
+         * so start at an ID unlikely to be used by another process.
+         */
+        id = (guint16)getpid();
+        for (tries = 0; tries < 64; tries++, id++) {
+            if (id == 0)
+                id++;
+            arg = id | (mode << 16);
+            if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof arg) == 0) {
+                *group = id;
+                return TRUE;
+            }
+            if (errno != EINVAL && errno != ENOSPC)
+                break;
+        }
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "Couldn't set up packet fanout on %s: %s.", name, g_strerror(errno));
+        return FALSE;
+    }
+
+    arg = *group | (mode << 16);
+    if (setsockopt(fd, SOL_PACKET, PACKET_FANOUT, &arg, sizeof arg) == -1) {
+        g_snprintf(errmsg, (gulong) errmsg_len,
+                   "Couldn't set up packet fanout on %s: %s.", name, g_strerror(errno));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ * Open fanout_count - 1 additional capture sources on each network
+ * interface, each of which is read by a thread of its own.  They are
+ * added to ld->pcaps after the sources for capture_opts->ifaces, and
+ * have the interface ID of the interface they capture on.
+ */
+static gboolean
+capture_loop_open_fanout(capture_options *capture_opts, loop_data *ld,
+                         char *errmsg, size_t errmsg_len,
+                         char *secondary_errmsg, size_t secondary_errmsg_len)
+{
+    guint i;
+    int   j;
+
+    for (i = 0; i < capture_opts->ifaces->len; i++) {
+        interface_options *interface_opts = &g_array_index(capture_opts->ifaces, interface_options, i);
+        capture_src       *pcap_src = g_array_index(ld->pcaps, capture_src *, i);
+        guint16            group = 0;
+
+        if (pcap_src->pcap_h == NULL) {
+            /* A capture pipe. */
+            continue;
+        }
+        /*
+         * libpcap doesn't create the socket until the device is activated,
+         * so the additional sockets get every packet on the interface until
+         * they join the group.  Those packets are also delivered to the
+         * group, and are discarded by comparing their time stamps with the
+         * time the socket joined, which only works if the kernel time
+         * stamps them with the system clock.
+         */
+        if (interface_opts->timestamp_type != NULL &&
+            strcmp(interface_opts->timestamp_type, "host") != 0) {
+            g_snprintf(errmsg, (gulong) errmsg_len,
+                       "--fanout can't be used with the \"%s\" time stamp type on %s.",
+                       interface_opts->timestamp_type, interface_opts->name);
+            return FALSE;
+        }
+        if (!join_fanout_group(pcap_src->pcap_h, &group, interface_opts->name,
+                               errmsg, errmsg_len)) {
+            return FALSE;
+        }
+        for (j = 1; j < fanout_count; j++) {
+            cap_device_open_status open_status;
+            gchar                  open_status_str[PCAP_ERRBUF_SIZE];
+            capture_src           *member = g_new0(capture_src, 1);
+
+#ifdef MUST_DO_SELECT
+            member->pcap_fd = -1;
+#endif
+            member->interface_id = i;
+            member->cap_pipe_fd = -1;
+            member->cap_pipe_err = PIPOK;
+            g_array_append_val(ld->pcaps, member);
+
+            member->pcap_h = open_capture_device(capture_opts, interface_opts,
+                CAP_READ_TIMEOUT, &open_status, &open_status_str);
+            if (member->pcap_h == NULL) {
+                get_capture_device_open_failure_messages(open_status,
+                                                         open_status_str,
+                                                         interface_opts->name,
+                                                         errmsg,
+                                                         errmsg_len,
+                                                         secondary_errmsg,
+                                                         secondary_errmsg_len);
+                return FALSE;
+            }
+            if (!set_pcap_datalink(member->pcap_h, interface_opts->linktype,
+                                   interface_opts->name,
+                                   errmsg, errmsg_len,
+                                   secondary_errmsg, secondary_errmsg_len)) {
+                return FALSE;
+            }
+            member->linktype = pcap_src->linktype;
+            member->ts_nsec = pcap_src->ts_nsec;
+            member->snaplen = pcap_snapshot(member->pcap_h);
+#ifdef MUST_DO_SELECT
+            member->pcap_fd = pcap_get_selectable_fd(member->pcap_h);
+#endif
+            if (!join_fanout_group(member->pcap_h, &group, interface_opts->name,
+                                   errmsg, errmsg_len)) {
+                return FALSE;
+            }
+            member->fanout_join_time = g_get_real_time();
+        }
+    }
+    return TRUE;
+}
+#endif
+
+/*
+ * Add up the counters of all the sources capturing on an interface; with
+ * --fanout, there's more than one.  Returns the pcap_t for which
+ * pcap_stats() failed, if it failed for any of them, in which case the
+ * libpcap statistics are incomplete.
+ */
+static pcap_t *
+capture_loop_sum_stats(guint interface_id, struct pcap_stat *stats,
+                       guint32 *received, guint32 *dropped, guint32 *flushed)
+{
+    pcap_t *failed = NULL;
+    guint   i;
+
+    memset(stats, 0, sizeof *stats);
+    *received = 0;
+    *dropped = 0;
+    *flushed = 0;
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        capture_src     *pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+        struct pcap_stat src_stats;
+
+        if (pcap_src->interface_id != interface_id)
+            continue;
+        *received += pcap_src->received;
+        *dropped += pcap_src->dropped;
+        *flushed += pcap_src->flushed;
+        if (pcap_src->pcap_h == NULL)
+            continue;
+        if (pcap_stats(pcap_src->pcap_h, &src_stats) >= 0) {
+            stats->ps_recv += src_stats.ps_recv;
+            stats->ps_drop += src_stats.ps_drop;
+            stats->ps_ifdrop += src_stats.ps_ifdrop;
+        } else if (failed == NULL) {
+            failed = pcap_src->pcap_h;
+        }
+    }
+    return failed;
+}
+
 /** Open the capture input sources; each one is either a pcap device,
  *  a capture pipe, or a capture socket.
  *  Returns TRUE if it succeeds, FALSE otherwise. */
@@ -2961,6 +3228,14 @@ capture_loop_open_input(capture_options *capture_opts, loop_data *ld,
         g_rw_lock_writer_unlock (&ld->saved_shb_idb_lock);
     }
 
+#ifdef HAVE_PACKET_FANOUT
+    if (fanout_count > 1 &&
+        !capture_loop_open_fanout(capture_opts, ld, errmsg, errmsg_len,
+                                  secondary_errmsg, secondary_errmsg_len)) {
+        return FALSE;
+    }
+#endif
+
     /* If not using libcap: we now can now set euid/egid to ruid/rgid         */
     /*  to remove any suid privileges.                                        */
     /* If using libcap: we can now remove NET_RAW and NET_ADMIN capabilities  */
@@ -3263,15 +3538,16 @@ capture_loop_close_output(capture_options *capture_opts, loop_data *ld, int *err
         return ringbuf_libpcap_dump_close(&capture_opts->save_file, err_close);
     } else {
         if (capture_opts->use_pcapng) {
-            for (i = 0; i < global_ld.pcaps->len; i++) {
+            for (i = 0; i < capture_opts->ifaces->len; i++) {
                 pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
                 if (!pcap_src->from_cap_pipe) {
                     guint64 isb_ifrecv, isb_ifdrop;
                     struct pcap_stat stats;
+                    guint32 received, dropped, flushed;
 
-                    if (pcap_stats(pcap_src->pcap_h, &stats) >= 0) {
-                        isb_ifrecv = pcap_src->received;
-                        isb_ifdrop = stats.ps_drop + pcap_src->dropped + pcap_src->flushed;
+                    if (capture_loop_sum_stats(i, &stats, &received, &dropped, &flushed) == NULL) {
+                        isb_ifrecv = received;
+                        isb_ifdrop = stats.ps_drop + dropped + flushed;
                    } else {
                         isb_ifrecv = G_MAXUINT64;
                         isb_ifdrop = G_MAXUINT64;
@@ -3798,44 +4074,198 @@ pcap_read_handler(void* arg)
     return (NULL);
 }
 
-/* Try to pop an item off the packet queue and if it exists, write it */
+static pcap_ring *
+pcap_ring_new(gsize min_size)
+{
+    pcap_ring *ring = g_new0(pcap_ring, 1);
+
+    ring->size = 4096;
+    while (ring->size < min_size)
+        ring->size <<= 1;
+    ring->buf = (guint8 *)g_malloc(ring->size);
+    return ring;
+}
+
+/*
+ * Called by the capture thread.  Start a ring twice the size of the full
+ * one, with room for at least min_size bytes; returns NULL if we're out
+ * of memory.
+ */
+static pcap_ring *
+pcap_ring_grow(pcap_ring *full, gsize min_size)
+{
+    pcap_ring *ring = g_new0(pcap_ring, 1);
+
+    ring->size = full->size << 1;
+    while (ring->size < min_size)
+        ring->size <<= 1;
+    ring->buf = (guint8 *)g_try_malloc(ring->size);
+    if (ring->buf == NULL) {
+        g_free(ring);
+        return NULL;
+    }
+    /* Everything in the full ring has been published already. */
+    g_atomic_pointer_set(&full->next, ring);
+    return ring;
+}
+
+static void
+pcap_ring_free(pcap_ring *ring)
+{
+    g_free(ring->buf);
+    g_free(ring);
+}
+
+/*
+ * Called by the capture thread.  Reserve room for a record with len bytes
+ * of data; returns NULL if the ring doesn't have room for it.
+ */
+static pcap_ring_rec *
+pcap_ring_reserve(pcap_ring *ring, guint32 len)
+{
+    gsize need = PCAP_RING_REC_SIZE + PCAP_RING_ALIGN(len);
+    gsize head = ring->head;
+    gsize tail = (gsize)g_atomic_pointer_get(&ring->tail);
+    gsize off = head & (ring->size - 1);
+    gsize skip = 0;
+    pcap_ring_rec *rec;
+
+    if (ring->size - off < need) {
+        /* It doesn't fit before the end of the buffer; start over at the beginning. */
+        skip = ring->size - off;
+    }
+    if (head + skip + need - tail > ring->size)
+        return NULL;
+
+    if (skip != 0) {
+        if (skip >= PCAP_RING_REC_SIZE)
+            ((pcap_ring_rec *)(ring->buf + off))->len = PCAP_RING_WRAP;
+        head += skip;
+        off = 0;
+    }
+    rec = (pcap_ring_rec *)(ring->buf + off);
+    rec->len = len;
+    ring->reserved = head + need;
+    return rec;
+}
+
+/* Called by the capture thread.  Hand the reserved record to the main thread. */
+static void
+pcap_ring_publish(pcap_ring *ring)
+{
+    g_atomic_pointer_set(&ring->head, ring->reserved);
+}
+
+/* Called by the main thread.  Get the oldest record in the ring, if any. */
+static pcap_ring_rec *
+pcap_ring_peek_one(pcap_ring *ring)
+{
+    gsize head = (gsize)g_atomic_pointer_get(&ring->head);
+
+    while (ring->tail != head) {
+        gsize off = ring->tail & (ring->size - 1);
+        gsize left = ring->size - off;
+        pcap_ring_rec *rec = (pcap_ring_rec *)(ring->buf + off);
+
+        if (left >= PCAP_RING_REC_SIZE && rec->len != PCAP_RING_WRAP)
+            return rec;
+
+        /* Skipped space at the end of the buffer. */
+        g_atomic_pointer_set(&ring->tail, ring->tail + left);
+    }
+    return NULL;
+}
+
+/*
+ * Called by the main thread.  Get the oldest record queued by a capture
+ * thread, if any, moving on to the next ring once the old one is drained.
+ */
+static pcap_ring_rec *
+pcap_ring_peek(capture_src *pcap_src)
+{
+    pcap_ring_rec *rec;
+    pcap_ring *next;
+
+    while ((rec = pcap_ring_peek_one(pcap_src->ring_out)) == NULL) {
+        next = (pcap_ring *)g_atomic_pointer_get(&pcap_src->ring_out->next);
+        if (next == NULL)
+            return NULL;
+        /* The capture thread may have queued more before moving on. */
+        if ((rec = pcap_ring_peek_one(pcap_src->ring_out)) != NULL)
+            return rec;
+        pcap_ring_free(pcap_src->ring_out);
+        pcap_src->ring_out = next;
+    }
+    return rec;
+}
+
+/* Called by the main thread.  Give the space of the record back to the capture thread. */
+static void
+pcap_ring_release(pcap_ring *ring, pcap_ring_rec *rec)
+{
+    g_atomic_pointer_set(&ring->tail, ring->tail + PCAP_RING_REC_SIZE + PCAP_RING_ALIGN(rec->len));
+}
+
+/* Find the packet that was queued first over all capture threads. */
+static pcap_ring_rec *
+capture_loop_queue_oldest(capture_src **oldest_src)
+{
+    pcap_ring_rec *oldest = NULL;
+    guint i;
+
+    for (i = 0; i < global_ld.pcaps->len; i++) {
+        capture_src *pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+        pcap_ring_rec *rec = pcap_ring_peek(pcap_src);
+
+        /* Sequence numbers may wrap around, so compare their difference. */
+        if (rec != NULL && (oldest == NULL || (gssize)(rec->seq - oldest->seq) < 0)) {
+            oldest = rec;
+            *oldest_src = pcap_src;
+        }
+    }
+    return oldest;
+}
+
+/* Try to take the oldest packet off the capture threads' rings and if it exists, write it */
 static gboolean
 capture_loop_dequeue_packet(void) {
-    pcap_queue_element *queue_element;
-
-    g_async_queue_lock(pcap_queue);
-    queue_element = (pcap_queue_element *)g_async_queue_timeout_pop_unlocked(pcap_queue, WRITER_THREAD_TIMEOUT);
-    if (queue_element) {
-        if (queue_element->pcap_src->from_pcapng) {
-            pcap_queue_bytes -= queue_element->u.bh.block_total_length;
-        } else {
-            pcap_queue_bytes -= queue_element->u.phdr.caplen;
+    capture_src   *pcap_src = NULL;
+    pcap_ring_rec *rec;
+
+    rec = capture_loop_queue_oldest(&pcap_src);
+    if (rec == NULL) {
+        /* Nothing queued; wait a while for a capture thread to queue something. */
+        gint64 end_time = g_get_monotonic_time() + WRITER_THREAD_TIMEOUT;
+
+        g_mutex_lock(&pcap_queue_mtx);
+        g_atomic_int_set(&pcap_queue_writer_waiting, 1);
+        while ((rec = capture_loop_queue_oldest(&pcap_src)) == NULL) {
+            if (!g_cond_wait_until(&pcap_queue_cond, &pcap_queue_mtx, end_time))
+                break;
         }
-        pcap_queue_packets -= 1;
+        g_atomic_int_set(&pcap_queue_writer_waiting, 0);
+        g_mutex_unlock(&pcap_queue_mtx);
+        if (rec == NULL)
+            return FALSE;
     }
-    g_async_queue_unlock(pcap_queue);
-    if (queue_element) {
-        if (queue_element->pcap_src->from_pcapng) {
-            ws_info("Dequeued a block of type 0x%08x of length %d captured on interface %d.",
-                  queue_element->u.bh.block_type, queue_element->u.bh.block_total_length,
-                  queue_element->pcap_src->interface_id);
 
-            capture_loop_write_pcapng_cb(queue_element->pcap_src,
-                                        &queue_element->u.bh,
-                                        queue_element->pd);
-        } else {
-            ws_info("Dequeued a packet of length %d captured on interface %d.",
-                queue_element->u.phdr.caplen, queue_element->pcap_src->interface_id);
+    g_atomic_pointer_add(&pcap_queue_bytes, -(gssize)rec->len);
+    g_atomic_pointer_add(&pcap_queue_packets, -1);
 
-            capture_loop_write_packet_cb((u_char *) queue_element->pcap_src,
-                                        &queue_element->u.phdr,
-                                        queue_element->pd);
-        }
-        g_free(queue_element->pd);
-        g_free(queue_element);
-        return TRUE;
+    if (pcap_src->from_pcapng) {
+        ws_info("Dequeued a block of type 0x%08x of length %d captured on interface %d.",
+              rec->u.bh.block_type, rec->u.bh.block_total_length,
+              pcap_src->interface_id);
+
+        capture_loop_write_pcapng_cb(pcap_src, &rec->u.bh, PCAP_RING_REC_DATA(rec));
+    } else {
+        ws_info("Dequeued a packet of length %d captured on interface %d.",
+            rec->u.phdr.caplen, pcap_src->interface_id);
+
+        capture_loop_write_packet_cb((u_char *) pcap_src, &rec->u.phdr, PCAP_RING_REC_DATA(rec));
     }
-    return FALSE;
+    pcap_ring_release(pcap_src->ring_out, rec);
+    return TRUE;
 }
 
 /*
@@ -3926,9 +4356,9 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
                                  secondary_errmsg, sizeof(secondary_errmsg))) {
         goto error;
     }
-    for (i = 0; i < capture_opts->ifaces->len; i++) {
+    for (i = 0; i < global_ld.pcaps->len; i++) {
         pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
-        interface_opts = &g_array_index(capture_opts->ifaces, interface_options, i);
+        interface_opts = &g_array_index(capture_opts->ifaces, interface_options, pcap_src->interface_id);
         /* init the input filter from the network interface (capture pipe will do nothing) */
         /*
          * When remote capturing WinPCap crashes when the capture filter
@@ -3944,7 +4374,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 
         case INITFILTER_BAD_FILTER:
             cfilter_error = TRUE;
-            error_index = i;
+            error_index = pcap_src->interface_id;
             g_snprintf(errmsg, sizeof(errmsg), "%s", pcap_geterr(pcap_src->pcap_h));
             goto error;
 
@@ -4020,11 +4450,22 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     /* WOW, everything is prepared! */
     /* please fasten your seat belts, we will enter now the actual capture loop */
     if (use_threads) {
-        pcap_queue = g_async_queue_new();
         pcap_queue_bytes = 0;
         pcap_queue_packets = 0;
         for (i = 0; i < global_ld.pcaps->len; i++) {
+            gsize ring_size;
+
             pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+            /*
+             * Make the ring big enough to hold as much as the queue limits
+             * allow, plus a packet of the largest size we can get.  Without
+             * a byte limit it grows as needed.
+             */
+            ring_size = pcap_queue_byte_limit ? (gsize)pcap_queue_byte_limit : PCAP_RING_DEFAULT_SIZE;
+            ring_size += (gsize)pcap_queue_packet_limit * PCAP_RING_REC_SIZE;
+            ring_size += PCAP_RING_REC_SIZE + PCAP_RING_ALIGN(MAX((guint)pcap_src->snaplen, pcap_src->cap_pipe_max_pkt_size));
+            pcap_src->ring = pcap_ring_new(ring_size);
+            pcap_src->ring_out = pcap_src->ring;
             /* XXX - Add an interface name here? */
             pcap_src->tid = g_thread_new("Capture read", pcap_read_handler, pcap_src);
         }
@@ -4157,6 +4598,16 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
                 fflush(global_ld.pdh);
             }
         }
+        for (i = 0; i < global_ld.pcaps->len; i++) {
+            pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
+            while (pcap_src->ring_out != NULL) {
+                pcap_ring *next = pcap_src->ring_out->next;
+
+                pcap_ring_free(pcap_src->ring_out);
+                pcap_src->ring_out = next;
+            }
+            pcap_src->ring = NULL;
+        }
     }
 
 
@@ -4166,8 +4617,9 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
     if (autostop_duration_timer != NULL)
         g_timer_destroy(autostop_duration_timer);
 
-    /* did we have a pcap (input) error? */
-    for (i = 0; i < capture_opts->ifaces->len; i++) {
+    /* did we have a pcap (input) error?  With --fanout, an interface
+       has more than one source; check all of them. */
+    for (i = 0; i < global_ld.pcaps->len; i++) {
         pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
         if (pcap_src->pcap_err) {
             /* On Linux, if an interface goes down while you're capturing on it,
@@ -4202,7 +4654,7 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
             char *primary_msg;
             char *secondary_msg;
 
-            interface_opts = &g_array_index(capture_opts->ifaces, interface_options, i);
+            interface_opts = &g_array_index(capture_opts->ifaces, interface_options, pcap_src->interface_id);
             cap_err_str = pcap_geterr(pcap_src->pcap_h);
             if (strcmp(cap_err_str, "The interface went down") == 0 ||
                 strcmp(cap_err_str, "recvfrom: Network is down") == 0) {
@@ -4326,27 +4778,28 @@ capture_loop_start(capture_options *capture_opts, gboolean *stats_known, struct
 
     /* get packet drop statistics from pcap */
     for (i = 0; i < capture_opts->ifaces->len; i++) {
-        guint32 received;
+        guint32 received, dropped, flushed;
         guint32 pcap_dropped = 0;
+        pcap_t *stats_failed;
 
         pcap_src = g_array_index(global_ld.pcaps, capture_src *, i);
         interface_opts = &g_array_index(capture_opts->ifaces, interface_options, i);
-        received = pcap_src->received;
+        /* Get the capture statistics, so we know how many packets were dropped. */
+        stats_failed = capture_loop_sum_stats(i, stats, &received, &dropped, &flushed);
         if (pcap_src->pcap_h != NULL) {
             ws_assert(!pcap_src->from_cap_pipe);
-            /* Get the capture statistics, so we know how many packets were dropped. */
-            if (pcap_stats(pcap_src->pcap_h, stats) >= 0) {
+            if (stats_failed == NULL) {
                 *stats_known = TRUE;
                 /* Let the parent process know. */
                 pcap_dropped += stats->ps_drop;
             } else {
                 g_snprintf(errmsg, sizeof(errmsg),
                            "Can't get packet-drop statistics: %s",
-                           pcap_geterr(pcap_src->pcap_h));
+                           pcap_geterr(stats_failed));
                 report_capture_error(errmsg, please_report_bug());
             }
         }
-        report_packet_drops(received, pcap_dropped, pcap_src->dropped, pcap_src->flushed, stats->ps_ifdrop, interface_opts->display_name);
+        report_packet_drops(received, pcap_dropped, dropped, flushed, stats->ps_ifdrop, interface_opts->display_name);
     }
 
     /* close the input file (pcap or capture pipe) */
@@ -4538,7 +4991,12 @@ capture_loop_write_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
                                        bh->block_total_length,
                                        &global_ld.bytes_written, &err);
 
-        fflush(global_ld.pdh);
+        /*
+         * Don't flush after every block; like packets written by
+         * capture_loop_write_packet_cb(), blocks are flushed by the main
+         * loop, when writing to a pipe or at least every DUMPCAP_UPD_TIME
+         * milliseconds.
+         */
         if (!successful) {
             global_ld.go = FALSE;
             global_ld.err = err;
@@ -4555,6 +5013,7 @@ capture_loop_write_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
             ws_info("Sending SP_FILE on first SHB");
 #endif
             /* SHB is now ready for capture parent to read on SP_FILE message */
+            fflush(global_ld.pdh);
             pipe_write_block(2, SP_FILE, report_capture_filename);
             report_capture_filename = NULL;
         }
@@ -4616,14 +5075,56 @@ capture_loop_write_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
     }
 }
 
+/*
+ * Called by a capture thread.  Reserve room for a packet with len bytes of
+ * data in the thread's ring, if the queue limits allow it; without a byte
+ * limit, start a bigger ring if this one is full.
+ */
+static pcap_ring_rec *
+capture_loop_queue_reserve(capture_src *pcap_src, guint32 len)
+{
+    pcap_ring_rec *rec;
+    pcap_ring *ring;
+
+    if (((pcap_queue_byte_limit != 0) && ((guint64)(gsize)g_atomic_pointer_get(&pcap_queue_bytes) >= (guint64)pcap_queue_byte_limit)) ||
+        ((pcap_queue_packet_limit != 0) && ((guint64)(gsize)g_atomic_pointer_get(&pcap_queue_packets) >= (guint64)pcap_queue_packet_limit))) {
+        return NULL;
+    }
+    rec = pcap_ring_reserve(pcap_src->ring, len);
+    if (rec == NULL && pcap_queue_byte_limit == 0) {
+        ring = pcap_ring_grow(pcap_src->ring, PCAP_RING_REC_SIZE + PCAP_RING_ALIGN(len));
+        if (ring == NULL)
+            return NULL;
+        pcap_src->ring = ring;
+        rec = pcap_ring_reserve(ring, len);
+    }
+    return rec;
+}
+
+/* Called by a capture thread.  Hand the reserved packet to the main thread. */
+static void
+capture_loop_queue_publish(capture_src *pcap_src, pcap_ring_rec *rec)
+{
+    rec->seq = (gsize)g_atomic_pointer_add(&pcap_queue_seq, 1);
+    g_atomic_pointer_add(&pcap_queue_bytes, rec->len);
+    g_atomic_pointer_add(&pcap_queue_packets, 1);
+    pcap_ring_publish(pcap_src->ring);
+
+    /* Wake up the main thread if it's waiting for a packet. */
+    if (g_atomic_int_get(&pcap_queue_writer_waiting)) {
+        g_mutex_lock(&pcap_queue_mtx);
+        g_cond_signal(&pcap_queue_cond);
+        g_mutex_unlock(&pcap_queue_mtx);
+    }
+}
+
 /* one packet was captured, queue it */
 static void
 capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
                              const u_char *pd)
 {
     capture_src        *pcap_src = (capture_src *) (void *) pcap_src_p;
-    pcap_queue_element *queue_element;
-    gboolean            limit_reached;
+    pcap_ring_rec      *rec;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4633,54 +5134,43 @@ capture_loop_queue_packet_cb(u_char *pcap_src_p, const struct pcap_pkthdr *phdr,
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.phdr = *phdr;
-    queue_element->pd = (u_char *)g_malloc(phdr->caplen);
-    if (queue_element->pd == NULL) {
-        pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, phdr->caplen);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = FALSE;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += phdr->caplen;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = TRUE;
+    /* Packets that reached a --fanout member before it joined its group
+       were also delivered to the group; skip them. */
+    if (pcap_src->fanout_join_time != 0) {
+        gint64 ts = (gint64)phdr->ts.tv_sec * G_USEC_PER_SEC +
+                    (pcap_src->ts_nsec ? phdr->ts.tv_usec / 1000 : phdr->ts.tv_usec);
+
+        if (ts <= pcap_src->fanout_join_time) {
+            return;
+        }
+        /* The socket's queue is in arrival order; the rest came later. */
+        pcap_src->fanout_join_time = 0;
     }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
+
+    rec = capture_loop_queue_reserve(pcap_src, phdr->caplen);
+    if (rec == NULL) {
         pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               phdr->caplen, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a packet of length %d captured on interface %u.",
-              phdr->caplen, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" G_GINT64_MODIFIER "d bytes (%" G_GINT64_MODIFIER "d packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    rec->u.phdr = *phdr;
+    memcpy(PCAP_RING_REC_DATA(rec), pd, phdr->caplen);
+    capture_loop_queue_publish(pcap_src, rec);
+
+    pcap_src->received++;
+    ws_info("Queued a packet of length %d captured on interface %u.",
+          phdr->caplen, pcap_src->interface_id);
+    /* The counts may already have changed again, so the output may be wrong */
+    ws_info("Queue size is now %" G_GSIZE_FORMAT " bytes (%" G_GSIZE_FORMAT " packets)",
+          (gsize)g_atomic_pointer_get(&pcap_queue_bytes), (gsize)g_atomic_pointer_get(&pcap_queue_packets));
 }
 
 /* one pcapng block was captured, queue it */
 static void
 capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t *bh, u_char *pd)
 {
-    pcap_queue_element *queue_element;
-    gboolean            limit_reached;
+    pcap_ring_rec      *rec;
 
     /* We may be called multiple times from pcap_dispatch(); if we've set
        the "stop capturing" flag, ignore this packet, as we're not
@@ -4690,46 +5180,23 @@ capture_loop_queue_pcapng_cb(capture_src *pcap_src, const pcapng_block_header_t
         return;
     }
 
-    queue_element = g_new(pcap_queue_element, 1);
-    if (queue_element == NULL) {
-       pcap_src->dropped++;
-       return;
-    }
-    queue_element->pcap_src = pcap_src;
-    queue_element->u.bh = *bh;
-    queue_element->pd = (u_char *)g_malloc(bh->block_total_length);
-    if (queue_element->pd == NULL) {
+    rec = capture_loop_queue_reserve(pcap_src, bh->block_total_length);
+    if (rec == NULL) {
         pcap_src->dropped++;
-        g_free(queue_element);
-        return;
-    }
-    memcpy(queue_element->pd, pd, bh->block_total_length);
-    g_async_queue_lock(pcap_queue);
-    if (((pcap_queue_byte_limit == 0) || (pcap_queue_bytes < pcap_queue_byte_limit)) &&
-        ((pcap_queue_packet_limit == 0) || (pcap_queue_packets < pcap_queue_packet_limit))) {
-        limit_reached = FALSE;
-        g_async_queue_push_unlocked(pcap_queue, queue_element);
-        pcap_queue_bytes += bh->block_total_length;
-        pcap_queue_packets += 1;
-    } else {
-        limit_reached = TRUE;
-    }
-    g_async_queue_unlock(pcap_queue);
-    if (limit_reached) {
-        pcap_src->dropped++;
-        g_free(queue_element->pd);
-        g_free(queue_element);
         ws_info("Dropped a packet of length %d captured on interface %u.",
               bh->block_total_length, pcap_src->interface_id);
-    } else {
-        pcap_src->received++;
-        ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
-              bh->block_type, bh->block_total_length, pcap_src->interface_id);
+        return;
     }
-    /* I don't want to hold the mutex over the debug output. So the
-       output may be wrong */
-    ws_info("Queue size is now %" G_GINT64_MODIFIER "d bytes (%" G_GINT64_MODIFIER "d packets)",
-          pcap_queue_bytes, pcap_queue_packets);
+    rec->u.bh = *bh;
+    memcpy(PCAP_RING_REC_DATA(rec), pd, bh->block_total_length);
+    capture_loop_queue_publish(pcap_src, rec);
+
+    pcap_src->received++;
+    ws_info("Queued a block of type 0x%08x of length %d captured on interface %u.",
+          bh->block_type, bh->block_total_length, pcap_src->interface_id);
+    /* The counts may already have changed again, so the output may be wrong */
+    ws_info("Queue size is now %" G_GSIZE_FORMAT " bytes (%" G_GSIZE_FORMAT " packets)",
+          (gsize)g_atomic_pointer_get(&pcap_queue_bytes), (gsize)g_atomic_pointer_get(&pcap_queue_packets));
 }
 
 static int
@@ -4810,6 +5277,7 @@ get_dumpcap_runtime_info(GString *str)
 #define LONGOPT_IFNAME             LONGOPT_BASE_APPLICATION+1
 #define LONGOPT_IFDESCR            LONGOPT_BASE_APPLICATION+2
 #define LONGOPT_CAPTURE_COMMENT    LONGOPT_BASE_APPLICATION+3
+#define LONGOPT_FANOUT             LONGOPT_BASE_APPLICATION+4
 
 /* And now our feature presentation... [ fade to music ] */
 int
@@ -4824,6 +5292,7 @@ main(int argc, char *argv[])
         {"ifname", ws_required_argument, NULL, LONGOPT_IFNAME},
         {"ifdescr", ws_required_argument, NULL, LONGOPT_IFDESCR},
         {"capture-comment", ws_required_argument, NULL, LONGOPT_CAPTURE_COMMENT},
+        {"fanout", ws_required_argument, NULL, LONGOPT_FANOUT},
         {0, 0, 0, 0 }
     };
 
@@ -5260,6 +5729,14 @@ main(int argc, char *argv[])
         case 'N':
             pcap_queue_packet_limit = get_positive_int(ws_optarg, "packet_limit");
             break;
+        case LONGOPT_FANOUT:
+#ifdef HAVE_PACKET_FANOUT
+            fanout_count = get_positive_int(ws_optarg, "fanout thread count");
+#else
+            cmdarg_err("--fanout is only supported on Linux.");
+            arg_error = TRUE;
+#endif
+            break;
         default:
             cmdarg_err("Invalid Option: %s", argv[ws_optind-1]);
             /* FALLTHROUGH */
@@ -5287,7 +5764,7 @@ main(int argc, char *argv[])
         }
     }
 
-    if ((pcap_queue_byte_limit > 0) || (pcap_queue_packet_limit > 0)) {
+    if ((pcap_queue_byte_limit > 0) || (pcap_queue_packet_limit > 0) || (fanout_count > 1)) {
         use_threads = TRUE;
     }
     if ((pcap_queue_byte_limit == 0) && (pcap_queue_packet_limit == 0)) {
@@ -103,6 +103,8 @@ typedef struct _fd_hash_t {
     guint8     digest[16];
     guint32    len;
     nstime_t   frame_time;
+    gboolean   used;
+    gboolean   out_of_order;    /* Used with -w: older than the entry before it */
 } fd_hash_t;
 
 #define DEFAULT_DUP_DEPTH       5   /* Used with -d */
@@ -112,6 +114,27 @@ static fd_hash_t fd_hash[MAX_DUP_DEPTH];
 static int       dup_window    = DEFAULT_DUP_DEPTH;
 static int       cur_dup_entry = 0;
 
+/*
+ * Index of the entries in fd_hash[], so that checking a frame against
+ * the window doesn't mean comparing it with every entry in the window.
+ * The keys are the digest and length of the frames in the window, the
+ * values how many entries have them and which of those is the newest.
+ */
+typedef struct _fd_hash_index_t {
+    guint8     digest[16];
+    guint32    len;
+    guint      count;
+    int        newest;
+} fd_hash_index_t;
+
+static GHashTable *fd_hash_index = NULL;
+
+/*
+ * Number of entries in the window, other than the oldest one, with a time
+ * stamp older than that of the entry before them (-w only).
+ */
+static guint fd_hash_out_of_order = 0;
+
 static guint32   ignored_bytes  = 0;  /* Used with -I */
 
 #define ONE_BILLION 1000000000
@@ -582,27 +605,118 @@ remove_vlan_info(const wtap_packet_header *phdr, guint8* fd, guint32* len) {
     }
 }
 
+static guint
+fd_hash_index_hash(gconstpointer key)
+{
+    const fd_hash_index_t *entry = (const fd_hash_index_t *)key;
+
+    /* The digest is already well distributed. */
+    return pntoh32(entry->digest) ^ entry->len;
+}
+
 static gboolean
-is_duplicate(guint8* fd, guint32 len) {
-    int i;
-    const struct ieee80211_radiotap_header* tap_header;
+fd_hash_index_equal(gconstpointer a, gconstpointer b)
+{
+    const fd_hash_index_t *entry_a = (const fd_hash_index_t *)a;
+    const fd_hash_index_t *entry_b = (const fd_hash_index_t *)b;
 
-    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
-    guint32 offset = ignored_bytes;
-    guint32 new_len;
-    guint8 *new_fd;
+    return entry_a->len == entry_b->len
+        && memcmp(entry_a->digest, entry_b->digest, 16) == 0;
+}
 
-    if (len <= ignored_bytes) {
-        offset = 0;
+static fd_hash_index_t *
+fd_hash_index_lookup(int slot)
+{
+    fd_hash_index_t key;
+
+    memcpy(key.digest, fd_hash[slot].digest, 16);
+    key.len = fd_hash[slot].len;
+    return (fd_hash_index_t *)g_hash_table_lookup(fd_hash_index, &key);
+}
+
+/* Forget the frame in fd_hash[slot], which is about to be overwritten. */
+static void
+fd_hash_index_remove(int slot)
+{
+    fd_hash_index_t *entry;
+
+    if (!fd_hash[slot].used)
+        return;
+
+    entry = fd_hash_index_lookup(slot);
+    ws_assert(entry != NULL);
+    if (--entry->count == 0)
+        g_hash_table_remove(fd_hash_index, entry);
+}
+
+/*
+ * Add the frame in fd_hash[slot], and return whether there is an earlier
+ * frame with the same digest and length; *prev_newest is set to the
+ * newest such frame.
+ */
+static gboolean
+fd_hash_index_add(int slot, int *prev_newest)
+{
+    fd_hash_index_t *entry;
+
+    fd_hash[slot].used = TRUE;
+
+    entry = fd_hash_index_lookup(slot);
+    if (entry == NULL) {
+        entry = g_new(fd_hash_index_t, 1);
+        memcpy(entry->digest, fd_hash[slot].digest, 16);
+        entry->len    = fd_hash[slot].len;
+        entry->count  = 0;
+        entry->newest = -1;
+        g_hash_table_insert(fd_hash_index, entry, entry);
     }
+    *prev_newest = entry->newest;
+    entry->count++;
+    entry->newest = slot;
 
-    /* Get the size of radiotap header and use that as offset (-p option) */
-    if (skip_radiotap == TRUE) {
-        tap_header = (const struct ieee80211_radiotap_header*)fd;
-        offset = pletoh16(&tap_header->it_len);
-        if (offset >= len)
-            offset = 0;
+    return entry->count > 1;
+}
+
+/*
+ * Note whether the frame about to be put in fd_hash[slot] is older than
+ * the one before it.
+ */
+static void
+fd_hash_track_order(int slot, const nstime_t *frame_time)
+{
+    int prev_slot = (slot > 0) ? slot - 1 : dup_window - 1;
+    int oldest = (slot + 1 < dup_window) ? slot + 1 : 0;
+
+    if (fd_hash[slot].out_of_order) {
+        fd_hash[slot].out_of_order = FALSE;
+        fd_hash_out_of_order--;
     }
+    /*
+     * The entry after this one becomes the oldest one in the window, so
+     * the entry we're replacing no longer matters to it.
+     */
+    if (oldest != slot && fd_hash[oldest].out_of_order) {
+        fd_hash[oldest].out_of_order = FALSE;
+        fd_hash_out_of_order--;
+    }
+    if (prev_slot != slot && fd_hash[prev_slot].used
+        && nstime_cmp(frame_time, &fd_hash[prev_slot].frame_time) < 0) {
+        fd_hash[slot].out_of_order = TRUE;
+        fd_hash_out_of_order++;
+    }
+}
+
+/*
+ * Put the digest (and time, if given) of the frame in the next entry of
+ * fd_hash[], and return whether a frame with the same digest and length
+ * is in the window; if so, *prev is set to the newest such frame.
+ */
+static gboolean
+add_dup_entry(guint8* fd, guint32 len, guint32 offset,
+              const nstime_t *frame_time, int *prev)
+{
+    guint32 new_len;
+    guint8 *new_fd;
 
     new_fd  = &fd[offset];
     new_len = len - (offset);
@@ -611,77 +725,83 @@ is_duplicate(guint8* fd, guint32 len) {
     if (cur_dup_entry >= dup_window)
         cur_dup_entry = 0;
 
+    fd_hash_index_remove(cur_dup_entry);
+
     /* Calculate our digest */
     gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
 
     fd_hash[cur_dup_entry].len = len;
+    if (frame_time) {
+        fd_hash_track_order(cur_dup_entry, frame_time);
+        fd_hash[cur_dup_entry].frame_time = *frame_time;
+    }
 
-    /* Look for duplicates */
-    for (i = 0; i < dup_window; i++) {
-        if (i == cur_dup_entry)
-            continue;
+    return fd_hash_index_add(cur_dup_entry, prev);
+}
 
-        if (fd_hash[i].len == fd_hash[cur_dup_entry].len
-            && memcmp(fd_hash[i].digest, fd_hash[cur_dup_entry].digest, 16) == 0) {
-            return TRUE;
-        }
+static gboolean
+is_duplicate(guint8* fd, guint32 len) {
+    const struct ieee80211_radiotap_header* tap_header;
+    int prev;
+
+    /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
+    guint32 offset = ignored_bytes;
+
+    if (len <= ignored_bytes) {
+        offset = 0;
     }
 
-    return FALSE;
+    /* Get the size of radiotap header and use that as offset (-p option) */
+    if (skip_radiotap == TRUE) {
+        tap_header = (const struct ieee80211_radiotap_header*)fd;
+        offset = pletoh16(&tap_header->it_len);
+        if (offset >= len)
+            offset = 0;
+    }
+
+    /* Look for duplicates */
+    return add_dup_entry(fd, len, offset, NULL, &prev);
 }
 
 static gboolean
 is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
-    int i;
+    int i, prev;
+    nstime_t delta;
+    int cmp;
 
     /*Hint to ignore some bytes at the start of the frame for the digest calculation(-I option) */
     guint32 offset = ignored_bytes;
-    guint32 new_len;
-    guint8 *new_fd;
 
     if (len <= ignored_bytes) {
         offset = 0;
     }
 
-    new_fd  = &fd[offset];
-    new_len = len - (offset);
-
-    cur_dup_entry++;
-    if (cur_dup_entry >= dup_window)
-        cur_dup_entry = 0;
-
-    /* Calculate our digest */
-    gcry_md_hash_buffer(GCRY_MD_MD5, fd_hash[cur_dup_entry].digest, new_fd, new_len);
+    if (!add_dup_entry(fd, len, offset, current, &prev))
+        return FALSE;
 
-    fd_hash[cur_dup_entry].len = len;
-    fd_hash[cur_dup_entry].frame_time.secs = current->secs;
-    fd_hash[cur_dup_entry].frame_time.nsecs = current->nsecs;
+    /*
+     * There is a frame with the same digest in the fd_hash[] cache.
+     *
+     * If the time stamps of the frames in the cache, including the
+     * current one, are in chronological order, the scan below would
+     * see the deltas grow as it goes back, and stop at the newest frame
+     * with the same digest; so it's a duplicate if that frame is within
+     * the dup time window.
+     */
+    if (fd_hash_out_of_order == 0) {
+        nstime_delta(&delta, current, &fd_hash[prev].frame_time);
+        return nstime_cmp(&delta, &relative_time_window) <= 0;
+    }
 
     /*
      * Look for relative time related duplicates.
-     * This is hopefully a reasonably efficient mechanism for
-     * finding duplicates by rel time in the fd_hash[] cache.
      * We check starting from the most recently added hash
      * entries and work backwards towards older packets.
      * This approach allows the dup test to be terminated
      * when the relative time of a cached entry is found to
      * be beyond the dup time window.
-     *
-     * Of course this assumes that the input trace file is
-     * "well-formed" in the sense that the packet timestamps are
-     * in strict chronologically increasing order (which is NOT
-     * always the case!!).
-     *
-     * The fd_hash[] table was deliberately created large (1,000,000).
-     * Looking for time related duplicates in large trace files with
-     * non-fractional dup time window values can potentially take
-     * a long time to complete.
      */
-
     for (i = cur_dup_entry - 1;; i--) {
-        nstime_t delta;
-        int cmp;
-
         if (i < 0)
             i = dup_window - 1;
 
@@ -693,7 +813,7 @@ is_duplicate_rel_time(guint8* fd, guint32 len, const nstime_t *current) {
             break;
         }
 
-        if (nstime_is_unset(&(fd_hash[i].frame_time))) {
+        if (!fd_hash[i].used) {
             /*
              * We've decremented to an unused fd_hash[] entry.
              * Check no more!
@@ -1741,7 +1861,11 @@ main(int argc, char *argv[])
             memset(&fd_hash[i].digest, 0, 16);
             fd_hash[i].len = 0;
             nstime_set_unset(&fd_hash[i].frame_time);
+            fd_hash[i].used = FALSE;
+            fd_hash[i].out_of_order = FALSE;
         }
+        fd_hash_index = g_hash_table_new_full(fd_hash_index_hash,
+                                              fd_hash_index_equal, g_free, NULL);
     }
 
     /* Set up an array of all IDBs seen */
@@ -2320,6 +2444,8 @@ clean_exit:
         }
         g_array_free(idbs_seen, TRUE);
     }
+    if (fd_hash_index != NULL)
+        g_hash_table_destroy(fd_hash_index);
     g_free(params.idb_inf);
     wtap_dump_params_cleanup(&params);
     if (wth != NULL)
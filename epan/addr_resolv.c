@@ -225,6 +225,15 @@ static wmem_map_t *eth_hashtable = NULL;
 static wmem_map_t *serv_port_hashtable = NULL;
 static GHashTable *enterprises_hashtable = NULL;
 
+/*
+ * The services, manuf, wka and enterprises files have tens of thousands
+ * of entries between them, and many runs never look any of them up; the
+ * files are read on the first lookup rather than in addr_resolv_init().
+ */
+static gboolean services_loaded = FALSE;
+static gboolean manuf_loaded = FALSE;
+static gboolean enterprises_loaded = FALSE;
+
 static subnet_length_entry_t subnet_length_entries[SUBNETLENGTHSIZE]; /* Ordered array of entries */
 static gboolean have_subnet_entry = FALSE;
 
@@ -234,6 +243,8 @@ static GPtrArray* extra_hosts_files = NULL;
 
 static hashether_t *add_eth_name(const guint8 *addr, const gchar *name);
 static void add_serv_port_cb(const guint32 port, gpointer ptr);
+static void load_services(void);
+static void load_manuf(void);
 
 /* http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx#existing
  * One-at-a-Time hash
@@ -765,6 +776,7 @@ _serv_name_lookup(port_type proto, guint port, serv_port_t **value_ret)
 {
     serv_port_t *serv_port_table;
 
+    load_services();
     serv_port_table = (serv_port_t *)wmem_map_lookup(serv_port_hashtable, GUINT_TO_POINTER(port));
 
     if (value_ret != NULL)
@@ -818,9 +830,19 @@ serv_name_lookup(port_type proto, guint port)
 static void
 initialize_services(void)
 {
-    gboolean parse_file = TRUE;
     ws_assert(serv_port_hashtable == NULL);
     serv_port_hashtable = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
+    services_loaded = FALSE;
+}
+
+static void
+load_services(void)
+{
+    gboolean parse_file = TRUE;
+
+    if (services_loaded || serv_port_hashtable == NULL)
+        return;
+    services_loaded = TRUE;
 
     /* Compute the pathname of the services file. */
     if (g_services_path == NULL) {
@@ -909,11 +931,11 @@ initialize_enterprises(void)
 {
     ws_assert(enterprises_hashtable == NULL);
     enterprises_hashtable = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+    enterprises_loaded = FALSE;
 
     if (g_enterprises_path == NULL) {
         g_enterprises_path = get_datafile_path(ENAME_ENTERPRISES);
     }
-    parse_enterprises_file(g_enterprises_path);
 
     if (g_penterprises_path == NULL) {
         /* Check profile directory before personal configuration */
@@ -923,12 +945,23 @@ initialize_enterprises(void)
             g_penterprises_path = get_persconffile_path(ENAME_ENTERPRISES, FALSE);
         }
     }
+}
+
+static void
+load_enterprises(void)
+{
+    if (enterprises_loaded || enterprises_hashtable == NULL)
+        return;
+    enterprises_loaded = TRUE;
+
+    parse_enterprises_file(g_enterprises_path);
     parse_enterprises_file(g_penterprises_path);
 }
 
 const gchar *
 try_enterprises_lookup(guint32 value)
 {
+    load_enterprises();
     return (const gchar *)g_hash_table_lookup(enterprises_hashtable, GUINT_TO_POINTER(value));
 }
 
@@ -1622,6 +1655,7 @@ manuf_name_lookup(const guint8 *addr)
     oct = addr[2];
     manuf_key = manuf_key | oct;
 
+    load_manuf();
 
     /* first try to find a "perfect match" */
     manuf_value = (hashmanuf_t*)wmem_map_lookup(manuf_hashtable, GUINT_TO_POINTER(manuf_key));
@@ -1658,6 +1692,8 @@ wka_name_lookup(const guint8 *addr, const unsigned int mask)
     if (wka_hashtable == NULL) {
         return NULL;
     }
+    load_manuf();
+
     /* Get the part of the address covered by the mask. */
     for (i = 0, num = mask; num >= 8; i++, num -= 8)
         masked_addr[i] = addr[i];   /* copy octets entirely covered by the mask */
@@ -1705,9 +1741,6 @@ eth_addr_cmp(gconstpointer a, gconstpointer b)
 static void
 initialize_ethers(void)
 {
-    ether_t *eth;
-    guint    mask = 0;
-
     /* hash table initialization */
     wka_hashtable   = wmem_map_new(wmem_epan_scope(), eth_addr_hash, eth_addr_cmp);
     manuf_hashtable = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
@@ -1734,25 +1767,39 @@ initialize_ethers(void)
     if (g_manuf_path == NULL)
         g_manuf_path = get_datafile_path(ENAME_MANUF);
 
-    /* Read it and initialize the hash table */
+    /* Compute the pathname of the wka file */
+    if (g_wka_path == NULL)
+        g_wka_path = get_datafile_path(ENAME_WKA);
+
+    manuf_loaded = FALSE;
+} /* initialize_ethers */
+
+static void
+load_manuf(void)
+{
+    ether_t *eth;
+    guint    mask = 0;
+
+    if (manuf_loaded || manuf_hashtable == NULL)
+        return;
+    /* Set first; add_manuf_name() calls add_eth_name(), which calls us. */
+    manuf_loaded = TRUE;
+
+    /* Read the manuf file and initialize the hash table */
     set_ethent(g_manuf_path);
     while ((eth = get_ethent(&mask, TRUE))) {
         add_manuf_name(eth->addr, mask, eth->name, eth->longname);
     }
     end_ethent();
 
-    /* Compute the pathname of the wka file */
-    if (g_wka_path == NULL)
-        g_wka_path = get_datafile_path(ENAME_WKA);
-
-    /* Read it and initialize the hash table */
+    /* Read the wka file and initialize the hash table */
     set_ethent(g_wka_path);
     while ((eth = get_ethent(&mask, TRUE))) {
         add_manuf_name(eth->addr, mask, eth->name, eth->longname);
     }
     end_ethent();
 
-} /* initialize_ethers */
+} /* load_manuf */
 
 static void
 ethers_cleanup(void)
@@ -1901,6 +1948,7 @@ add_eth_name(const guint8 *addr, const gchar *name)
 {
     hashether_t *tp;
 
+    load_manuf();
     tp = (hashether_t *)wmem_map_lookup(eth_hashtable, addr);
 
     if (tp == NULL) {
@@ -1921,6 +1969,10 @@ eth_name_lookup(const guint8 *addr, const gboolean resolve)
 {
     hashether_t  *tp;
 
+    /* Without resolution only the hex string is used; don't read the
+     * ethers, manuf and wka files for it. */
+    if (resolve)
+        load_manuf();
     tp = (hashether_t *)wmem_map_lookup(eth_hashtable, addr);
 
     if (tp == NULL) {
@@ -3413,6 +3465,7 @@ get_manuf_name_if_known(const guint8 *addr)
     oct = addr[2];
     manuf_key = manuf_key | oct;
 
+    load_manuf();
     manuf_value = (hashmanuf_t *)wmem_map_lookup(manuf_hashtable, GUINT_TO_POINTER(manuf_key));
     if ((manuf_value == NULL) || (manuf_value->status == HASHETHER_STATUS_UNRESOLVED)) {
         return NULL;
@@ -3427,6 +3480,7 @@ uint_get_manuf_name_if_known(const guint manuf_key)
 {
     hashmanuf_t *manuf_value;
 
+    load_manuf();
     manuf_value = (hashmanuf_t *)wmem_map_lookup(manuf_hashtable, GUINT_TO_POINTER(manuf_key));
     if ((manuf_value == NULL) || (manuf_value->status == HASHETHER_STATUS_UNRESOLVED)) {
         return NULL;
@@ -3605,24 +3659,28 @@ get_host_ipaddr6(const char *host, ws_in6_addr *addrp)
 wmem_map_t *
 get_manuf_hashtable(void)
 {
+    load_manuf();
     return manuf_hashtable;
 }
 
 wmem_map_t *
 get_wka_hashtable(void)
 {
+    load_manuf();
     return wka_hashtable;
 }
 
 wmem_map_t *
 get_eth_hashtable(void)
 {
+    load_manuf();
     return eth_hashtable;
 }
 
 wmem_map_t *
 get_serv_port_hashtable(void)
 {
+    load_services();
     return serv_port_hashtable;
 }
 
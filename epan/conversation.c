@@ -168,32 +168,51 @@ conversation_create_from_template(conversation_t *conversation, const address *a
 }
 
 /*
- * Compute the hash value for two given address/port pairs if the match
- * is to be exact.
+ * Compute the hash value for one address/port pair.
  */
 /* https://web.archive.org/web/20070615045827/http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx#existing
  * (formerly at http://eternallyconfuzzled.com/tuts/algorithms/jsw_tut_hashing.aspx#existing)
  * One-at-a-Time hash
  */
-guint
-conversation_hash_exact(gconstpointer v)
+static guint
+conversation_hash_endpoint(const address *addr, guint32 port)
 {
-	const conversation_key_t key = (const conversation_key_t)v;
 	guint hash_val;
 	address tmp_addr;
 
 	hash_val = 0;
 	tmp_addr.len  = 4;
 
-	hash_val = add_address_to_hash(hash_val, &key->addr1);
+	hash_val = add_address_to_hash(hash_val, addr);
 
-	tmp_addr.data = &key->port1;
+	tmp_addr.data = &port;
 	hash_val = add_address_to_hash(hash_val, &tmp_addr);
 
-	hash_val = add_address_to_hash(hash_val, &key->addr2);
+	return hash_val;
+}
 
-	tmp_addr.data = &key->port2;
-	hash_val = add_address_to_hash(hash_val, &tmp_addr);
+/*
+ * Compute the hash value for two given address/port pairs if the match
+ * is to be exact.
+ *
+ * conversation_match_exact() matches the two pairs in either order, so
+ * the pairs are hashed in a canonical order: both directions of a
+ * conversation then land in the same hash chain, and find_conversation()
+ * needs a single lookup instead of one per direction.
+ */
+guint
+conversation_hash_exact(gconstpointer v)
+{
+	const conversation_key_t key = (const conversation_key_t)v;
+	guint hash_val, hash_1, hash_2;
+
+	hash_1 = conversation_hash_endpoint(&key->addr1, key->port1);
+	hash_2 = conversation_hash_endpoint(&key->addr2, key->port2);
+
+	if (hash_1 <= hash_2)
+		hash_val = hash_1 * 31 + hash_2;
+	else
+		hash_val = hash_2 * 31 + hash_1;
 
 	hash_val += ( hash_val << 3 );
 	hash_val ^= ( hash_val >> 11 );
@@ -850,6 +869,13 @@ conversation_lookup_hashtable(wmem_map_t *hashtable, const guint32 frame_num, co
 	conversation_t* chain_head=NULL;
 	struct conversation_key key;
 
+	/*
+	 * Most captures never use some of the wildcard tables; don't
+	 * bother hashing the key for those.
+	 */
+	if (wmem_map_size(hashtable) == 0)
+		return NULL;
+
 	/*
 	 * We don't make a copy of the address data, we just copy the
 	 * pointer to it, as "key" disappears when we return.
@@ -947,19 +973,15 @@ find_conversation(const guint32 frame_num, const address *addr_a, const address
 		 */
 		DPRINT(("trying exact match: %s:%d -> %s:%d",
 		    addr_a_str, port_a, addr_b_str, port_b));
+		/*
+		 * The exact match table hashes and matches both
+		 * directions of a conversation alike, so this also
+		 * finds conversations set up from B to A.
+		 */
 		conversation =
 		    conversation_lookup_hashtable(conversation_hashtable_exact,
 			frame_num, addr_a, addr_b, etype,
 			port_a, port_b);
-		/* Didn't work, try the other direction */
-		if (conversation == NULL) {
-			DPRINT(("trying exact match: %s:%d -> %s:%d",
-			    addr_b_str, port_b, addr_a_str, port_a));
-			conversation =
-			    conversation_lookup_hashtable(conversation_hashtable_exact,
-				frame_num, addr_b, addr_a, etype,
-				port_b, port_a);
-		}
 		if ((conversation == NULL) && (addr_a->type == AT_FC)) {
 			/* In Fibre channel, OXID & RXID are never swapped as
 			 * TCP/UDP ports are in TCP/IP.
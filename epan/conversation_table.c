@@ -565,6 +565,79 @@ add_conversation_table_data(conv_hash_t *ch, const address *src, const address *
     add_conversation_table_data_with_conv_id(ch, src, dst, src_port, dst_port, CONV_ID_UNSET, num_frames, num_bytes, ts, abs_ts, ct_info, etype);
 }
 
+/* Look up a conversation in either direction; if found, *is_fwd_direction
+ * is set to TRUE if src is its source address. */
+static conv_item_t *
+find_conversation_item(conv_hash_t *ch, const address *src, const address *dst, guint32 src_port, guint32 dst_port,
+        conv_id_t conv_id, gboolean *is_fwd_direction)
+{
+    conv_key_t existing_key;
+    gpointer conversation_idx_hash_val;
+
+    *is_fwd_direction = FALSE;
+    if (ch->conv_array == NULL) {
+        return NULL;
+    }
+
+    /* first, check in the fwd conversations */
+    existing_key.addr1 = *src;
+    existing_key.addr2 = *dst;
+    existing_key.port1 = src_port;
+    existing_key.port2 = dst_port;
+    existing_key.conv_id = conv_id;
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
+        /* a conversation was found in this same fwd direction */
+        *is_fwd_direction = TRUE;
+        return &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+    }
+
+    /* then, check in the rev conversations if not found in 'fwd' */
+    existing_key.addr1 = *dst;
+    existing_key.addr2 = *src;
+    existing_key.port1 = dst_port;
+    existing_key.port2 = src_port;
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
+        return &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+    }
+
+    return NULL;
+}
+
+/* Append a new conversation to the end of the list. The table takes
+ * over the addresses of new_conv_item. */
+static conv_item_t *
+append_conversation_item(conv_hash_t *ch, conv_item_t *new_conv_item)
+{
+    conv_key_t *new_key;
+    conv_item_t *conv_item;
+    unsigned int conversation_idx;
+
+    /* if we don't have any entries at all yet */
+    if (ch->conv_array == NULL) {
+        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
+
+        ch->hashtable = g_hash_table_new_full(conversation_hash,
+                                              conversation_equal, /* key_equal_func */
+                                              g_free,             /* key_destroy_func */
+                                              NULL);              /* value_destroy_func */
+    }
+
+    g_array_append_val(ch->conv_array, *new_conv_item);
+    conversation_idx = ch->conv_array->len - 1;
+    conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+
+    /* ct->conversations address is not a constant but src/dst_address.data are */
+    new_key = g_new(conv_key_t, 1);
+    set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
+    set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
+    new_key->port1 = conv_item->src_port;
+    new_key->port2 = conv_item->dst_port;
+    new_key->conv_id = conv_item->conv_id;
+    g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
+
+    return conv_item;
+}
+
 void
 add_conversation_table_data_with_conv_id(
     conv_hash_t *ch,
@@ -580,52 +653,16 @@ add_conversation_table_data_with_conv_id(
     ct_dissector_info_t *ct_info,
     endpoint_type etype)
 {
-    conv_item_t *conv_item = NULL;
-    gboolean is_fwd_direction = FALSE; /* direction of any conversation found */
+    conv_item_t *conv_item;
+    gboolean is_fwd_direction; /* direction of any conversation found */
 
-    /* if we don't have any entries at all yet */
-    if (ch->conv_array == NULL) {
-        ch->conv_array = g_array_sized_new(FALSE, FALSE, sizeof(conv_item_t), 10000);
-
-        ch->hashtable = g_hash_table_new_full(conversation_hash,
-                                              conversation_equal, /* key_equal_func */
-                                              g_free,             /* key_destroy_func */
-                                              NULL);              /* value_destroy_func */
-
-    } else { /* try to find it among the existing known conversations */
-        /* first, check in the fwd conversations */
-        conv_key_t existing_key;
-        gpointer conversation_idx_hash_val;
-
-        existing_key.addr1 = *src;
-        existing_key.addr2 = *dst;
-        existing_key.port1 = src_port;
-        existing_key.port2 = dst_port;
-        existing_key.conv_id = conv_id;
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-        }
-        if (conv_item == NULL) {
-            /* then, check in the rev conversations if not found in 'fwd' */
-            existing_key.addr1 = *dst;
-            existing_key.addr2 = *src;
-            existing_key.port1 = dst_port;
-            existing_key.port2 = src_port;
-            if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-                conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
-            }
-        } else {
-            /* a conversation was found in this same fwd direction */
-            is_fwd_direction = TRUE;
-        }
-    }
+    /* try to find it among the existing known conversations */
+    conv_item = find_conversation_item(ch, src, dst, src_port, dst_port, conv_id, &is_fwd_direction);
 
     /* if we still don't know what conversation this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if (conv_item == NULL) {
-        conv_key_t *new_key;
         conv_item_t new_conv_item;
-        unsigned int conversation_idx;
 
         copy_address(&new_conv_item.src_address, src);
         copy_address(&new_conv_item.dst_address, dst);
@@ -648,18 +685,7 @@ add_conversation_table_data_with_conv_id(
             nstime_set_unset(&new_conv_item.start_time);
             nstime_set_unset(&new_conv_item.stop_time);
         }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
-
-        /* ct->conversations address is not a constant but src/dst_address.data are */
-        new_key = g_new(conv_key_t, 1);
-        set_address(&new_key->addr1, conv_item->src_address.type, conv_item->src_address.len, conv_item->src_address.data);
-        set_address(&new_key->addr2, conv_item->dst_address.type, conv_item->dst_address.len, conv_item->dst_address.data);
-        new_key->port1 = src_port;
-        new_key->port2 = dst_port;
-        new_key->conv_id = conv_id;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(conversation_idx));
+        conv_item = append_conversation_item(ch, &new_conv_item);
 
         /* update the conversation struct */
         conv_item->tx_frames += num_frames;
@@ -688,6 +714,84 @@ add_conversation_table_data_with_conv_id(
     }
 }
 
+/*
+ * The conversations of a range of frames are collected in a table of their
+ * own, which is then added to the table of the frames before them.
+ */
+static void *
+new_partial_conversation_table(void *tapdata)
+{
+    conv_hash_t *ch = g_new0(conv_hash_t, 1);
+
+    ch->user_data = ((conv_hash_t *)tapdata)->user_data;
+    return ch;
+}
+
+static void
+merge_conversation_table(void *tapdata, void *partial)
+{
+    conv_hash_t *ch = (conv_hash_t *)tapdata;
+    conv_hash_t *later = (conv_hash_t *)partial;
+    guint i;
+
+    if (later->conv_array == NULL) {
+        return;
+    }
+
+    for (i = 0; i < later->conv_array->len; i++) {
+        conv_item_t *later_item = &g_array_index(later->conv_array, conv_item_t, i);
+        conv_item_t *conv_item;
+        gboolean is_fwd_direction;
+
+        conv_item = find_conversation_item(ch, &later_item->src_address, &later_item->dst_address,
+                                           later_item->src_port, later_item->dst_port, later_item->conv_id,
+                                           &is_fwd_direction);
+        if (conv_item == NULL) {
+            conv_item_t new_conv_item = *later_item;
+
+            copy_address(&new_conv_item.src_address, &later_item->src_address);
+            copy_address(&new_conv_item.dst_address, &later_item->dst_address);
+            append_conversation_item(ch, &new_conv_item);
+            continue;
+        }
+
+        if (is_fwd_direction) {
+            conv_item->tx_frames += later_item->tx_frames;
+            conv_item->tx_bytes += later_item->tx_bytes;
+            conv_item->rx_frames += later_item->rx_frames;
+            conv_item->rx_bytes += later_item->rx_bytes;
+        } else {
+            conv_item->tx_frames += later_item->rx_frames;
+            conv_item->tx_bytes += later_item->rx_bytes;
+            conv_item->rx_frames += later_item->tx_frames;
+            conv_item->rx_bytes += later_item->tx_bytes;
+        }
+
+        if (nstime_cmp(&later_item->stop_time, &conv_item->stop_time) > 0) {
+            conv_item->stop_time = later_item->stop_time;
+        }
+        if (!nstime_is_unset(&later_item->start_time) &&
+            nstime_cmp(&later_item->start_time, &conv_item->start_time) < 0) {
+            conv_item->start_time = later_item->start_time;
+            conv_item->start_abs_time = later_item->start_abs_time;
+        }
+    }
+}
+
+static void
+free_partial_conversation_table(void *partial)
+{
+    reset_conversation_table_data((conv_hash_t *)partial);
+    g_free(partial);
+}
+
+void
+set_conversation_table_mergeable(conv_hash_t *ch)
+{
+    set_tap_listener_mergeable(ch, new_partial_conversation_table,
+                               merge_conversation_table, free_partial_conversation_table);
+}
+
 /*
  * Compute the hash value for a given address/port pairs if the match
  * is to be exact.
@@ -723,10 +827,34 @@ host_match(gconstpointer v, gconstpointer w)
     return 0;
 }
 
-void
-add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, endpoint_type etype)
+/* Look up an endpoint. */
+static hostlist_talker_t *
+find_hostlist_talker(conv_hash_t *ch, const address *addr, guint32 port)
+{
+    host_key_t existing_key;
+    gpointer talker_idx_hash_val;
+
+    if (ch->conv_array == NULL) {
+        return NULL;
+    }
+
+    copy_address_shallow(&existing_key.myaddress, addr);
+    existing_key.port = port;
+
+    if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &talker_idx_hash_val)) {
+        return &g_array_index(ch->conv_array, hostlist_talker_t, GPOINTER_TO_UINT(talker_idx_hash_val));
+    }
+    return NULL;
+}
+
+/* Append a new endpoint to the end of the list. The table takes over the
+ * address of host. */
+static hostlist_talker_t *
+append_hostlist_talker(conv_hash_t *ch, hostlist_talker_t *host)
 {
-    hostlist_talker_t *talker=NULL;
+    host_key_t *new_key;
+    hostlist_talker_t *talker;
+    int talker_idx;
 
     /* XXX should be optimized to allocate n extra entries at a time
        instead of just one */
@@ -738,25 +866,32 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
                                               g_free,     /* key_destroy_func */
                                               NULL);      /* value_destroy_func */
     }
-    else {
-        /* try to find it among the existing known conversations */
-        host_key_t existing_key;
-        gpointer talker_idx_hash_val;
 
-        copy_address_shallow(&existing_key.myaddress, addr);
-        existing_key.port = port;
+    g_array_append_val(ch->conv_array, *host);
+    talker_idx= ch->conv_array->len - 1;
+    talker=&g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
 
-        if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &talker_idx_hash_val)) {
-            talker = &g_array_index(ch->conv_array, hostlist_talker_t, GPOINTER_TO_UINT(talker_idx_hash_val));
-        }
-    }
+    /* hl->hosts address is not a constant but address.data is */
+    new_key = g_new(host_key_t,1);
+    set_address(&new_key->myaddress, talker->myaddress.type, talker->myaddress.len, talker->myaddress.data);
+    new_key->port = talker->port;
+    g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(talker_idx));
+
+    return talker;
+}
+
+void
+add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboolean sender, int num_frames, int num_bytes, hostlist_dissector_info_t *host_info, endpoint_type etype)
+{
+    hostlist_talker_t *talker;
+
+    /* try to find it among the existing known conversations */
+    talker = find_hostlist_talker(ch, addr, port);
 
     /* if we still don't know what talker this is it has to be a new one
        and we have to allocate it and append it to the end of the list */
     if(talker==NULL){
-        host_key_t *new_key;
         hostlist_talker_t host;
-        int talker_idx;
 
         copy_address(&host.myaddress, addr);
         host.dissector_info = host_info;
@@ -768,15 +903,7 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
         host.tx_bytes=0;
         host.modified = TRUE;
 
-        g_array_append_val(ch->conv_array, host);
-        talker_idx= ch->conv_array->len - 1;
-        talker=&g_array_index(ch->conv_array, hostlist_talker_t, talker_idx);
-
-        /* hl->hosts address is not a constant but address.data is */
-        new_key = g_new(host_key_t,1);
-        set_address(&new_key->myaddress, talker->myaddress.type, talker->myaddress.len, talker->myaddress.data);
-        new_key->port = port;
-        g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(talker_idx));
+        talker = append_hostlist_talker(ch, &host);
     }
 
     /* if this is a new talker we need to initialize the struct */
@@ -792,6 +919,57 @@ add_hostlist_table_data(conv_hash_t *ch, const address *addr, guint32 port, gboo
     }
 }
 
+/*
+ * As with conversations, the endpoints of a range of frames are collected
+ * in a table of their own, which is then added to the table of the frames
+ * before them.
+ */
+static void
+merge_hostlist_table(void *tapdata, void *partial)
+{
+    conv_hash_t *ch = (conv_hash_t *)tapdata;
+    conv_hash_t *later = (conv_hash_t *)partial;
+    guint i;
+
+    if (later->conv_array == NULL) {
+        return;
+    }
+
+    for (i = 0; i < later->conv_array->len; i++) {
+        hostlist_talker_t *later_talker = &g_array_index(later->conv_array, hostlist_talker_t, i);
+        hostlist_talker_t *talker;
+
+        talker = find_hostlist_talker(ch, &later_talker->myaddress, later_talker->port);
+        if (talker == NULL) {
+            hostlist_talker_t host = *later_talker;
+
+            copy_address(&host.myaddress, &later_talker->myaddress);
+            append_hostlist_talker(ch, &host);
+            continue;
+        }
+
+        talker->modified = TRUE;
+        talker->tx_frames += later_talker->tx_frames;
+        talker->tx_bytes += later_talker->tx_bytes;
+        talker->rx_frames += later_talker->rx_frames;
+        talker->rx_bytes += later_talker->rx_bytes;
+    }
+}
+
+static void
+free_partial_hostlist_table(void *partial)
+{
+    reset_hostlist_table_data((conv_hash_t *)partial);
+    g_free(partial);
+}
+
+void
+set_hostlist_table_mergeable(conv_hash_t *ch)
+{
+    set_tap_listener_mergeable(ch, new_partial_conversation_table,
+                               merge_hostlist_table, free_partial_hostlist_table);
+}
+
 /*
  * Editor modelines
  *
@@ -216,6 +216,22 @@ WS_DLL_PUBLIC void reset_conversation_table_data(conv_hash_t *ch);
  */
 WS_DLL_PUBLIC void reset_hostlist_table_data(conv_hash_t *ch);
 
+/** Let the conversation table tap listener registered with ch collect the
+ * conversations of ranges of frames separately and merge them; see
+ * set_tap_listener_mergeable().
+ *
+ * @param ch the table the tap listener was registered with
+ */
+WS_DLL_PUBLIC void set_conversation_table_mergeable(conv_hash_t *ch);
+
+/** Let the hostlist table tap listener registered with ch collect the
+ * endpoints of ranges of frames separately and merge them; see
+ * set_tap_listener_mergeable().
+ *
+ * @param ch the table the tap listener was registered with
+ */
+WS_DLL_PUBLIC void set_hostlist_table_mergeable(conv_hash_t *ch);
+
 /** Initialize dissector conversation for stats and (possibly) GUI.
  *
  * @param opt_arg filter string to compare with dissector
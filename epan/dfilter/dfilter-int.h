@@ -27,6 +27,8 @@ struct epan_dfilter {
 	int		*interesting_fields;
 	int		num_interesting_fields;
 	GPtrArray	*deprecated;
+	int		uint_eq_hfid;	/* see dfilter_get_uint_eq() */
+	guint32		uint_eq_value;
 };
 
 typedef struct {
@@ -43,6 +45,8 @@ typedef struct {
 	int		next_register;
 	int		first_constant; /* first register used as a constant */
 	GPtrArray	*deprecated;
+	header_field_info *uint_eq_hfinfo; /* set by dfw_semcheck() */
+	guint32		uint_eq_value;
 } dfwork_t;
 
 /*
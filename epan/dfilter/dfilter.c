@@ -10,6 +10,7 @@
 #define WS_LOG_DOMAIN LOG_DOMAIN_DFILTER
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "dfilter-int.h"
@@ -34,6 +35,10 @@ extern df_lval_t *df_lval;
 /* Holds the singular instance of our Lemon parser object */
 static void*	ParserObj = NULL;
 
+/* Set from WIRESHARK_DFILTER_CHECK_BACKENDS: check the threaded backend
+ * against the interpreter on every application of a filter. */
+static gboolean	check_backends = FALSE;
+
 /*
  * XXX - if we're using a version of Flex that supports reentrant lexical
  * analyzers, we should put this into the lexical analyzer's state.
@@ -164,6 +169,8 @@ dfilter_init(void)
 	sttype_init();
 
 	dfilter_macro_init();
+
+	check_backends = (getenv("WIRESHARK_DFILTER_CHECK_BACKENDS") != NULL);
 }
 
 /* Clean-up the dfilter module */
@@ -470,6 +477,8 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		dfw->consts = NULL;
 		dfilter->interesting_fields = dfw_interesting_fields(dfw,
 			&dfilter->num_interesting_fields);
+		dfilter->uint_eq_hfid = dfw->uint_eq_hfinfo ? dfw->uint_eq_hfinfo->id : -1;
+		dfilter->uint_eq_value = dfw->uint_eq_value;
 
 		/* Initialize run-time space */
 		dfilter->num_registers = dfw->first_constant;
@@ -481,6 +490,9 @@ dfilter_compile(const gchar *text, dfilter_t **dfp, gchar **err_msg)
 		/* Initialize constants */
 		dfvm_init_const(dfilter);
 
+		/* Resolve the instructions for the threaded backend */
+		dfvm_prepare_threaded(dfilter);
+
 		/* And give it to the user. */
 		*dfp = dfilter;
 	}
@@ -515,14 +527,36 @@ FAILURE:
 }
 
 
+/*
+ * Apply a filter with the threaded backend; if check_backends is set,
+ * also apply it with the interpreter, and abort if they disagree.
+ */
+static gboolean
+dfilter_apply_tree(dfilter_t *df, proto_tree *tree)
+{
+	gboolean passed = dfvm_apply_threaded(df, tree);
+
+	if (check_backends && dfvm_apply(df, tree) != passed) {
+		ws_error("Display filter backends disagree: threaded %s, interpreted %s",
+			passed ? "TRUE" : "FALSE", passed ? "FALSE" : "TRUE");
+	}
+	return passed;
+}
+
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree)
 {
-	return dfvm_apply(df, tree);
+	return dfilter_apply_tree(df, tree);
 }
 
 gboolean
 dfilter_apply_edt(dfilter_t *df, epan_dissect_t* edt)
+{
+	return dfilter_apply_tree(df, edt->tree);
+}
+
+gboolean
+dfilter_apply_edt_interpreted(dfilter_t *df, epan_dissect_t* edt)
 {
 	return dfvm_apply(df, edt->tree);
 }
@@ -544,6 +578,13 @@ dfilter_has_interesting_fields(const dfilter_t *df)
 	return (df->num_interesting_fields > 0);
 }
 
+const int *
+dfilter_get_interesting_fields(const dfilter_t *df, int *num_fields)
+{
+	*num_fields = df->num_interesting_fields;
+	return df->interesting_fields;
+}
+
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df) {
 	if (df->deprecated && df->deprecated->len > 0) {
@@ -552,6 +593,16 @@ dfilter_deprecated_tokens(dfilter_t *df) {
 	return NULL;
 }
 
+gboolean
+dfilter_get_uint_eq(const dfilter_t *df, int *hfid, guint32 *value)
+{
+	if (df == NULL || df->uint_eq_hfid == -1)
+		return FALSE;
+	*hfid = df->uint_eq_hfid;
+	*value = df->uint_eq_value;
+	return TRUE;
+}
+
 void
 dfilter_dump(dfilter_t *df)
 {
@@ -60,6 +60,13 @@ WS_DLL_PUBLIC
 gboolean
 dfilter_apply_edt(dfilter_t *df, struct epan_dissect *edt);
 
+/* Apply compiled dfilter with the bytecode interpreter instead of the
+ * threaded code used by dfilter_apply_edt(). Both give the same result;
+ * this is used by dftest to compare them. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_apply_edt_interpreted(dfilter_t *df, struct epan_dissect *edt);
+
 /* Apply compiled dfilter */
 gboolean
 dfilter_apply(dfilter_t *df, proto_tree *tree);
@@ -72,10 +79,23 @@ dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
 gboolean
 dfilter_has_interesting_fields(const dfilter_t *df);
 
+/* Get the IDs of the fields/protocols used in a dfilter. */
+WS_DLL_PUBLIC
+const int *
+dfilter_get_interesting_fields(const dfilter_t *df, int *num_fields);
+
 WS_DLL_PUBLIC
 GPtrArray *
 dfilter_deprecated_tokens(dfilter_t *df);
 
+/* If the dfilter can only match packets where an unsigned integer
+ * field equals a constant ("tcp.stream == 3"), optionally and-ed with
+ * further tests, return the field and the constant. Callers use it to
+ * skip packets they already know cannot match. */
+WS_DLL_PUBLIC
+gboolean
+dfilter_get_uint_eq(const dfilter_t *df, int *hfid, guint32 *value);
+
 /* Print bytecode of dfilter to stdout */
 WS_DLL_PUBLIC
 void
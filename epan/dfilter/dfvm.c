@@ -10,6 +10,8 @@
 
 #include "dfvm.h"
 
+#include <string.h>
+
 #include <ftypes/ftypes-int.h>
 #include <wsutil/ws_assert.h>
 
@@ -24,6 +26,8 @@ dfvm_insn_new(dfvm_opcode_t op)
 	insn->arg2 = NULL;
 	insn->arg3 = NULL;
 	insn->arg4 = NULL;
+	insn->step = NULL;
+	insn->constant = NULL;
 	return insn;
 }
 
@@ -728,6 +732,417 @@ dfvm_apply(dfilter_t *df, proto_tree *tree)
 	return FALSE; /* to appease the compiler */
 }
 
+/*
+ * Threaded backend.
+ *
+ * dfvm_prepare_threaded() resolves every instruction to a handler once,
+ * after the filter has been compiled, so that applying the filter is a
+ * chain of indirect calls instead of a switch over the opcode for every
+ * instruction of every packet. Comparisons whose right-hand operand is a
+ * constant of an integer, IPv4 or byte-string type get a handler that is
+ * specialized for that type: it compares the fvalue_t unions directly
+ * instead of going through fvalue_eq() and friends, as long as the field
+ * value has the same ftype as the constant (which is what the semantic
+ * check normally produces). Anything else falls back to the generic
+ * fvalue_* functions, so both backends give identical results.
+ */
+
+#define STEP_DONE	-1
+
+static int
+step_check_exists(dfilter_t *df _U_, proto_tree *tree, const dfvm_insn_t *insn, gboolean *accum)
+{
+	header_field_info *hfinfo = insn->arg1->value.hfinfo;
+
+	while (hfinfo) {
+		*accum = proto_check_for_protocol_or_field(tree, hfinfo->id);
+		if (*accum)
+			break;
+		hfinfo = hfinfo->same_name_next;
+	}
+	return insn->id + 1;
+}
+
+static int
+step_read_tree(dfilter_t *df, proto_tree *tree, const dfvm_insn_t *insn, gboolean *accum)
+{
+	*accum = read_tree(df, tree, insn->arg1->value.hfinfo, insn->arg2->value.numeric);
+	return insn->id + 1;
+}
+
+static int
+step_call_function(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	GList	*param1 = NULL;
+	GList	*param2 = NULL;
+
+	if (insn->arg3) {
+		param1 = df->registers[insn->arg3->value.numeric];
+	}
+	if (insn->arg4) {
+		param2 = df->registers[insn->arg4->value.numeric];
+	}
+	*accum = insn->arg1->value.funcdef->function(param1, param2,
+			&df->registers[insn->arg2->value.numeric]);
+	// functions create a new value, so own it.
+	df->owns_memory[insn->arg2->value.numeric] = TRUE;
+	return insn->id + 1;
+}
+
+static int
+step_mk_range(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum _U_)
+{
+	mk_range(df, insn->arg1->value.numeric, insn->arg2->value.numeric,
+			insn->arg3->value.drange);
+	return insn->id + 1;
+}
+
+#define GENERIC_CMP_STEP(name, how, func) \
+static int \
+name(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum) \
+{ \
+	*accum = cmp_test(df, how, func, \
+			insn->arg1->value.numeric, insn->arg2->value.numeric); \
+	return insn->id + 1; \
+}
+
+GENERIC_CMP_STEP(step_any_eq, MATCH_ANY, fvalue_eq)
+GENERIC_CMP_STEP(step_all_ne, MATCH_ALL, fvalue_ne)
+GENERIC_CMP_STEP(step_any_ne, MATCH_ANY, fvalue_ne)
+GENERIC_CMP_STEP(step_any_gt, MATCH_ANY, fvalue_gt)
+GENERIC_CMP_STEP(step_any_ge, MATCH_ANY, fvalue_ge)
+GENERIC_CMP_STEP(step_any_lt, MATCH_ANY, fvalue_lt)
+GENERIC_CMP_STEP(step_any_le, MATCH_ANY, fvalue_le)
+GENERIC_CMP_STEP(step_any_bitwise_and, MATCH_ANY, fvalue_bitwise_and)
+GENERIC_CMP_STEP(step_any_contains, MATCH_ANY, fvalue_contains)
+
+static int
+step_any_matches(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	*accum = any_matches(df, insn->arg1->value.numeric, insn->arg2->value.numeric);
+	return insn->id + 1;
+}
+
+static int
+step_any_in_range(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	*accum = any_in_range(df, insn->arg1->value.numeric,
+			insn->arg2->value.numeric, insn->arg3->value.numeric);
+	return insn->id + 1;
+}
+
+static int
+step_not(dfilter_t *df _U_, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	*accum = !*accum;
+	return insn->id + 1;
+}
+
+static int
+step_return(dfilter_t *df _U_, proto_tree *tree _U_, const dfvm_insn_t *insn _U_, gboolean *accum _U_)
+{
+	return STEP_DONE;
+}
+
+static int
+step_if_true_goto(dfilter_t *df _U_, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	if (*accum)
+		return insn->arg1->value.numeric;
+	return insn->id + 1;
+}
+
+static int
+step_if_false_goto(dfilter_t *df _U_, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum)
+{
+	if (!*accum)
+		return insn->arg1->value.numeric;
+	return insn->id + 1;
+}
+
+/* Type-specialized orderings. Each one must match the cmp_order method
+ * of the ftypes it is selected for in specialize_cmp(). */
+
+static inline int
+order_uinteger(const fvalue_t *a, const fvalue_t *b)
+{
+	if (a->value.uinteger == b->value.uinteger)
+		return 0;
+	return a->value.uinteger < b->value.uinteger ? -1 : 1;
+}
+
+static inline int
+order_sinteger(const fvalue_t *a, const fvalue_t *b)
+{
+	if (a->value.sinteger == b->value.sinteger)
+		return 0;
+	return a->value.sinteger < b->value.sinteger ? -1 : 1;
+}
+
+static inline int
+order_uinteger64(const fvalue_t *a, const fvalue_t *b)
+{
+	if (a->value.uinteger64 == b->value.uinteger64)
+		return 0;
+	return a->value.uinteger64 < b->value.uinteger64 ? -1 : 1;
+}
+
+static inline int
+order_sinteger64(const fvalue_t *a, const fvalue_t *b)
+{
+	if (a->value.sinteger64 == b->value.sinteger64)
+		return 0;
+	return a->value.sinteger64 < b->value.sinteger64 ? -1 : 1;
+}
+
+static inline int
+order_ipv4(const fvalue_t *a, const fvalue_t *b)
+{
+	guint32	nmask, addr_a, addr_b;
+
+	nmask = MIN(a->value.ipv4.nmask, b->value.ipv4.nmask);
+	addr_a = a->value.ipv4.addr & nmask;
+	addr_b = b->value.ipv4.addr & nmask;
+	if (addr_a == addr_b)
+		return 0;
+	return addr_a < addr_b ? -1 : 1;
+}
+
+static inline int
+order_bytes(const fvalue_t *a, const fvalue_t *b)
+{
+	const GByteArray *ba = a->value.bytes;
+	const GByteArray *bb = b->value.bytes;
+
+	if (ba->len != bb->len)
+		return ba->len < bb->len ? -1 : 1;
+	return memcmp(ba->data, bb->data, ba->len);
+}
+
+/* Compare every value in the arg1 register with the constant of the
+ * instruction; "test" is an expression on the ordering "r". The constant
+ * register holds exactly one value, so this is cmp_test() unrolled. */
+#define SPECIALIZED_CMP_STEP(name, order, how, test) \
+static int \
+name(dfilter_t *df, proto_tree *tree _U_, const dfvm_insn_t *insn, gboolean *accum) \
+{ \
+	const fvalue_t	*b = insn->constant; \
+	GList		*list_a; \
+	gboolean	have_match; \
+	int		r; \
+ \
+	for (list_a = df->registers[insn->arg1->value.numeric]; list_a; list_a = g_list_next(list_a)) { \
+		const fvalue_t *a = (const fvalue_t *)list_a->data; \
+		if (G_LIKELY(a->ftype == b->ftype)) { \
+			r = order(a, b); \
+		} \
+		else { \
+			ws_assert(a->ftype->cmp_order); \
+			r = a->ftype->cmp_order(a, b); \
+		} \
+		have_match = (test); \
+		if (how == MATCH_ALL && !have_match) { \
+			*accum = FALSE; \
+			return insn->id + 1; \
+		} \
+		else if (how == MATCH_ANY && have_match) { \
+			*accum = TRUE; \
+			return insn->id + 1; \
+		} \
+	} \
+	*accum = (how == MATCH_ALL); \
+	return insn->id + 1; \
+}
+
+#define SPECIALIZED_CMP_STEPS(type) \
+	SPECIALIZED_CMP_STEP(step_any_eq_##type, order_##type, MATCH_ANY, r == 0) \
+	SPECIALIZED_CMP_STEP(step_all_ne_##type, order_##type, MATCH_ALL, r != 0) \
+	SPECIALIZED_CMP_STEP(step_any_ne_##type, order_##type, MATCH_ANY, r != 0) \
+	SPECIALIZED_CMP_STEP(step_any_gt_##type, order_##type, MATCH_ANY, r > 0) \
+	SPECIALIZED_CMP_STEP(step_any_ge_##type, order_##type, MATCH_ANY, r >= 0) \
+	SPECIALIZED_CMP_STEP(step_any_lt_##type, order_##type, MATCH_ANY, r < 0) \
+	SPECIALIZED_CMP_STEP(step_any_le_##type, order_##type, MATCH_ANY, r <= 0) \
+	static const dfvm_step_func_t cmp_steps_##type[] = { \
+		step_any_eq_##type, step_all_ne_##type, step_any_ne_##type, \
+		step_any_gt_##type, step_any_ge_##type, \
+		step_any_lt_##type, step_any_le_##type \
+	};
+
+SPECIALIZED_CMP_STEPS(uinteger)
+SPECIALIZED_CMP_STEPS(sinteger)
+SPECIALIZED_CMP_STEPS(uinteger64)
+SPECIALIZED_CMP_STEPS(sinteger64)
+SPECIALIZED_CMP_STEPS(ipv4)
+SPECIALIZED_CMP_STEPS(bytes)
+
+/* Pick a specialized handler for a comparison against a constant, or
+ * NULL if there is none for the type of the constant. */
+static dfvm_step_func_t
+specialize_cmp(dfvm_opcode_t op, fvalue_t *constant)
+{
+	const dfvm_step_func_t *steps;
+
+	switch (fvalue_type_ftenum(constant)) {
+		case FT_CHAR:
+		case FT_UINT8:
+		case FT_UINT16:
+		case FT_UINT24:
+		case FT_UINT32:
+		case FT_IPXNET:
+		case FT_FRAMENUM:
+			steps = cmp_steps_uinteger;
+			break;
+		case FT_INT8:
+		case FT_INT16:
+		case FT_INT24:
+		case FT_INT32:
+			steps = cmp_steps_sinteger;
+			break;
+		case FT_UINT40:
+		case FT_UINT48:
+		case FT_UINT56:
+		case FT_UINT64:
+		case FT_EUI64:
+			steps = cmp_steps_uinteger64;
+			break;
+		case FT_INT40:
+		case FT_INT48:
+		case FT_INT56:
+		case FT_INT64:
+			steps = cmp_steps_sinteger64;
+			break;
+		case FT_IPv4:
+			steps = cmp_steps_ipv4;
+			break;
+		case FT_BYTES:
+		case FT_UINT_BYTES:
+		case FT_ETHER:
+			steps = cmp_steps_bytes;
+			break;
+		default:
+			return NULL;
+	}
+
+	switch (op) {
+		case ANY_EQ:	return steps[0];
+		case ALL_NE:	return steps[1];
+		case ANY_NE:	return steps[2];
+		case ANY_GT:	return steps[3];
+		case ANY_GE:	return steps[4];
+		case ANY_LT:	return steps[5];
+		case ANY_LE:	return steps[6];
+		default:	return NULL;
+	}
+}
+
+void
+dfvm_prepare_threaded(dfilter_t *df)
+{
+	guint		id;
+	dfvm_insn_t	*insn;
+	guint		reg;
+	GList		*constant;
+
+	for (id = 0; id < df->insns->len; id++) {
+		insn = (dfvm_insn_t	*)g_ptr_array_index(df->insns, id);
+		ws_assert(insn->id == (int)id);
+		insn->step = NULL;
+		insn->constant = NULL;
+
+		switch (insn->op) {
+			case CHECK_EXISTS:
+				insn->step = step_check_exists;
+				break;
+			case READ_TREE:
+				insn->step = step_read_tree;
+				break;
+			case CALL_FUNCTION:
+				insn->step = step_call_function;
+				break;
+			case MK_RANGE:
+				insn->step = step_mk_range;
+				break;
+			case ANY_EQ:
+			case ALL_NE:
+			case ANY_NE:
+			case ANY_GT:
+			case ANY_GE:
+			case ANY_LT:
+			case ANY_LE:
+				/* Registers at or above num_registers hold the
+				 * constants set up by dfvm_init_const(). */
+				reg = insn->arg2->value.numeric;
+				constant = df->registers[reg];
+				if (reg >= df->num_registers && constant && !g_list_next(constant)) {
+					insn->step = specialize_cmp(insn->op, (fvalue_t *)constant->data);
+					if (insn->step)
+						insn->constant = (const fvalue_t *)constant->data;
+				}
+				if (insn->step)
+					break;
+				switch (insn->op) {
+					case ANY_EQ:	insn->step = step_any_eq; break;
+					case ALL_NE:	insn->step = step_all_ne; break;
+					case ANY_NE:	insn->step = step_any_ne; break;
+					case ANY_GT:	insn->step = step_any_gt; break;
+					case ANY_GE:	insn->step = step_any_ge; break;
+					case ANY_LT:	insn->step = step_any_lt; break;
+					case ANY_LE:	insn->step = step_any_le; break;
+					default:	ws_assert_not_reached();
+				}
+				break;
+			case ANY_BITWISE_AND:
+				insn->step = step_any_bitwise_and;
+				break;
+			case ANY_CONTAINS:
+				insn->step = step_any_contains;
+				break;
+			case ANY_MATCHES:
+				insn->step = step_any_matches;
+				break;
+			case ANY_IN_RANGE:
+				insn->step = step_any_in_range;
+				break;
+			case NOT:
+				insn->step = step_not;
+				break;
+			case RETURN:
+				insn->step = step_return;
+				break;
+			case IF_TRUE_GOTO:
+				insn->step = step_if_true_goto;
+				break;
+			case IF_FALSE_GOTO:
+				insn->step = step_if_false_goto;
+				break;
+			case PUT_FVALUE:
+			case PUT_PCRE:
+			default:
+				ws_assert_not_reached();
+				break;
+		}
+	}
+}
+
+gboolean
+dfvm_apply_threaded(dfilter_t *df, proto_tree *tree)
+{
+	dfvm_insn_t	**insns = (dfvm_insn_t **)df->insns->pdata;
+	const dfvm_insn_t *insn;
+	gboolean	accum = TRUE;
+	int		id = 0;
+
+	ws_assert(tree);
+
+	do {
+		insn = insns[id];
+		id = insn->step(df, tree, insn, &accum);
+	} while (id != STEP_DONE);
+
+	free_register_overhead(df);
+	return accum;
+}
+
 void
 dfvm_init_const(dfilter_t *df)
 {
@@ -68,13 +68,23 @@ typedef enum {
 
 } dfvm_opcode_t;
 
-typedef struct {
+struct _dfvm_insn_t;
+
+/* Handler used by the threaded backend (dfvm_apply_threaded). It executes
+ * one instruction and returns the index of the next instruction to run,
+ * or -1 when the filter is done. */
+typedef int (*dfvm_step_func_t)(dfilter_t *df, proto_tree *tree,
+				const struct _dfvm_insn_t *insn, gboolean *accum);
+
+typedef struct _dfvm_insn_t {
 	int		id;
 	dfvm_opcode_t	op;
 	dfvm_value_t	*arg1;
 	dfvm_value_t	*arg2;
 	dfvm_value_t	*arg3;
 	dfvm_value_t	*arg4;
+	dfvm_step_func_t step;		/* set by dfvm_prepare_threaded() */
+	const fvalue_t	*constant;	/* constant operand of a specialized comparison */
 } dfvm_insn_t;
 
 dfvm_insn_t*
@@ -92,7 +102,13 @@ dfvm_dump(FILE *f, dfilter_t *df);
 gboolean
 dfvm_apply(dfilter_t *df, proto_tree *tree);
 
+gboolean
+dfvm_apply_threaded(dfilter_t *df, proto_tree *tree);
+
 void
 dfvm_init_const(dfilter_t *df);
 
+void
+dfvm_prepare_threaded(dfilter_t *df);
+
 #endif
@@ -1276,6 +1276,55 @@ semcheck(dfwork_t *dfw, stnode_t *st_node)
 }
 
 
+/* If a packet can only pass the test when an unsigned integer field
+ * equals a constant ("tcp.stream == 3", possibly and-ed with other
+ * tests), return the field and the constant. */
+static gboolean
+find_uint_eq(stnode_t *st_node, header_field_info **hfinfo, guint32 *value)
+{
+	test_op_t		st_op;
+	stnode_t		*st_arg1, *st_arg2, *st_field, *st_value;
+	header_field_info	*field;
+	fvalue_t		*fv;
+
+	if (stnode_type_id(st_node) != STTYPE_TEST)
+		return FALSE;
+	sttype_test_get(st_node, &st_op, &st_arg1, &st_arg2);
+
+	if (st_op == TEST_OP_AND)
+		return find_uint_eq(st_arg1, hfinfo, value) ||
+			find_uint_eq(st_arg2, hfinfo, value);
+	if (st_op != TEST_OP_ANY_EQ)
+		return FALSE;
+
+	if (stnode_type_id(st_arg1) == STTYPE_FIELD &&
+	    stnode_type_id(st_arg2) == STTYPE_FVALUE) {
+		st_field = st_arg1;
+		st_value = st_arg2;
+	}
+	else if (stnode_type_id(st_arg1) == STTYPE_FVALUE &&
+		 stnode_type_id(st_arg2) == STTYPE_FIELD) {
+		st_field = st_arg2;
+		st_value = st_arg1;
+	}
+	else {
+		return FALSE;
+	}
+
+	/* A field name shared by several hfinfos matches any of them. */
+	field = (header_field_info *)stnode_data(st_field);
+	if (field->same_name_prev_id != -1 || field->same_name_next != NULL)
+		return FALSE;
+
+	fv = (fvalue_t *)stnode_data(st_value);
+	if (fvalue_type_ftenum(fv) != FT_UINT32)
+		return FALSE;
+
+	*hfinfo = field;
+	*value = fvalue_get_uinteger(fv);
+	return TRUE;
+}
+
 /* Check the syntax tree for semantic errors, and convert
  * some of the nodes into the form they need to be in order to
  * later generate the DFVM bytecode. */
@@ -1298,6 +1347,9 @@ dfw_semcheck(dfwork_t *dfw)
 	}
 	ENDTRY;
 
+	if (ok_filter)
+		find_uint_eq(dfw->st_root, &dfw->uint_eq_hfinfo, &dfw->uint_eq_value);
+
 	ws_debug("1 dfw_semcheck(dfwork_t *dfw = %p) [%u] - Returns %d",
 				dfw, i++, ok_filter);
 	return ok_filter;
@@ -432,6 +432,19 @@ dissect_h245_h245(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, vo
 	return tvb_captured_length(tvb);
 }
 
+/*
+ * Called instead of the H.245 dissector when lazy dissection skips H.245.
+ * Dissect without a tree anyway, so that the RTP, RTCP, SRTP and T.38
+ * conversations of opened logical channels are set up.
+ */
+static int
+skipped_h245(tvbuff_t *tvb, packet_info *pinfo, void* data)
+{
+	if (pinfo->ptype == PT_TCP)
+		return dissect_h245(tvb, pinfo, NULL, data);
+	return dissect_h245_h245(tvb, pinfo, NULL, data);
+}
+
 void
 dissect_h245_FastStart_OLC(tvbuff_t *tvb, packet_info *pinfo _U_, proto_tree *tree, char *codec_str) {
 
@@ -511,6 +524,7 @@ void proto_register_h245(void) {
     &info_col_fmt_prepend);
   MultimediaSystemControlMessage_handle = register_dissector("h245dg", dissect_h245_h245, proto_h245);
   h245_handle = register_dissector("h245", dissect_h245, proto_h245);
+  register_skipped_dissector_routine(proto_h245, skipped_h245);
 
   nsp_object_dissector_table = register_dissector_table("h245.nsp.object", "H.245 NonStandardParameter (object)", proto_h245, FT_STRING, BASE_NONE);
   nsp_h221_dissector_table = register_dissector_table("h245.nsp.h221", "H.245 NonStandardParameter (h221)", proto_h245, FT_UINT32, BASE_HEX);
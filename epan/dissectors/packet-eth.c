@@ -310,7 +310,8 @@ dissect_address_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboole
 {
   const guint8      *src_addr, *dst_addr;
   const char        *src_addr_name, *dst_addr_name;
-  const gchar       *src_oui_name, *dst_oui_name;
+  const gchar       *src_oui_name = NULL, *dst_oui_name = NULL;
+  gboolean           want_oui_names;
   proto_item        *addr_item;
   proto_tree        *addr_tree;
 
@@ -320,6 +321,12 @@ dissect_address_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboole
   src_addr = (const guint8*)pinfo->src.data;
   src_addr_name = get_ether_name(src_addr);
 
+  /* Looking up an OUI loads the manuf file; only do it if the resolved
+     OUI fields are going to be seen or used. */
+  want_oui_names = proto_field_is_referenced(tree, hf_eth_dst_oui_resolved) ||
+                   proto_field_is_referenced(tree, hf_eth_src_oui_resolved) ||
+                   proto_field_is_referenced(tree, hf_eth_addr_oui_resolved);
+
   addr_item = proto_tree_add_ether(tree, hf_eth_dst, tvb, 0, 6, dst_addr);
   addr_tree = proto_item_add_subtree(addr_item, ett_addr);
 
@@ -332,7 +339,9 @@ dissect_address_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboole
   PROTO_ITEM_SET_GENERATED(addr_item);
   PROTO_ITEM_SET_HIDDEN(addr_item);
 
-  dst_oui_name = tvb_get_manuf_name_if_known(tvb, 0);
+  if (want_oui_names) {
+    dst_oui_name = tvb_get_manuf_name_if_known(tvb, 0);
+  }
   if (dst_oui_name != NULL) {
     addr_item = proto_tree_add_string(addr_tree, hf_eth_dst_oui_resolved, tvb, 0, 6, dst_oui_name);
     PROTO_ITEM_SET_GENERATED(addr_item);
@@ -378,7 +387,9 @@ dissect_address_data(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, gboole
   PROTO_ITEM_SET_GENERATED(addr_item);
   PROTO_ITEM_SET_HIDDEN(addr_item);
 
-  src_oui_name = tvb_get_manuf_name_if_known(tvb, 6);
+  if (want_oui_names) {
+    src_oui_name = tvb_get_manuf_name_if_known(tvb, 6);
+  }
   if (src_oui_name != NULL) {
     addr_item = proto_tree_add_string(addr_tree, hf_eth_src_oui_resolved, tvb, 6, 6, src_oui_name);
     PROTO_ITEM_SET_GENERATED(addr_item);
@@ -357,6 +357,8 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	dissector_handle_t dissector_handle;
 	fr_foreach_t fr_user_data;
 	struct nflx_tcpinfo tcpinfo;
+	const nstime_t *shift_offset;
+	nstime_t     zero_shift;
 
 	tree=parent_tree;
 
@@ -701,8 +703,13 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 								  " the valid range is 0-1000000000",
 								  (long) pinfo->abs_ts.nsecs);
 			}
+			shift_offset = epan_get_time_shift(pinfo->epan, pinfo->fd);
+			if (shift_offset == NULL) {
+				nstime_set_zero(&zero_shift);
+				shift_offset = &zero_shift;
+			}
 			item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
-					    0, 0, &(pinfo->fd->shift_offset));
+					    0, 0, shift_offset);
 			proto_item_set_generated(item);
 
 			if (generate_epoch_time) {
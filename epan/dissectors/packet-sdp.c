@@ -2887,6 +2887,17 @@ dissect_sdp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data)
     return tvb_captured_length(tvb);
 }
 
+/*
+ * Called instead of the SDP dissector when lazy dissection skips SDP.
+ * Dissect without a tree anyway, so that the RTP, RTCP, SRTP, T.38 and
+ * MSRP conversations it describes are set up.
+ */
+static int
+skipped_sdp(tvbuff_t *tvb, packet_info *pinfo, void *data)
+{
+    return dissect_sdp(tvb, pinfo, NULL, data);
+}
+
 void
 proto_register_sdp(void)
 {
@@ -3407,6 +3418,7 @@ proto_register_sdp(void)
      * grab it by name rather than just referring to it directly.
      */
     sdp_handle = register_dissector("sdp", dissect_sdp, proto_sdp);
+    register_skipped_dissector_routine(proto_sdp, skipped_sdp);
 
     /* Register for tapping */
     sdp_tap = register_tap("sdp");
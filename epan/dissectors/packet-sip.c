@@ -3343,6 +3343,19 @@ dissect_sip_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data
     return offset;
 }
 
+/*
+ * Called instead of the SIP dissector when lazy dissection skips SIP.
+ * Dissect without a tree anyway, so that transactions are tracked and
+ * the RTP conversations of SDP offers and answers are set up.
+ */
+static int
+skipped_sip(tvbuff_t *tvb, packet_info *pinfo, void *data)
+{
+    if (pinfo->ptype == PT_TCP)
+        return dissect_sip_tcp(tvb, pinfo, NULL, data);
+    return dissect_sip(tvb, pinfo, NULL, data);
+}
+
 static gboolean
 dissect_sip_tcp_heur(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _U_)
 {
@@ -7532,6 +7545,7 @@ void proto_register_sip(void)
                                             "Raw_SIP", "raw_sip");
     sip_handle = register_dissector("sip", dissect_sip, proto_sip);
     sip_tcp_handle = register_dissector("sip.tcp", dissect_sip_tcp, proto_sip);
+    register_skipped_dissector_routine(proto_sip, skipped_sip);
 
     /* Required function calls to register the header fields and subtrees used */
     proto_register_field_array(proto_sip, hf, array_length(hf));
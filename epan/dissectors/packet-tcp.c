@@ -6722,6 +6722,8 @@ dissect_tcp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
     if (tcpd) {
         item = proto_tree_add_uint(tcp_tree, hf_tcp_stream, tvb, offset, 0, tcpd->stream);
         proto_item_set_generated(item);
+        if (!PINFO_FD_VISITED(pinfo))
+            follow_stream_index_add_frame(hf_tcp_stream, tcpd->stream, pinfo->num);
 
         /* Display the completeness of this TCP conversation */
         item = proto_tree_add_uint(tcp_tree, hf_tcp_completeness, NULL, 0, 0, tcpd->conversation_completeness);
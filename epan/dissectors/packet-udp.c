@@ -1240,6 +1240,8 @@ dissect(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, guint32 ip_proto)
   if (udpd) {
     item = proto_tree_add_uint(udp_tree, &hfi_udp_stream, tvb, offset, 0, udpd->stream);
     proto_item_set_generated(item);
+    if (!PINFO_FD_VISITED(pinfo))
+      follow_stream_index_add_frame(hfi_udp_stream.id, udpd->stream, pinfo->num);
 
     /* Copy the stream index into the header as well to make it available
     * to tap listeners.
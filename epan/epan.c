@@ -491,6 +491,15 @@ epan_get_frame_ts(const epan_t *session, guint32 frame_num)
 	return abs_ts;
 }
 
+const nstime_t *
+epan_get_time_shift(const epan_t *session, const frame_data *fd)
+{
+	if (session && session->funcs.get_time_shift)
+		return session->funcs.get_time_shift(session->prov, fd);
+
+	return NULL;
+}
+
 void
 epan_free(epan_t *session)
 {
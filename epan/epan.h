@@ -51,6 +51,7 @@ struct packet_provider_funcs {
 	const char *(*get_interface_name)(struct packet_provider_data *prov, guint32 interface_id);
 	const char *(*get_interface_description)(struct packet_provider_data *prov, guint32 interface_id);
 	wtap_block_t (*get_modified_block)(struct packet_provider_data *prov, const frame_data *fd);
+	const nstime_t *(*get_time_shift)(struct packet_provider_data *prov, const frame_data *fd);
 };
 
 /**
@@ -162,6 +163,12 @@ WS_DLL_PUBLIC const char *epan_get_interface_description(const epan_t *session,
 
 const nstime_t *epan_get_frame_ts(const epan_t *session, guint32 frame_num);
 
+/**
+ * Get the amount by which the time stamp of a frame has been shifted
+ * by the user, or NULL if it hasn't been.
+ */
+const nstime_t *epan_get_time_shift(const epan_t *session, const frame_data *fd);
+
 WS_DLL_PUBLIC void epan_free(epan_t *session);
 
 WS_DLL_PUBLIC const gchar*
@@ -32,6 +32,9 @@ struct register_follow {
 
 static wmem_tree_t *registered_followers = NULL;
 
+/* Field id -> (stream number -> wmem_array_t of frame numbers) */
+static wmem_map_t *stream_frame_index = NULL;
+
 void register_follow_stream(const int proto_id, const char* tap_listener,
                             follow_conv_filter_func conv_filter, follow_index_filter_func index_filter, follow_address_filter_func address_filter,
                             follow_port_to_display_func port_to_display, tap_packet_cb tap_handler)
@@ -212,6 +215,64 @@ follow_tvb_tap_listener(void *tapdata, packet_info *pinfo,
     return TAP_PACKET_DONT_REDRAW;
 }
 
+void
+follow_stream_index_add_frame(const int hf_stream, const guint32 stream, const guint32 frame_num)
+{
+  wmem_map_t *streams;
+  wmem_array_t *frames;
+  guint len;
+
+  if (stream_frame_index == NULL)
+    stream_frame_index = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_direct_hash, g_direct_equal);
+
+  streams = (wmem_map_t *)wmem_map_lookup(stream_frame_index, GINT_TO_POINTER(hf_stream));
+  if (streams == NULL) {
+    streams = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+    wmem_map_insert(stream_frame_index, GINT_TO_POINTER(hf_stream), streams);
+  }
+
+  frames = (wmem_array_t *)wmem_map_lookup(streams, GUINT_TO_POINTER(stream));
+  if (frames == NULL) {
+    frames = wmem_array_new(wmem_file_scope(), sizeof(guint32));
+    wmem_map_insert(streams, GUINT_TO_POINTER(stream), frames);
+  }
+
+  /* Frames are added in order on the first pass; a frame can carry the
+   * same stream more than once (e.g. in an ICMP error), keep one. */
+  len = wmem_array_get_count(frames);
+  if (len > 0 && *(guint32 *)wmem_array_index(frames, len - 1) >= frame_num)
+    return;
+
+  wmem_array_append_one(frames, frame_num);
+}
+
+gboolean
+follow_stream_index_get_frames(const int hf_stream, const guint32 stream,
+                               const guint32 **frames, guint *num_frames)
+{
+  wmem_map_t *streams;
+  wmem_array_t *stream_frames;
+
+  if (stream_frame_index == NULL)
+    return FALSE;
+
+  streams = (wmem_map_t *)wmem_map_lookup(stream_frame_index, GINT_TO_POINTER(hf_stream));
+  if (streams == NULL)
+    return FALSE;
+
+  stream_frames = (wmem_array_t *)wmem_map_lookup(streams, GUINT_TO_POINTER(stream));
+  if (stream_frames == NULL) {
+    /* The field is indexed, but no frame has this stream. */
+    *frames = NULL;
+    *num_frames = 0;
+    return TRUE;
+  }
+
+  *frames = (const guint32 *)wmem_array_get_raw(stream_frames);
+  *num_frames = wmem_array_get_count(stream_frames);
+  return TRUE;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -207,6 +207,29 @@ WS_DLL_PUBLIC void follow_reset_stream(follow_info_t* info);
  */
 WS_DLL_PUBLIC void follow_info_free(follow_info_t* follow_info);
 
+/** Record, on the first pass, that a frame belongs to a stream.
+ * Dissectors that number their streams (e.g. tcp.stream) call this
+ * wherever they add the stream number field, so that the frames
+ * matching "field == stream" can be found without dissecting every
+ * frame again.
+ *
+ * @param hf_stream [in] Field carrying the stream number
+ * @param stream [in] Stream number
+ * @param frame_num [in] Frame number
+ */
+WS_DLL_PUBLIC void follow_stream_index_add_frame(const int hf_stream, const guint32 stream, const guint32 frame_num);
+
+/** Get the frames of a stream recorded with follow_stream_index_add_frame().
+ *
+ * @param hf_stream [in] Field carrying the stream number
+ * @param stream [in] Stream number
+ * @param frames [out] The frame numbers, in ascending order
+ * @param num_frames [out] Number of frames
+ * @return TRUE if frames are recorded for the field, FALSE otherwise
+ */
+WS_DLL_PUBLIC gboolean follow_stream_index_get_frames(const int hf_stream, const guint32 stream,
+                                                      const guint32 **frames, guint *num_frames);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -51,10 +51,18 @@ typedef enum {
 
    There is one of these structures for every frame in the capture.
    That means a lot of memory if we have a lot of frames.
-   They are packed into power-of-2 chunks, so their size is effectively
-   rounded up to a power of 2.
-   Try to keep it close to, and less than or equal to, a power of 2.
-   "Smaller than a power of 2" is OK for ILP32 platforms.
+   frame_data_sequence.c allocates them in arrays of 1024, so every
+   byte added here costs a byte per frame; it's 72 bytes on LP64
+   platforms.
+
+   Dissectors, taps and the UIs keep pointers to these structures
+   (pinfo->fd) and set fields in them, so the fields can't be stored
+   column-wise or delta-encoded behind frame_data_sequence_find().
+   cum_bytes, frame_ref_num and prev_dis_num depend on the display
+   filter and time references, and are set for every frame as the
+   packets are filtered, so they can't be derived on lookup either.
+   Fields that are rarely set can be kept outside this structure, as
+   the time shift is (see epan_get_time_shift()).
 
    XXX - shuffle the fields to try to keep the most commonly-accessed
    fields within the first 16 or 32 bytes, so they all fit in a cache
@@ -88,7 +96,9 @@ typedef struct _frame_data {
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
+  /* How much abs_ts has been shifted by the user is rarely anything
+     but zero, so it's kept outside this structure, by the packet
+     provider; see epan_get_time_shift(). */
   guint32      frame_ref_num; /**< Previous reference frame (0 if this is one) */
   guint32      prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
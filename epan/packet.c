@@ -118,6 +118,28 @@ struct depend_dissector_list {
 /* Maps char *dissector_name to depend_dissector_list_t */
 static GHashTable *depend_dissector_lists = NULL;
 
+/*
+ * Lazy dissection: short names of the protocols that can lead to a
+ * wanted field, or NULL if lazy dissection is off.
+ */
+static GHashTable *lazy_dissection_protos = NULL;
+
+/*
+ * Short names of the protocols that have been added to a dissector table
+ * that belongs to no protocol; we don't know what leads to them.
+ */
+static GHashTable *unknown_parent_protos = NULL;
+
+/*
+ * Routines to call when a dissector is skipped by lazy dissection.
+ */
+typedef struct {
+	int			proto;
+	skipped_dissector_func	func;
+} skipped_dissector_routine;
+
+static GSList *skipped_dissector_routines = NULL;
+
 /* Allow protocols to register a "cleanup" routine to be
  * run after the initial sequential run through the packets.
  * Note that the file can still be open after this; this is not
@@ -214,6 +236,8 @@ packet_init(void)
 			NULL, destroy_heuristic_dissector_list);
 
 	heuristic_short_names  = g_hash_table_new(g_str_hash, g_str_equal);
+
+	unknown_parent_protos = g_hash_table_new(g_str_hash, g_str_equal);
 }
 
 void
@@ -255,10 +279,13 @@ packet_cleanup(void)
 	g_slist_free(init_routines);
 	g_slist_free(cleanup_routines);
 	g_slist_free(postseq_cleanup_routines);
+	g_slist_free_full(skipped_dissector_routines, g_free);
 	g_hash_table_destroy(dissector_tables);
 	g_hash_table_destroy(dissector_table_aliases);
 	g_hash_table_destroy(registered_dissectors);
+	disable_lazy_dissection();
 	g_hash_table_destroy(depend_dissector_lists);
+	g_hash_table_destroy(unknown_parent_protos);
 	g_hash_table_destroy(heur_dissector_lists);
 	g_hash_table_destroy(heuristic_short_names);
 	g_slist_foreach(shutdown_routines, &call_routine, NULL);
@@ -1057,6 +1084,26 @@ dissector_add_uint_sanity_check(const char *name, guint32 pattern, dissector_han
 }
 #endif
 
+/*
+ * Note that the protocol of a dissector table can lead to the protocol of
+ * a handle in it, so that lazy dissection doesn't skip the former when
+ * fields of the latter are wanted.
+ */
+static void
+add_table_dependency(dissector_table_t sub_dissectors, dissector_handle_t handle)
+{
+	const char *name;
+
+	if (handle == NULL || handle->protocol == NULL)
+		return;
+
+	name = proto_get_protocol_short_name(handle->protocol);
+	if (sub_dissectors->protocol != NULL)
+		register_depend_dissector(proto_get_protocol_short_name(sub_dissectors->protocol), name);
+	else
+		g_hash_table_add(unknown_parent_protos, (gpointer)name);
+}
+
 /* Add an entry to a uint dissector table. */
 void
 dissector_add_uint(const char *name, const guint32 pattern, dissector_handle_t handle)
@@ -1109,6 +1156,8 @@ dissector_add_uint(const char *name, const guint32 pattern, dissector_handle_t h
 	dissector_add_uint_sanity_check(name, pattern, handle, sub_dissectors);
 #endif
 
+	add_table_dependency(sub_dissectors, handle);
+
 	dtbl_entry = g_new(dtbl_entry_t, 1);
 	dtbl_entry->current = handle;
 	dtbl_entry->initial = dtbl_entry->current;
@@ -1348,6 +1397,8 @@ dissector_change_uint(const char *name, const guint32 pattern, dissector_handle_
 	/* sanity check */
 	ws_assert(sub_dissectors);
 
+	add_table_dependency(sub_dissectors, handle);
+
 	/*
 	 * See if the entry already exists. If so, reuse it.
 	 */
@@ -1419,6 +1470,66 @@ dissector_is_uint_changed(dissector_table_t const sub_dissectors, const guint32
 	return FALSE;
 }
 
+/*
+ * If lazy dissection is on and the protocol of a dissector found in a
+ * dissector table can't lead to anything we want, return TRUE.
+ */
+static gboolean
+skip_lazy_dissection(dissector_handle_t handle)
+{
+	if (lazy_dissection_protos == NULL || handle->protocol == NULL)
+		return FALSE;
+
+	/*
+	 * Leave disabled protocols to call_dissector_work(); pinos
+	 * share the dissector of their parent, which may be wanted.
+	 */
+	if (!proto_is_protocol_enabled(handle->protocol) ||
+	    proto_is_pino(handle->protocol))
+		return FALSE;
+
+	return !g_hash_table_contains(lazy_dissection_protos,
+	    proto_get_protocol_short_name(handle->protocol));
+}
+
+/*
+ * Call the routine registered for the protocol of a dissector skipped by
+ * lazy dissection, if any, and return the number of bytes to report as
+ * consumed.
+ */
+static int
+call_skipped_dissector_routine(dissector_handle_t handle, tvbuff_t *tvb,
+    packet_info *pinfo, void *data)
+{
+	GSList *entry;
+	skipped_dissector_routine *routine;
+	const char *saved_proto;
+	guint16 saved_can_desegment;
+	int proto = proto_get_id(handle->protocol);
+	int len;
+
+	for (entry = skipped_dissector_routines; entry; entry = g_slist_next(entry)) {
+		routine = (skipped_dissector_routine *)entry->data;
+		if (routine->proto == proto)
+			break;
+	}
+	if (entry == NULL)
+		return tvb_captured_length(tvb);
+
+	/* As in call_dissector_work() */
+	saved_proto = pinfo->current_proto;
+	saved_can_desegment = pinfo->can_desegment;
+	pinfo->saved_can_desegment = saved_can_desegment;
+	pinfo->can_desegment = saved_can_desegment-(saved_can_desegment>0);
+	pinfo->current_proto = proto_get_protocol_short_name(handle->protocol);
+
+	len = routine->func(tvb, pinfo, data);
+
+	pinfo->current_proto = saved_proto;
+	pinfo->can_desegment = saved_can_desegment;
+	return len;
+}
+
 /* Look for a given value in a given uint dissector table and, if found,
    call the dissector with the arguments supplied, and return the number
    of bytes consumed by the dissector, otherwise return 0. */
@@ -1461,7 +1572,10 @@ dissector_try_uint_new(dissector_table_t sub_dissectors, const guint32 uint_val,
 	 */
 	saved_match_uint  = pinfo->match_uint;
 	pinfo->match_uint = uint_val;
-	len = call_dissector_work(handle, tvb, pinfo, tree, add_proto_name, data);
+	if (skip_lazy_dissection(handle))
+		len = call_skipped_dissector_routine(handle, tvb, pinfo, data);
+	else
+		len = call_dissector_work(handle, tvb, pinfo, tree, add_proto_name, data);
 	pinfo->match_uint = saved_match_uint;
 
 	/*
@@ -1605,6 +1719,8 @@ dissector_add_string(const char *name, const gchar *pattern,
 		ws_assert_not_reached();
 	}
 
+	add_table_dependency(sub_dissectors, handle);
+
 	dtbl_entry = g_new(dtbl_entry_t, 1);
 	dtbl_entry->current = handle;
 	dtbl_entry->initial = dtbl_entry->current;
@@ -1672,6 +1788,8 @@ dissector_change_string(const char *name, const gchar *pattern,
 	/* sanity check */
 	ws_assert(sub_dissectors);
 
+	add_table_dependency(sub_dissectors, handle);
+
 	/*
 	 * See if the entry already exists. If so, reuse it.
 	 */
@@ -1778,7 +1896,10 @@ dissector_try_string_new(dissector_table_t sub_dissectors, const gchar *string,
 		 */
 		saved_match_string = pinfo->match_string;
 		pinfo->match_string = string;
-		len = call_dissector_work(handle, tvb, pinfo, tree, add_proto_name, data);
+		if (skip_lazy_dissection(handle))
+			len = call_skipped_dissector_routine(handle, tvb, pinfo, data);
+		else
+			len = call_dissector_work(handle, tvb, pinfo, tree, add_proto_name, data);
 		pinfo->match_string = saved_match_string;
 
 		/*
@@ -1867,6 +1988,8 @@ void dissector_add_custom_table_handle(const char *name, void *pattern, dissecto
 
 	ws_assert(sub_dissectors->type == FT_BYTES);
 
+	add_table_dependency(sub_dissectors, handle);
+
 	dtbl_entry = g_new(dtbl_entry_t, 1);
 	dtbl_entry->current = handle;
 	dtbl_entry->initial = dtbl_entry->current;
@@ -1925,6 +2048,8 @@ void dissector_add_guid(const char *name, guid_key* guid_val, dissector_handle_t
 		ws_assert_not_reached();
 	}
 
+	add_table_dependency(sub_dissectors, handle);
+
 	dtbl_entry = g_new(dtbl_entry_t, 1);
 	dtbl_entry->current = handle;
 	dtbl_entry->initial = dtbl_entry->current;
@@ -1967,6 +2092,9 @@ int dissector_try_guid_new(dissector_table_t sub_dissectors,
 			return 0;
 		}
 
+		if (skip_lazy_dissection(handle))
+			return call_skipped_dissector_routine(handle, tvb, pinfo, data);
+
 		/*
 		 * Save the current value of "pinfo->match_uint",
 		 * set it to the uint_val that matched, call the
@@ -2125,11 +2253,8 @@ dissector_add_for_decode_as(const char *name, dissector_handle_t handle)
 		return;
 	}
 
-	/* Add the dissector as a dependency
-	  (some dissector tables don't have protocol association, so there is
-	  the need for the NULL check */
-	if (sub_dissectors->protocol != NULL)
-		register_depend_dissector(proto_get_protocol_short_name(sub_dissectors->protocol), proto_get_protocol_short_name(handle->protocol));
+	/* Add the dissector as a dependency */
+	add_table_dependency(sub_dissectors, handle);
 
 	/* Is it already in this list? */
 	entry = g_slist_find(sub_dissectors->dissector_handles, (gpointer)handle);
@@ -3458,6 +3583,117 @@ depend_dissector_list_t find_depend_dissector_list(const char* name)
 	return (depend_dissector_list_t)g_hash_table_lookup(depend_dissector_lists, name);
 }
 
+static void
+free_lazy_dissection_parents(gpointer key _U_, gpointer value, gpointer user_data _U_)
+{
+	g_slist_free((GSList *)value);
+}
+
+gboolean
+enable_lazy_dissection(const GArray *wanted_hfids)
+{
+	GHashTable *parents;
+	GHashTableIter iter;
+	gpointer key, value;
+	GSList *entry;
+	GQueue pending = G_QUEUE_INIT;
+	GArray *hfids;
+	header_field_info *hfinfo;
+	const char *name;
+	int frame_proto, proto;
+	gboolean ok = TRUE;
+	guint i;
+
+	disable_lazy_dissection();
+
+	/* Invert the dependencies: dependent -> list of parents */
+	parents = g_hash_table_new(g_str_hash, g_str_equal);
+	g_hash_table_iter_init(&iter, depend_dissector_lists);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		for (entry = ((depend_dissector_list_t)value)->dissectors; entry; entry = g_slist_next(entry)) {
+			g_hash_table_insert(parents, entry->data,
+			    g_slist_prepend((GSList *)g_hash_table_lookup(parents, entry->data), key));
+		}
+	}
+
+	/* Collect the fields we want, including those of postdissectors */
+	hfids = g_array_new(FALSE, FALSE, (guint)sizeof(int));
+	if (wanted_hfids)
+		g_array_append_vals(hfids, wanted_hfids->data, wanted_hfids->len);
+	for (i = 0; postdissectors && i < postdissectors->len; i++) {
+		if (POSTDISSECTORS(i).wanted_hfids != NULL &&
+		    POSTDISSECTORS(i).handle->protocol != NULL &&
+		    proto_is_protocol_enabled(POSTDISSECTORS(i).handle->protocol))
+			g_array_append_vals(hfids, POSTDISSECTORS(i).wanted_hfids->data,
+			    POSTDISSECTORS(i).wanted_hfids->len);
+	}
+
+	/* Start from the protocols of those fields... */
+	frame_proto = proto_get_id_by_filter_name("frame");
+	for (i = 0; i < hfids->len; i++) {
+		hfinfo = proto_registrar_get_nth(g_array_index(hfids, int, i));
+		if (strcmp(hfinfo->abbrev, "frame.protocols") == 0) {
+			/* Depends on every protocol in the frame */
+			ok = FALSE;
+			break;
+		}
+		proto = (hfinfo->parent == -1) ? hfinfo->id : hfinfo->parent;
+		if (proto == frame_proto)
+			continue;
+		name = proto_get_protocol_short_name(find_protocol_by_id(proto));
+		if (!g_hash_table_contains(parents, name)) {
+			/* We don't know how this protocol is reached */
+			ok = FALSE;
+			break;
+		}
+		g_queue_push_tail(&pending, (gpointer)name);
+	}
+	g_array_free(hfids, TRUE);
+
+	/* ...and add every protocol that can lead to them. */
+	if (ok) {
+		lazy_dissection_protos = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+		while ((name = (const char *)g_queue_pop_head(&pending)) != NULL) {
+			if (g_hash_table_contains(lazy_dissection_protos, name))
+				continue;
+			if (g_hash_table_contains(unknown_parent_protos, name)) {
+				/* It's in a table of no protocol; anything might lead to it */
+				disable_lazy_dissection();
+				ok = FALSE;
+				break;
+			}
+			g_hash_table_add(lazy_dissection_protos, g_strdup(name));
+			for (entry = (GSList *)g_hash_table_lookup(parents, name); entry; entry = g_slist_next(entry)) {
+				g_queue_push_tail(&pending, entry->data);
+			}
+		}
+	}
+	g_queue_clear(&pending);
+
+	g_hash_table_foreach(parents, free_lazy_dissection_parents, NULL);
+	g_hash_table_destroy(parents);
+	return ok;
+}
+
+void
+disable_lazy_dissection(void)
+{
+	if (lazy_dissection_protos) {
+		g_hash_table_destroy(lazy_dissection_protos);
+		lazy_dissection_protos = NULL;
+	}
+}
+
+void
+register_skipped_dissector_routine(const int proto, skipped_dissector_func func)
+{
+	skipped_dissector_routine *routine = g_new(skipped_dissector_routine, 1);
+
+	routine->proto = proto;
+	routine->func = func;
+	skipped_dissector_routines = g_slist_prepend(skipped_dissector_routines, routine);
+}
+
 /*
  * Dumps the "layer type"/"decode as" associations to stdout, similar
  * to the proto_registrar_dump_*() routines.
@@ -663,6 +663,52 @@ WS_DLL_PUBLIC gboolean deregister_depend_dissector(const char* parent, const cha
  */
 WS_DLL_PUBLIC depend_dissector_list_t find_depend_dissector_list(const char* name);
 
+/*
+ * Lazy dissection.
+ *
+ * When enabled, a dissector reached through a dissector table
+ * (dissector_try_uint(), dissector_try_string(), ...) is not called if
+ * its protocol can't lead, through the dependencies recorded with
+ * register_depend_dissector(), to any of the wanted fields or to the
+ * fields wanted by postdissectors; the table lookup reports the whole
+ * tvbuff as dissected instead. Dissectors called directly, heuristic
+ * dissectors and postdissectors always run.
+ *
+ * This is meant for programs that only look at a known set of fields,
+ * e.g. TShark with a display filter and "-T fields"; anything else in
+ * the protocol tree, the columns and the set of protocols in the frame
+ * may be missing.
+ */
+
+/** Turn lazy dissection on for the given fields.
+ *
+ *   @param wanted_hfids array of hfids (type int) that must be dissected
+ *   @return FALSE, leaving lazy dissection off, if a field can't be
+ *   reached through the protocol dependencies
+ */
+WS_DLL_PUBLIC gboolean enable_lazy_dissection(const GArray *wanted_hfids);
+
+/** Turn lazy dissection off. */
+WS_DLL_PUBLIC void disable_lazy_dissection(void);
+
+/** Routine called, instead of the dissector, when a dissector of a
+ * protocol is skipped by lazy dissection. Dissectors that set up state
+ * other protocols depend on, such as the conversations of RTP streams
+ * found in signalling, can use it to do that work without a tree.
+ *
+ * @return the number of bytes consumed, as for a dissector
+ */
+typedef int (*skipped_dissector_func)(tvbuff_t *tvb, packet_info *pinfo, void *data);
+
+/** Register a routine to be called when a dissector for a protocol is
+ * skipped by lazy dissection.
+ *
+ *   @param proto the protocol
+ *   @param func the routine
+ */
+WS_DLL_PUBLIC void register_skipped_dissector_routine(const int proto,
+    skipped_dissector_func func);
+
 
 /* Do all one-time initialization. */
 extern void dissect_init(void);
@@ -27,6 +27,7 @@
 #include <epan/prefs.h>
 #include <epan/print.h>
 #include <epan/charsets.h>
+#include <wsutil/arrow_ipc.h>
 #include <wsutil/json_dumper.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/utf8_entities.h>
@@ -81,6 +82,9 @@ struct _output_fields {
     GPtrArray   **field_values;
     gchar         quote;
     gboolean      includes_col_fields;
+    arrow_writer *arrow;
+    arrow_type_e *arrow_types;
+    field_info  **arrow_values;
 };
 
 static gchar *get_field_hex_value(GSList *src_list, field_info *fi);
@@ -1804,64 +1808,61 @@ static void
 print_escaped_xml(FILE *fh, const char *unescaped_string)
 {
     const char *p;
-
-#define ESCAPED_BUFFER_MAX 256
-    static char temp_buffer[ESCAPED_BUFFER_MAX];
-    gint        offset = 0;
+    size_t      run;
 
     if (fh == NULL || unescaped_string == NULL) {
         return;
     }
 
-    for (p = unescaped_string; *p != '\0' && (offset<(ESCAPED_BUFFER_MAX-1)); p++) {
+    /* Write the runs between characters that need escaping in one go. */
+    for (p = unescaped_string; *p != '\0'; p++) {
+        run = strcspn(p, "&<>\"'");
+        if (run) {
+            fwrite(p, 1, run, fh);
+            p += run;
+            if (*p == '\0') {
+                break;
+            }
+        }
         switch (*p) {
         case '&':
-            (void) g_strlcpy(&temp_buffer[offset], "&amp;", ESCAPED_BUFFER_MAX-offset);
-            offset += 5;
+            fputs("&amp;", fh);
             break;
         case '<':
-            (void) g_strlcpy(&temp_buffer[offset], "&lt;", ESCAPED_BUFFER_MAX-offset);
-            offset += 4;
+            fputs("&lt;", fh);
             break;
         case '>':
-            (void) g_strlcpy(&temp_buffer[offset], "&gt;", ESCAPED_BUFFER_MAX-offset);
-            offset += 4;
+            fputs("&gt;", fh);
             break;
         case '"':
-            (void) g_strlcpy(&temp_buffer[offset], "&quot;", ESCAPED_BUFFER_MAX-offset);
-            offset += 6;
+            fputs("&quot;", fh);
             break;
         case '\'':
-            (void) g_strlcpy(&temp_buffer[offset], "&#x27;", ESCAPED_BUFFER_MAX-offset);
-            offset += 6;
+            fputs("&#x27;", fh);
             break;
-        default:
-            temp_buffer[offset++] = *p;
-        }
-        if (offset > ESCAPED_BUFFER_MAX-8) {
-            /* Getting close to end of buffer so flush to fh */
-            temp_buffer[offset] = '\0';
-            fputs(temp_buffer, fh);
-            offset = 0;
         }
     }
-    if (offset) {
-        /* Flush any outstanding data */
-        temp_buffer[offset] = '\0';
-        fputs(temp_buffer, fh);
-    }
 }
 
 static void
 print_escaped_csv(FILE *fh, const char *unescaped_string)
 {
     const char *p;
+    size_t      run;
 
     if (fh == NULL || unescaped_string == NULL) {
         return;
     }
 
     for (p = unescaped_string; *p != '\0'; p++) {
+        run = strcspn(p, "\b\f\n\r\t");
+        if (run) {
+            fwrite(p, 1, run, fh);
+            p += run;
+            if (*p == '\0') {
+                break;
+            }
+        }
         switch (*p) {
         case '\b':
             fputs("\\b", fh);
@@ -1878,8 +1879,6 @@ print_escaped_csv(FILE *fh, const char *unescaped_string)
         case '\t':
             fputs("\\t", fh);
             break;
-        default:
-            fputc(*p, fh);
         }
     }
 }
@@ -1887,7 +1886,6 @@ print_escaped_csv(FILE *fh, const char *unescaped_string)
 static void
 pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi)
 {
-    int           i;
     const guint8 *pd;
 
     if (!fi->ds_tvb)
@@ -1911,15 +1909,9 @@ pdml_write_field_hex_value(write_pdml_data *pdata, field_info *fi)
             str = str_heap;
         }
 
-        static const char hex[] = "0123456789abcdef";
-
         /* Print a simple hex dump */
-        for (i = 0 ; i < fi->length; i++) {
-            str[2*i] =   hex[pd[i] >> 4];
-            str[2*i+1] = hex[pd[i] & 0xf];
-        }
-        str[2 * fi->length] = '\0';
-        fputs(str, pdata->fh);
+        gchar *end = bytes_to_hexstr(str, pd, fi->length);
+        fwrite(str, 1, end - str, pdata->fh);
         g_free(str_heap);
 
     }
@@ -1942,19 +1934,18 @@ json_write_field_hex_value(write_json_data *pdata, field_info *fi)
     pd = get_field_data(pdata->src_list, fi);
 
     if (pd) {
-        gint i;
-        guint len = fi->length * 2 + 1;
-        gchar* str = (gchar*)g_malloc0(len);
-        static const char hex[] = "0123456789abcdef";
-        /* Print a simple hex dump */
-        for (i = 0; i < fi->length; i++) {
-            guint8 c = pd[i];
-            str[2 * i] = hex[c >> 4];
-            str[2 * i + 1] = hex[c & 0xf];
+        /* Used fixed buffer where can, otherwise temp malloc */
+        gchar str_static[129];
+        gchar *str = str_static;
+        gchar *str_heap = NULL;
+        if (fi->length > 64) {
+            str_heap = (gchar*)g_malloc(fi->length * 2 + 1);
+            str = str_heap;
         }
-        str[2 * fi->length] = '\0';
+        /* Print a simple hex dump */
+        *bytes_to_hexstr(str, pd, fi->length) = '\0';
         json_dumper_value_string(pdata->dumper, str);
-        g_free(str);
+        g_free(str_heap);
     } else {
         json_dumper_value_string(pdata->dumper, "");
     }
@@ -2131,6 +2122,9 @@ void output_fields_free(output_fields_t* fields)
             g_free(fields->field_values);
         }
 
+        g_free(fields->arrow_types);
+        g_free(fields->arrow_values);
+
         for (i = 0; i < fields->fields->len; ++i) {
             gchar* field = (gchar *)g_ptr_array_index(fields->fields,i);
             g_free(field);
@@ -2193,6 +2187,24 @@ output_fields_valid(output_fields_t *fields)
     return invalid_fields;
 }
 
+void
+output_fields_append_hfids(output_fields_t *fields, GArray *hfids)
+{
+    header_field_info *hfinfo;
+    guint i;
+
+    if (fields->fields == NULL) {
+        return;
+    }
+
+    for (i = 0; i < fields->fields->len; i++) {
+        hfinfo = proto_registrar_get_byname((const gchar *)g_ptr_array_index(fields->fields, i));
+        if (hfinfo) {
+            g_array_append_val(hfids, hfinfo->id);
+        }
+    }
+}
+
 gboolean output_fields_set_option(output_fields_t *info, gchar *option)
 {
     const gchar *option_name;
@@ -2443,6 +2455,26 @@ static void proto_tree_get_node_field_values(proto_node *node, gpointer data)
     }
 }
 
+static void output_fields_prepare_indicies(output_fields_t *fields)
+{
+    guint i;
+
+    if (NULL == fields->field_indicies) {
+        /* Prepare a lookup table from string abbreviation for field to its index. */
+        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+
+        i = 0;
+        while (i < fields->fields->len) {
+            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
+            /* Store field indicies +1 so that zero is not a valid value,
+             * and can be distinguished from NULL as a pointer.
+             */
+            ++i;
+            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
+        }
+    }
+}
+
 static void write_specified_fields(fields_format format, output_fields_t *fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh, json_dumper *dumper)
 {
     gsize     i;
@@ -2465,20 +2497,7 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
     data.fields = fields;
     data.edt = edt;
 
-    if (NULL == fields->field_indicies) {
-        /* Prepare a lookup table from string abbreviation for field to its index. */
-        fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
-
-        i = 0;
-        while (i < fields->fields->len) {
-            gchar *field = (gchar *)g_ptr_array_index(fields->fields, i);
-            /* Store field indicies +1 so that zero is not a valid value,
-             * and can be distinguished from NULL as a pointer.
-             */
-            ++i;
-            g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
-        }
-    }
+    output_fields_prepare_indicies(fields);
 
     /* Array buffer to store values for this packet              */
     /*  Allocate an array for the 'GPtrarray *' the first time   */
@@ -2631,6 +2650,212 @@ void write_fields_finale(output_fields_t* fields _U_ , FILE *fh _U_)
     /* Nothing to do */
 }
 
+/* Arrow column type for a field type. Fields without a natural typed
+ * representation are written as (dictionary encoded) strings. */
+static arrow_type_e
+arrow_type_for_ftype(ftenum_t type, guint *width)
+{
+    *width = 0;
+    if (IS_FT_UINT(type)) {
+        return ARROW_TYPE_UINT64;
+    }
+    if (IS_FT_INT(type)) {
+        return ARROW_TYPE_INT64;
+    }
+    switch (type) {
+    case FT_BOOLEAN:
+        return ARROW_TYPE_BOOL;
+    case FT_FLOAT:
+    case FT_DOUBLE:
+        return ARROW_TYPE_DOUBLE;
+    case FT_ABSOLUTE_TIME:
+        return ARROW_TYPE_TIMESTAMP;
+    case FT_RELATIVE_TIME:
+        return ARROW_TYPE_DURATION;
+    case FT_IPv4:
+        *width = 4;
+        return ARROW_TYPE_FIXED_BINARY;
+    case FT_IPv6:
+        *width = 16;
+        return ARROW_TYPE_FIXED_BINARY;
+    case FT_ETHER:
+        *width = FT_ETHER_LEN;
+        return ARROW_TYPE_FIXED_BINARY;
+    case FT_BYTES:
+    case FT_UINT_BYTES:
+        return ARROW_TYPE_BINARY;
+    default:
+        return ARROW_TYPE_STRING;
+    }
+}
+
+void write_arrow_preamble(output_fields_t* fields, FILE *fh)
+{
+    guint i;
+
+    ws_assert(fields);
+    ws_assert(fh);
+    ws_assert(fields->fields);
+
+    fields->arrow = arrow_writer_new(fh, 0);
+    fields->arrow_types = g_new0(arrow_type_e, fields->fields->len);
+    fields->arrow_values = g_new0(field_info *, fields->fields->len);
+
+    for (i = 0; i < fields->fields->len; i++) {
+        const gchar *field = (const gchar *)g_ptr_array_index(fields->fields, i);
+        header_field_info *hfinfo = NULL;
+        arrow_type_e type = ARROW_TYPE_STRING;
+        guint width = 0;
+
+        if (strncmp(field, COLUMN_FIELD_FILTER, strlen(COLUMN_FIELD_FILTER)) != 0) {
+            hfinfo = proto_registrar_get_byname(field);
+        }
+        if (hfinfo) {
+            /* Fields registered more than once under the same name must
+             * all map to the same type, otherwise use strings. */
+            type = arrow_type_for_ftype(hfinfo->type, &width);
+            for (hfinfo = hfinfo->same_name_next; hfinfo; hfinfo = hfinfo->same_name_next) {
+                guint other_width;
+                if (arrow_type_for_ftype(hfinfo->type, &other_width) != type || other_width != width) {
+                    type = ARROW_TYPE_STRING;
+                    width = 0;
+                    break;
+                }
+            }
+        }
+        fields->arrow_types[i] = type;
+        arrow_writer_add_column(fields->arrow, field, type, width);
+    }
+}
+
+static void proto_tree_get_node_arrow_values(proto_node *node, gpointer data)
+{
+    output_fields_t *fields = (output_fields_t *)data;
+    field_info *fi = PNODE_FINFO(node);
+    gpointer    field_index;
+
+    /* dissection with an invisible proto tree? */
+    ws_assert(fi);
+
+    field_index = g_hash_table_lookup(fields->field_indicies, fi->hfinfo->abbrev);
+    if (NULL != field_index) {
+        guint indx = GPOINTER_TO_UINT(field_index) - 1;
+        if (fields->arrow_values[indx] == NULL || fields->occurrence == 'l') {
+            fields->arrow_values[indx] = fi;
+        }
+    }
+
+    if (node->first_child != NULL) {
+        proto_tree_children_foreach(node, proto_tree_get_node_arrow_values, fields);
+    }
+}
+
+/* Writes a field value to a column of the type chosen by write_arrow_preamble. */
+static void write_arrow_value(output_fields_t *fields, guint column, field_info *fi, epan_dissect_t *edt)
+{
+    ftenum_t type = fi->hfinfo->type;
+    const nstime_t *t;
+    guint32 ipv4;
+    guint width;
+    gchar *str;
+
+    arrow_type_for_ftype(type, &width);
+    switch (fields->arrow_types[column]) {
+    case ARROW_TYPE_UINT64:
+        arrow_writer_set_uint(fields->arrow, column, IS_FT_UINT64(type) ?
+                fvalue_get_uinteger64(&fi->value) : fvalue_get_uinteger(&fi->value));
+        return;
+    case ARROW_TYPE_INT64:
+        arrow_writer_set_int(fields->arrow, column, IS_FT_INT64(type) ?
+                fvalue_get_sinteger64(&fi->value) : fvalue_get_sinteger(&fi->value));
+        return;
+    case ARROW_TYPE_BOOL:
+        arrow_writer_set_bool(fields->arrow, column, fvalue_get_uinteger64(&fi->value) != 0);
+        return;
+    case ARROW_TYPE_DOUBLE:
+        arrow_writer_set_double(fields->arrow, column, fvalue_get_floating(&fi->value));
+        return;
+    case ARROW_TYPE_TIMESTAMP:
+    case ARROW_TYPE_DURATION:
+        t = (const nstime_t *)fvalue_get(&fi->value);
+        arrow_writer_set_time(fields->arrow, column, (gint64)t->secs * 1000000000 + t->nsecs);
+        return;
+    case ARROW_TYPE_FIXED_BINARY:
+        if (type == FT_IPv4) {
+            /* In network byte order */
+            ipv4 = fvalue_get_uinteger(&fi->value);
+            arrow_writer_set_bytes(fields->arrow, column, (const guint8 *)&ipv4, 4);
+        } else {
+            arrow_writer_set_bytes(fields->arrow, column, (const guint8 *)fvalue_get(&fi->value), width);
+        }
+        return;
+    case ARROW_TYPE_BINARY:
+        arrow_writer_set_bytes(fields->arrow, column, (const guint8 *)fvalue_get(&fi->value), fvalue_length(&fi->value));
+        return;
+    case ARROW_TYPE_STRING:
+        break;
+    }
+
+    /* The same representation as -T fields. */
+    str = get_node_field_value(fi, edt);
+    if (str) {
+        arrow_writer_set_string(fields->arrow, column, str);
+        g_free(str);
+    }
+}
+
+void write_arrow_proto_tree(output_fields_t* fields, epan_dissect_t *edt, column_info *cinfo, FILE *fh _U_)
+{
+    gint      col;
+    gchar    *col_name;
+    gpointer  field_index;
+    guint     i;
+
+    ws_assert(fields);
+    ws_assert(fields->arrow);
+    ws_assert(edt);
+
+    output_fields_prepare_indicies(fields);
+
+    proto_tree_children_foreach(edt->tree, proto_tree_get_node_arrow_values, fields);
+
+    for (i = 0; i < fields->fields->len; i++) {
+        if (fields->arrow_values[i]) {
+            write_arrow_value(fields, i, fields->arrow_values[i], edt);
+            fields->arrow_values[i] = NULL;
+        }
+    }
+
+    if (fields->includes_col_fields) {
+        for (col = 0; col < cinfo->num_cols; col++) {
+            if (!get_column_visible(col))
+                continue;
+            col_name = g_strdup_printf("%s%s", COLUMN_FIELD_FILTER, cinfo->columns[col].col_title);
+            field_index = g_hash_table_lookup(fields->field_indicies, col_name);
+            g_free(col_name);
+
+            if (NULL != field_index) {
+                arrow_writer_set_string(fields->arrow, GPOINTER_TO_UINT(field_index) - 1, cinfo->columns[col].col_data);
+            }
+        }
+    }
+
+    arrow_writer_end_row(fields->arrow);
+}
+
+gboolean write_arrow_finale(output_fields_t* fields, FILE *fh _U_)
+{
+    gboolean ok = TRUE;
+
+    ws_assert(fields);
+
+    if (fields->arrow) {
+        ok = arrow_writer_finish(fields->arrow);
+        fields->arrow = NULL;
+    }
+    return ok;
+}
+
 /* Returns an g_malloced string */
 gchar* get_node_field_value(field_info* fi, epan_dissect_t* edt)
 {
@@ -153,6 +153,62 @@ void rtd_table_dissector_init(register_rtd_t* rtd, rtd_stat_table* table, rtd_gu
         gui_callback(table, callback_data);
 }
 
+/*
+ * The response times of a range of frames are collected in a table of
+ * their own, which is then added to the table of the frames before them.
+ */
+static void *
+new_partial_rtd_table(void *tapdata)
+{
+    rtd_data_t *rtdd = (rtd_data_t *)tapdata;
+    rtd_data_t *partial = g_new0(rtd_data_t, 1);
+    guint i;
+
+    partial->stat_table.num_rtds = rtdd->stat_table.num_rtds;
+    partial->stat_table.time_stats = g_new0(rtd_timestat, rtdd->stat_table.num_rtds);
+
+    for (i = 0; i < partial->stat_table.num_rtds; i++)
+    {
+        partial->stat_table.time_stats[i].num_timestat = rtdd->stat_table.time_stats[i].num_timestat;
+        partial->stat_table.time_stats[i].rtd = g_new0(timestat_t, rtdd->stat_table.time_stats[i].num_timestat);
+    }
+    partial->user_data = rtdd->user_data;
+
+    return partial;
+}
+
+static void
+merge_rtd_table(void *tapdata, void *partial)
+{
+    rtd_stat_table *table = &((rtd_data_t *)tapdata)->stat_table;
+    rtd_stat_table *later = &((rtd_data_t *)partial)->stat_table;
+    guint i, j;
+
+    for (i = 0; i < table->num_rtds; i++)
+    {
+        for (j = 0; j < table->time_stats[i].num_timestat; j++)
+            time_stat_merge(&table->time_stats[i].rtd[j], &later->time_stats[i].rtd[j]);
+
+        table->time_stats[i].open_req_num += later->time_stats[i].open_req_num;
+        table->time_stats[i].disc_rsp_num += later->time_stats[i].disc_rsp_num;
+        table->time_stats[i].req_dup_num += later->time_stats[i].req_dup_num;
+        table->time_stats[i].rsp_dup_num += later->time_stats[i].rsp_dup_num;
+    }
+}
+
+static void
+free_partial_rtd_table(void *partial)
+{
+    free_rtd_table(&((rtd_data_t *)partial)->stat_table);
+    g_free(partial);
+}
+
+void set_rtd_table_mergeable(rtd_data_t *rtdd)
+{
+    set_tap_listener_mergeable(rtdd, new_partial_rtd_table,
+                               merge_rtd_table, free_partial_rtd_table);
+}
+
 void rtd_table_iterate_tables(wmem_foreach_func func, gpointer user_data)
 {
     wmem_tree_foreach(registered_rtd_tables, func, user_data);
@@ -112,6 +112,14 @@ WS_DLL_PUBLIC register_rtd_t* get_rtd_table_by_name(const char* name);
  */
 WS_DLL_PUBLIC void free_rtd_table(rtd_stat_table* table);
 
+/** Let the RTD tap listener registered with rtdd collect the response
+ * times of ranges of frames separately and merge them; see
+ * set_tap_listener_mergeable().
+ *
+ * @param rtdd the RTD data the tap listener was registered with
+ */
+WS_DLL_PUBLIC void set_rtd_table_mergeable(rtd_data_t *rtdd);
+
 /** Reset table data in the RTD.
  *
  * @param table RTD table
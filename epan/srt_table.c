@@ -261,6 +261,88 @@ add_srt_table_data(srt_stat_table *rst, int indx, const nstime_t *req_time, pack
     time_stat_update(&rp->stats, &delta, pinfo);
 }
 
+/*
+ * The response times of a range of frames are collected in tables of their
+ * own, with the same procedures as the tables of the frames before them,
+ * to which they are then added.
+ */
+static void *
+new_partial_srt_table(void *tapdata)
+{
+    srt_data_t *srtd = (srt_data_t *)tapdata;
+    srt_data_t *partial = g_new0(srt_data_t, 1);
+    guint i;
+    int j;
+
+    partial->srt_array = g_array_new(FALSE, TRUE, sizeof(srt_stat_table*));
+    partial->user_data = srtd->user_data;
+
+    for (i = 0; i < srtd->srt_array->len; i++)
+    {
+        srt_stat_table *rst = g_array_index(srtd->srt_array, srt_stat_table*, i);
+        srt_stat_table *later;
+
+        later = init_srt_table(rst->name, rst->short_name, partial->srt_array, rst->num_procs,
+                               rst->proc_column_name, rst->filter_string, rst->table_specific_data);
+        for (j = 0; j < rst->num_procs; j++)
+        {
+            later->procedures[j].proc_index = rst->procedures[j].proc_index;
+            later->procedures[j].procedure = g_strdup(rst->procedures[j].procedure);
+        }
+    }
+
+    return partial;
+}
+
+static void
+merge_srt_table(void *tapdata, void *partial)
+{
+    srt_data_t *srtd = (srt_data_t *)tapdata;
+    srt_data_t *later_srtd = (srt_data_t *)partial;
+    guint i;
+    int j;
+
+    for (i = 0; i < srtd->srt_array->len && i < later_srtd->srt_array->len; i++)
+    {
+        srt_stat_table *rst = g_array_index(srtd->srt_array, srt_stat_table*, i);
+        srt_stat_table *later = g_array_index(later_srtd->srt_array, srt_stat_table*, i);
+
+        for (j = 0; j < later->num_procs; j++)
+        {
+            /* Procedures discovered in the later frames */
+            if (j >= rst->num_procs ||
+                (rst->procedures[j].procedure == NULL && later->procedures[j].procedure != NULL))
+                init_srt_table_row(rst, j, later->procedures[j].procedure);
+
+            time_stat_merge(&rst->procedures[j].stats, &later->procedures[j].stats);
+        }
+    }
+}
+
+static void
+free_partial_srt_table(void *partial)
+{
+    srt_data_t *srtd = (srt_data_t *)partial;
+    guint i;
+
+    for (i = 0; i < srtd->srt_array->len; i++)
+    {
+        srt_stat_table *rst = g_array_index(srtd->srt_array, srt_stat_table*, i);
+
+        free_srt_table_data(rst);
+        g_free(rst);
+    }
+    g_array_free(srtd->srt_array, TRUE);
+    g_free(srtd);
+}
+
+void
+set_srt_table_mergeable(srt_data_t *srtd)
+{
+    set_tap_listener_mergeable(srtd, new_partial_srt_table,
+                               merge_srt_table, free_partial_srt_table);
+}
+
 /*
  * Editor modelines
  *
@@ -129,6 +129,14 @@ WS_DLL_PUBLIC void free_srt_table_data(srt_stat_table *rst);
  */
 WS_DLL_PUBLIC void free_srt_table(register_srt_t *srt, GArray* srt_array);
 
+/** Let the SRT tap listener registered with srtd collect the response
+ * times of ranges of frames separately and merge them; see
+ * set_tap_listener_mergeable().
+ *
+ * @param srtd the SRT data the tap listener was registered with
+ */
+WS_DLL_PUBLIC void set_srt_table_mergeable(srt_data_t *srtd);
+
 /** Reset ALL tables in the srt.
  *
  * @param srt_array SRT table array
@@ -91,6 +91,10 @@ typedef struct _tap_listener_t {
 	tap_packet_cb packet;
 	tap_draw_cb draw;
 	tap_finish_cb finish;
+	tap_partial_new_cb partial_new;
+	tap_partial_merge_cb partial_merge;
+	tap_partial_free_cb partial_free;
+	void *partial;	/* state for the current range of frames, if any */
 } tap_listener_t;
 
 static tap_listener_t *tap_listener_queue=NULL;
@@ -359,7 +363,7 @@ tap_push_tapped_queue(epan_dissect_t *edt)
 					/* So call the per-packet routine. */
 					tap_packet_status status;
 
-					status = tl->packet(tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
+					status = tl->packet(tl->partial ? tl->partial : tl->tapdata, tp->pinfo, edt, tp->tap_specific_data);
 
 					switch (status) {
 
@@ -436,6 +440,10 @@ reset_tap_listeners(void)
 		if(tl->reset){
 			tl->reset(tl->tapdata);
 		}
+		if(tl->partial){
+			tl->partial_free(tl->partial);
+			tl->partial=NULL;
+		}
 		tl->needs_redraw=TRUE;
 		tl->failed=FALSE;
 	}
@@ -514,6 +522,9 @@ free_tap_listener(tap_listener_t *tl)
 	 * If this is changed make sure the finish callback is not called
 	 * twice to prevent double-free errors.
 	 */
+	if (tl->partial) {
+		tl->partial_free(tl->partial);
+	}
 	if (tl->finish) {
 		tl->finish(tl->tapdata);
 	}
@@ -688,6 +699,79 @@ remove_tap_listener(void *tapdata)
 	free_tap_listener(tl);
 }
 
+/* this function declares that the results of a tap listener can be
+ * collected for ranges of frames and merged
+ */
+void
+set_tap_listener_mergeable(void *tapdata, tap_partial_new_cb partial_new,
+			   tap_partial_merge_cb partial_merge,
+			   tap_partial_free_cb partial_free)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->tapdata==tapdata){
+			tl->partial_new=partial_new;
+			tl->partial_merge=partial_merge;
+			tl->partial_free=partial_free;
+			return;
+		}
+	}
+	ws_warning("set_tap_listener_mergeable(): no listener found with that tap data");
+}
+
+/*
+ * Return TRUE if every tap listener that requires dissection can collect
+ * its results for ranges of frames, FALSE otherwise.
+ */
+gboolean
+tap_listeners_mergeable(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->flags & TL_IS_DISSECTOR_HELPER)
+			continue;
+		if(tl->packet && !tl->partial_new)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/* This function starts a new range of frames for the mergeable tap
+ * listeners. Listeners that aren't mergeable keep getting the packets
+ * in their tapdata.
+ */
+void
+begin_partial_tap_listeners(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->partial_new && !tl->partial){
+			tl->partial=tl->partial_new(tl->tapdata);
+		}
+	}
+}
+
+/* This function merges the results of the current range of frames into
+ * the tapdata of the mergeable tap listeners.
+ */
+void
+merge_partial_tap_listeners(void)
+{
+	tap_listener_t *tl;
+
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(tl->partial){
+			tl->partial_merge(tl->tapdata, tl->partial);
+			tl->partial_free(tl->partial);
+			tl->partial=NULL;
+			tl->needs_redraw=TRUE;
+		}
+	}
+}
+
 /*
  * Return TRUE if we have one or more tap listeners that require dissection,
  * FALSE otherwise.
@@ -739,6 +823,34 @@ have_filtering_tap_listeners(void)
 	return FALSE;
 }
 
+/*
+ * Return TRUE if every tap listener has a filter of the form
+ * "field == value" (see dfilter_get_uint_eq()) with the same field and
+ * value, FALSE otherwise. If there are no tap listeners, *hfid is set
+ * to -1.
+ */
+gboolean
+tap_listeners_dfilter_uint_eq(int *hfid, guint32 *value)
+{
+	tap_listener_t *tl;
+	int tl_hfid;
+	guint32 tl_value;
+
+	*hfid=-1;
+	*value=0;
+	for(tl=tap_listener_queue;tl;tl=tl->next){
+		if(!dfilter_get_uint_eq(tl->code, &tl_hfid, &tl_value))
+			return FALSE;
+		if(tl==tap_listener_queue){
+			*hfid=tl_hfid;
+			*value=tl_value;
+		} else if(tl_hfid!=*hfid || tl_value!=*value){
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 /*
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
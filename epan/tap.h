@@ -32,6 +32,9 @@ typedef void (*tap_reset_cb)(void *tapdata);
 typedef tap_packet_status (*tap_packet_cb)(void *tapdata, packet_info *pinfo, epan_dissect_t *edt, const void *data);
 typedef void (*tap_draw_cb)(void *tapdata);
 typedef void (*tap_finish_cb)(void *tapdata);
+typedef void *(*tap_partial_new_cb)(void *tapdata);
+typedef void (*tap_partial_merge_cb)(void *tapdata, void *partial);
+typedef void (*tap_partial_free_cb)(void *partial);
 
 /**
  * Flags to indicate what a tap listener's packet routine requires.
@@ -235,6 +238,41 @@ WS_DLL_PUBLIC void tap_listeners_dfilter_recompile(void);
 /** this function removes a tap listener */
 WS_DLL_PUBLIC void remove_tap_listener(void *tapdata);
 
+/** This function declares that the results of a tap listener can be
+ * collected separately for ranges of frames and merged afterwards.
+ *
+ * @param tapdata       The instance identifier passed to register_tap_listener().
+ * @param partial_new   void *(*partial_new)(void *tapdata)
+ *                      Returns a new, empty state for collecting the results
+ *                      of a range of frames in. While a range is tapped, the
+ *                      packet callback is handed this state instead of
+ *                      tapdata, so it must be of the same type.
+ * @param partial_merge void (*partial_merge)(void *tapdata, void *partial)
+ *                      Adds the results collected in partial to tapdata.
+ *                      Ranges are merged in frame order, so the result must
+ *                      be the same as if the frames had been tapped into
+ *                      tapdata directly.
+ * @param partial_free  void (*partial_free)(void *partial)
+ *                      Frees a state returned by partial_new.
+ */
+WS_DLL_PUBLIC void set_tap_listener_mergeable(void *tapdata,
+    tap_partial_new_cb partial_new, tap_partial_merge_cb partial_merge,
+    tap_partial_free_cb partial_free);
+
+/** Return TRUE if the results of every tap listener that requires
+ * dissection can be collected for ranges of frames and merged, FALSE
+ * otherwise. */
+WS_DLL_PUBLIC gboolean tap_listeners_mergeable(void);
+
+/** This function starts a new range of frames: until
+ * merge_partial_tap_listeners() is called, every mergeable tap listener
+ * collects its results in a new, empty state. */
+WS_DLL_PUBLIC void begin_partial_tap_listeners(void);
+
+/** This function ends a range of frames, merging the results every
+ * mergeable tap listener has collected for it into its tapdata. */
+WS_DLL_PUBLIC void merge_partial_tap_listeners(void);
+
 /**
  * Return TRUE if we have one or more tap listeners that require dissection,
  * FALSE otherwise.
@@ -247,6 +285,11 @@ WS_DLL_PUBLIC gboolean have_tap_listener(int tap_id);
 /** Return TRUE if we have any tap listeners with filters, FALSE otherwise. */
 WS_DLL_PUBLIC gboolean have_filtering_tap_listeners(void);
 
+/** Return TRUE if all tap listeners only accept packets where the field
+ * hfid equals value, FALSE otherwise. If there are no tap listeners,
+ * hfid is set to -1. */
+WS_DLL_PUBLIC gboolean tap_listeners_dfilter_uint_eq(int *hfid, guint32 *value);
+
 /**
  * Get the union of all the flags for all the tap listeners; that gives
  * an indication of whether the protocol tree, or the columns, are
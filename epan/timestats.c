@@ -56,6 +56,36 @@ time_stat_update(timestat_t *stats, const nstime_t *delta, packet_info *pinfo)
 	stats->num++;
 }
 
+/* Add the samples of a timestat_t struct, updated with later frames, to
+ * another; the result is the same as if all the samples had been added
+ * to stats, in frame order. */
+void
+time_stat_merge(timestat_t *stats, const timestat_t *later)
+{
+	if(later->num==0){
+		return;
+	}
+
+	if(stats->num==0){
+		*stats=*later;
+		return;
+	}
+
+	if(nstime_cmp(&later->min, &stats->min) < 0){
+		stats->min=later->min;
+		stats->min_num=later->min_num;
+	}
+
+	if(nstime_cmp(&later->max, &stats->max) > 0){
+		stats->max=later->max;
+		stats->max_num=later->max_num;
+	}
+
+	nstime_add(&stats->tot, &later->tot);
+
+	stats->num+=later->num;
+}
+
 /*
  * get_average - function
  *
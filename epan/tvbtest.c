@@ -18,6 +18,7 @@
 #include "tvbuff.h"
 #include "exceptions.h"
 #include "wsutil/pint.h"
+#include "wsutil/time_util.h"
 
 gboolean failed = FALSE;
 
@@ -375,6 +376,52 @@ test(tvbuff_t *tvb, const gchar* name,
 		}
 	}
 
+	/* Search from the start of the tvb for the guint8 and guint16 at each
+	 * offset; these have to find the first occurrence, which for a
+	 * composite tvb may be in a different member than the one the
+	 * search started in. */
+	for (i = 0; i < length; i++) {
+		search_test_params sp;
+		guint first8, first16;
+
+		memset(&sp, 0, sizeof sp);
+
+		sp.g8.needle = expected_data[i];
+		for (first8 = 0; expected_data[first8] != sp.g8.needle; first8++)
+			;
+
+		sp.g16.test = length - i > 1;
+		first16 = 0;
+		if (sp.g16.test) {
+			sp.g16.needle = (expected_data[i] << 8) | expected_data[i + 1];
+			while (expected_data[first16] != expected_data[i] ||
+			       expected_data[first16 + 1] != expected_data[i + 1])
+				first16++;
+		}
+
+		ex_thrown = test_searches(tvb, 0, &sp);
+		if (ex_thrown) {
+			printf("14: Failed TVB=%s Exception when searching from 0\n",
+					name);
+			failed = TRUE;
+			return FALSE;
+		}
+		if ((guint)sp.g8.offset != first8) {
+			printf("14: Failed TVB=%s Wrong offset for guint8:%02x,"
+					" got %d, expected %u\n",
+					name, sp.g8.needle, sp.g8.offset, first8);
+			failed = TRUE;
+			return FALSE;
+		}
+		if (sp.g16.test && (guint)sp.g16.offset != first16) {
+			printf("14: Failed TVB=%s Wrong offset for guint16:%04x,"
+					" got %d, expected %u\n",
+					name, sp.g16.needle, sp.g16.offset, first16);
+			failed = TRUE;
+			return FALSE;
+		}
+	}
+
 
 	printf("Passed TVB=%s\n", name);
 
@@ -605,9 +652,92 @@ run_tests(void)
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
 
+/*
+ * Search timings, for comparing changes to the tvbuff search routines.
+ * They aren't run by default; run "tvbtest --perf" to see them.
+ */
+#define PERF_DATA_LENGTH	(1024 * 1024)
+#define PERF_MEMBERS		64
+#define PERF_LOOP_COUNT		100
+
+#define RESOURCE_USAGE_START get_resource_usage(&start_utime, &start_stime)
+
+#define RESOURCE_USAGE_END \
+	get_resource_usage(&end_utime, &end_stime); \
+	utime_ms = (end_utime - start_utime) * 1000.0; \
+	stime_ms = (end_stime - start_stime) * 1000.0
+
+static void
+run_perf_tests(void)
+{
+	double		start_utime, start_stime, end_utime, end_stime;
+	double		utime_ms, stime_ms;
+	guint8		*data;
+	tvbuff_t	*tvb_parent;
+	tvbuff_t	*tvb_real;
+	tvbuff_t	*tvb_comp;
+	ws_mempbrk_pattern pattern;
+	guchar		found_needle;
+	gint		found = 0;
+	int		i;
+
+	/* Every byte is a candidate for the first byte of the CRLF, which
+	 * is only found in the last two bytes. */
+	data = (guint8 *)g_malloc(PERF_DATA_LENGTH);
+	memset(data, '\r', PERF_DATA_LENGTH);
+	data[PERF_DATA_LENGTH - 1] = '\n';
+
+	tvb_parent = tvb_new_real_data((const guint8*)"", 0, 0);
+	tvb_real = tvb_new_child_real_data(tvb_parent, data, PERF_DATA_LENGTH, PERF_DATA_LENGTH);
+
+	tvb_comp = tvb_new_composite();
+	for (i = 0; i < PERF_MEMBERS; i++) {
+		tvb_composite_append(tvb_comp,
+		    tvb_new_subset_length(tvb_real, i * (PERF_DATA_LENGTH / PERF_MEMBERS), PERF_DATA_LENGTH / PERF_MEMBERS));
+	}
+	tvb_composite_finalize(tvb_comp);
+
+	ws_mempbrk_compile(&pattern, "\n");
+
+	RESOURCE_USAGE_START;
+	for (i = 0; i < PERF_LOOP_COUNT; i++) {
+		found = tvb_find_guint16(tvb_real, 0, -1, 0x0d0a);
+	}
+	RESOURCE_USAGE_END;
+	printf("tvb_find_guint16, %u bytes, found at %d: u %.3f ms s %.3f ms\n",
+	    PERF_DATA_LENGTH, found, utime_ms, stime_ms);
+
+	RESOURCE_USAGE_START;
+	for (i = 0; i < PERF_LOOP_COUNT; i++) {
+		found = tvb_find_guint16(tvb_comp, 0, -1, 0x0d0a);
+	}
+	RESOURCE_USAGE_END;
+	printf("tvb_find_guint16, composite of %u, found at %d: u %.3f ms s %.3f ms\n",
+	    PERF_MEMBERS, found, utime_ms, stime_ms);
+
+	RESOURCE_USAGE_START;
+	for (i = 0; i < PERF_LOOP_COUNT; i++) {
+		found = tvb_find_guint8(tvb_comp, 0, -1, '\n');
+	}
+	RESOURCE_USAGE_END;
+	printf("tvb_find_guint8, composite of %u, found at %d: u %.3f ms s %.3f ms\n",
+	    PERF_MEMBERS, found, utime_ms, stime_ms);
+
+	RESOURCE_USAGE_START;
+	for (i = 0; i < PERF_LOOP_COUNT; i++) {
+		found = tvb_ws_mempbrk_pattern_guint8(tvb_comp, 0, -1, &pattern, &found_needle);
+	}
+	RESOURCE_USAGE_END;
+	printf("tvb_ws_mempbrk_pattern_guint8, composite of %u, found at %d: u %.3f ms s %.3f ms\n",
+	    PERF_MEMBERS, found, utime_ms, stime_ms);
+
+	tvb_free_chain(tvb_parent);
+	g_free(data);
+}
+
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
-main(void)
+main(int argc, char **argv)
 {
 	/* For valgrind: See GLib documentation: "Running GLib Applications" */
 	g_setenv("G_DEBUG", "gc-friendly", 1);
@@ -615,6 +745,8 @@ main(void)
 
 	except_init();
 	run_tests();
+	if (argc > 1 && strcmp(argv[1], "--perf") == 0)
+		run_perf_tests();
 	except_deinit();
 	exit(failed?1:0);
 }
@@ -2342,47 +2342,69 @@ tvb_find_guint8(tvbuff_t *tvb, const gint offset, const gint maxlength, const gu
 	if (tvb->ops->tvb_find_guint8)
 		return tvb->ops->tvb_find_guint8(tvb, abs_offset, limit, needle);
 
-	return tvb_find_guint8_generic(tvb, offset, limit, needle);
+	return tvb_find_guint8_generic(tvb, abs_offset, limit, needle);
 }
 
-/* Same as tvb_find_guint8() with 16bit needle. */
+/* Same as tvb_find_guint8() with 16bit needle. Both bytes of the needle
+ * have to be within maxlength bytes of offset. */
 gint
 tvb_find_guint16(tvbuff_t *tvb, const gint offset, const gint maxlength,
 		 const guint16 needle)
 {
 	const guint8 needle1 = ((needle & 0xFF00) >> 8);
 	const guint8 needle2 = ((needle & 0x00FF) >> 0);
-	gint searched_bytes = 0;
-	gint pos = offset;
-
-	do {
-		gint offset1 =
-			tvb_find_guint8(tvb, pos, maxlength - searched_bytes, needle1);
-		gint offset2 = -1;
-
-		if (offset1 == -1) {
-			return -1;
-		}
+	const guint8 *ptr;
+	const guint8 *end;
+	const guint8 *result;
+	guint	      abs_offset = 0;
+	guint	      limit = 0;
+	gint	      pos, found;
+	int           exception;
 
-		searched_bytes = offset - pos + 1;
+	DISSECTOR_ASSERT(tvb && tvb->initialized);
 
-		if ((maxlength != -1) && (searched_bytes >= maxlength)) {
-			return -1;
-		}
+	exception = compute_offset_and_remaining(tvb, offset, &abs_offset, &limit);
+	if (exception)
+		THROW(exception);
 
-		offset2 = tvb_find_guint8(tvb, offset1 + 1, 1, needle2);
+	/* Only search to end of tvbuff, w/o throwing exception. */
+	if (maxlength >= 0 && limit > (guint) maxlength) {
+		limit = (guint) maxlength;
+	}
 
-		searched_bytes += 1;
+	if (limit < 2)
+		return -1;
 
-		if (offset2 != -1) {
-			if ((maxlength != -1) && (searched_bytes > maxlength)) {
+	/* If we have real data, scan it in place: memchr() for the first
+	 * byte, then check the one after it. */
+	if (tvb->real_data) {
+		ptr = tvb->real_data + abs_offset;
+		end = ptr + limit - 1;	/* last place the first byte can be */
+		while (ptr < end) {
+			result = (const guint8 *)memchr(ptr, needle1, end - ptr);
+			if (result == NULL)
 				return -1;
-			}
-			return offset1;
+			if (result[1] == needle2)
+				return (gint) (result - tvb->real_data);
+			ptr = result + 1;
 		}
+		return -1;
+	}
 
-		pos = offset1 + 1;
-	} while (searched_bytes < maxlength);
+	/* Otherwise go through tvb_find_guint8(), so that subsets and
+	 * composites search their backing tvbuffs rather than being
+	 * flattened. */
+	pos = (gint) abs_offset;
+	limit -= 1;
+	while (limit > 0) {
+		found = tvb_find_guint8(tvb, pos, limit, needle1);
+		if (found == -1)
+			return -1;
+		if (tvb_get_guint8(tvb, found + 1) == needle2)
+			return found;
+		limit -= (guint) (found + 1 - pos);
+		pos = found + 1;
+	}
 
 	return -1;
 }
@@ -18,6 +18,12 @@
 typedef struct {
 	GSList		*tvbs;
 
+	/* The members in an array, set up by tvb_composite_finalize(),
+	 * so that finding the member with a given offset is a binary
+	 * search rather than a walk through the list. */
+	tvbuff_t	**members;
+	guint		num_members;
+
 	/* Used for quick testing to see if this
 	 * is the tvbuff that a COMPOSITE is
 	 * interested in. */
@@ -40,6 +46,7 @@ composite_free(tvbuff_t *tvb)
 
 	g_slist_free(composite->tvbs);
 
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
 	g_free((gpointer)tvb->real_data);
@@ -51,37 +58,48 @@ composite_offset(const tvbuff_t *tvb _U_, const guint counter)
 	return counter;
 }
 
+/* Returns the index of the member that abs_offset is in, or num_members
+ * if it's past the end of the composite. */
+static guint
+composite_find_member(const tvb_comp_t *composite, guint abs_offset)
+{
+	guint low = 0, high = composite->num_members;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+
+		if (abs_offset <= composite->end_offsets[mid])
+			high = mid;
+		else
+			low = mid + 1;
+	}
+
+	return low;
+}
+
 static const guint8*
 composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
@@ -92,7 +110,9 @@ composite_get_ptr(tvbuff_t *tvb, guint abs_offset, guint abs_length)
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
 	else {
-		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
+		/* Flatten the whole composite.  From now on, tvb->real_data
+		 * is used for all accesses, so this is only done once.
+		 * Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
 		void *real_data = g_malloc(tvb->length);
 		tvb_memcpy(tvb, real_data, 0, tvb->length);
 		tvb->real_data = (const guint8 *)real_data;
@@ -108,63 +128,114 @@ composite_memcpy(tvbuff_t *tvb, void* _target, guint abs_offset, guint abs_lengt
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	guint8 *target = (guint8 *) _target;
 
-	guint	    i, num_members;
+	guint	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	guint	    member_offset, member_length;
-	GSList	   *slist;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
-	composite   = &composite_tvb->composite;
-	num_members = g_slist_length(composite->tvbs);
-
-	for (i = 0; i < num_members; i++) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			slist = g_slist_nth(composite->tvbs, i);
-			member_tvb = (tvbuff_t *)slist->data;
-			break;
-		}
-	}
+	composite = &composite_tvb->composite;
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
 		DISSECTOR_ASSERT(!tvb->real_data);
 		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
 	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
+
+	/* The requested data is non-contiguous inside
+	 * the member tvb. We have to memcpy() the part that's in the member tvb,
+	 * then iterate across the other member tvb's, copying their portions
+	 * until we have copied all data.
+	 */
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->num_members);
+		member_tvb = composite->members[i];
 		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
 
-		/* composite_memcpy() can't handle a member_length of zero. */
+		/* We can't handle a member_length of zero. */
 		DISSECTOR_ASSERT(member_length > 0);
 
+		if (member_length > abs_length)
+			member_length = abs_length;
+
 		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
+		target		+= member_length;
 		abs_length	-= member_length;
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-		}
+		member_offset = 0;
+		i++;
+	}
 
-		return target;
+	return _target;
+}
+
+/*
+ * Searches go through the members one at a time, so that looking for a
+ * needle doesn't have to flatten the whole composite with
+ * composite_get_ptr().
+ */
+static gint
+composite_find_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, guint8 needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	tvbuff_t   *member_tvb;
+	guint	    member_offset, member_limit;
+	guint	    i;
+	gint	    result;
+
+	for (i = composite_find_member(composite, abs_offset); i < composite->num_members && limit > 0; i++) {
+		member_tvb    = composite->members[i];
+		member_offset = abs_offset - composite->start_offsets[i];
+		member_limit  = MIN(limit, composite->end_offsets[i] - abs_offset + 1);
+
+		result = tvb_find_guint8(member_tvb, member_offset, member_limit, needle);
+		if (result != -1)
+			return result + composite->start_offsets[i];
+
+		abs_offset += member_limit;
+		limit      -= member_limit;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return -1;
+}
+
+static gint
+composite_pbrk_guint8(tvbuff_t *tvb, guint abs_offset, guint limit, const ws_mempbrk_pattern* pattern, guchar *found_needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	tvbuff_t   *member_tvb;
+	guint	    member_offset, member_limit;
+	guint	    i;
+	gint	    result;
+
+	for (i = composite_find_member(composite, abs_offset); i < composite->num_members && limit > 0; i++) {
+		member_tvb    = composite->members[i];
+		member_offset = abs_offset - composite->start_offsets[i];
+		member_limit  = MIN(limit, composite->end_offsets[i] - abs_offset + 1);
+
+		result = tvb_ws_mempbrk_pattern_guint8(member_tvb, member_offset, member_limit, pattern, found_needle);
+		if (result != -1)
+			return result + composite->start_offsets[i];
+
+		abs_offset += member_limit;
+		limit      -= member_limit;
+	}
+
+	return -1;
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -174,8 +245,8 @@ static const struct tvb_ops tvb_composite_ops = {
 	composite_offset,     /* offset */
 	composite_get_ptr,    /* get_ptr */
 	composite_memcpy,     /* memcpy */
-	NULL,                 /* find_guint8 XXX */
-	NULL,                 /* pbrk_guint8 XXX */
+	composite_find_guint8, /* find_guint8 */
+	composite_pbrk_guint8, /* pbrk_guint8 */
 	NULL,                 /* clone */
 };
 
@@ -199,6 +270,8 @@ tvb_new_composite(void)
 	tvb_comp_t *composite = &composite_tvb->composite;
 
 	composite->tvbs		 = NULL;
+	composite->members	 = NULL;
+	composite->num_members	 = 0;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
 
@@ -276,12 +349,15 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->members = g_new(tvbuff_t *, num_members);
+	composite->num_members = num_members;
 	composite->start_offsets = g_new(guint, num_members);
 	composite->end_offsets = g_new(guint, num_members);
 
 	for (slist = composite->tvbs; slist != NULL; slist = slist->next) {
 		DISSECTOR_ASSERT((guint) i < num_members);
 		member_tvb = (tvbuff_t *)slist->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
@@ -37,6 +37,7 @@
 #include <epan/prefs.h>
 #include <epan/dfilter/dfilter.h>
 #include <epan/epan_dissect.h>
+#include <epan/follow.h>
 #include <epan/tap.h>
 #include <epan/timestamp.h>
 #include <epan/dfilter/dfilter-macro.h>
@@ -117,6 +118,10 @@ static void cf_rename_failure_alert_box(const char *filename, int err);
 /* Show the progress bar after this many seconds. */
 #define PROGBAR_SHOW_DELAY 0.5
 
+/* Number of frames mergeable tap listeners collect their results for
+   separately when retapping, before merging them. */
+#define RETAP_RANGE_FRAMES 65536
+
 /*
  * Maximum number of records we support in a file.
  *
@@ -251,7 +256,8 @@ ws_epan_new(capture_file *cf)
     ws_get_frame_ts,
     cap_file_provider_get_interface_name,
     cap_file_provider_get_interface_description,
-    cap_file_provider_get_modified_block
+    cap_file_provider_get_modified_block,
+    cap_file_provider_get_time_shift
   };
 
   return epan_new(&cf->provider, &funcs);
@@ -410,6 +416,10 @@ cf_close(capture_file *cf)
     g_tree_destroy(cf->provider.frames_modified_blocks);
     cf->provider.frames_modified_blocks = NULL;
   }
+  if (cf->provider.frames_time_shifts) {
+    g_array_free(cf->provider.frames_time_shifts, TRUE);
+    cf->provider.frames_time_shifts = NULL;
+  }
   cf_unselect_packet(cf);   /* nothing to select */
   cf->first_displayed = 0;
   cf->last_displayed = 0;
@@ -1646,6 +1656,13 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
   gboolean    compiled _U_;
   guint32     frames_count;
   gboolean    queued_rescan_type = RESCAN_NONE;
+  int         stream_hfid, tap_stream_hfid;
+  guint32     stream, tap_stream;
+  const guint32 *stream_frames = NULL;
+  guint       num_stream_frames = 0;
+  guint       stream_frame_idx = 0;
+  gboolean    use_stream_index = FALSE;
+  gboolean    dissect_frame;
 
   /* Rescan in progress, clear pending actions. */
   cf->redissection_queued = RESCAN_NONE;
@@ -1774,6 +1791,22 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
 
   epan_dissect_init(&edt, cf->epan, create_proto_tree, FALSE);
 
+  /*
+   * If the filter only matches the frames of one stream ("tcp.stream == 3",
+   * as set up by "Follow Stream"), no tap listener wants any other frame,
+   * and we recorded on the first pass which frames belong to that stream,
+   * we don't have to dissect the others to know they won't be displayed.
+   * If no frame has that stream, none is dissected.
+   * When redissecting, the first pass is done again, so we can't.
+   */
+  if (!redissect && dfilter_get_uint_eq(dfcode, &stream_hfid, &stream) &&
+      tap_listeners_dfilter_uint_eq(&tap_stream_hfid, &tap_stream) &&
+      (tap_stream_hfid == -1 ||
+       (tap_stream_hfid == stream_hfid && tap_stream == stream))) {
+    use_stream_index = follow_stream_index_get_frames(stream_hfid, stream,
+                                                      &stream_frames, &num_stream_frames);
+  }
+
   if (redissect) {
     /*
      * Decryption secrets are read while sequentially processing records and
@@ -1858,8 +1891,24 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
     /* Frame dependencies from the previous dissection/filtering are no longer valid. */
     fdata->dependent_of_displayed = 0;
 
-    if (!cf_read_record(cf, fdata, &rec, &buf))
+    dissect_frame = TRUE;
+    if (use_stream_index && !fdata->ref_time) {
+      while (stream_frame_idx < num_stream_frames &&
+             stream_frames[stream_frame_idx] < fdata->num)
+        stream_frame_idx++;
+      dissect_frame = stream_frame_idx < num_stream_frames &&
+                      stream_frames[stream_frame_idx] == fdata->num;
+    }
+
+    if (!dissect_frame) {
+      /* Not part of the stream, so it can't pass the filter. */
+      frame_data_set_before_dissect(fdata, &cf->elapsed_time,
+                                    &cf->provider.ref, cf->provider.prev_dis);
+      cf->provider.prev_cap = fdata;
+      fdata->passed_dfilter = 0;
+    } else if (!cf_read_record(cf, fdata, &rec, &buf)) {
       break; /* error reading the frame */
+    }
 
     /* If the previous frame is displayed, and we haven't yet seen the
        selected frame, remember that frame - it's the closest one we've
@@ -1869,9 +1918,10 @@ rescan_packets(capture_file *cf, const char *action, const char *action_item, gb
       preceding_frame = prev_frame;
     }
 
-    add_packet_to_packet_list(fdata, cf, &edt, dfcode,
-                                    cinfo, &rec, &buf,
-                                    add_to_packet_list);
+    if (dissect_frame)
+      add_packet_to_packet_list(fdata, cf, &edt, dfcode,
+                                      cinfo, &rec, &buf,
+                                      add_to_packet_list);
 
     /* If this frame is displayed, and this is the first frame we've
        seen displayed after the selected frame, remember this frame -
@@ -2025,6 +2075,7 @@ cf_reftime_packets(capture_file* cf)
   cf->provider.ref = NULL;
   cf->provider.prev_dis = NULL;
   cf->cum_bytes = 0;
+  cf->frames_state_gen++;
 
   for (framenum = 1; framenum <= cf->count; framenum++) {
     fdata = frame_data_sequence_find(cf->provider.frames, framenum);
@@ -2098,15 +2149,21 @@ typedef enum {
   PSP_FAILED
 } psp_return_t;
 
+/*
+ * Process the records selected by "range", or, if "frames" isn't NULL,
+ * only the "num_frames" frames it lists, in ascending order.
+ */
 static psp_return_t
-process_specified_records(capture_file *cf, packet_range_t *range,
+process_records(capture_file *cf, packet_range_t *range,
+    const guint32 *frames, guint num_frames,
     const char *string1, const char *string2, gboolean terminate_is_stop,
     gboolean (*callback)(capture_file *, frame_data *,
                          wtap_rec *, Buffer *, void *),
     void *callback_args,
     gboolean show_progress_bar)
 {
-  guint32          framenum;
+  guint32          i;
+  guint32          frames_count;
   frame_data      *fdata;
   wtap_rec         rec;
   Buffer           buf;
@@ -2139,10 +2196,13 @@ process_specified_records(capture_file *cf, packet_range_t *range,
   if (range != NULL)
     packet_range_process_init(range);
 
+  frames_count = frames != NULL ? num_frames : cf->count;
+
   /* Iterate through all the packets, printing the packets that
      were selected by the current display filter.  */
-  for (framenum = 1; framenum <= cf->count; framenum++) {
-    fdata = frame_data_sequence_find(cf->provider.frames, framenum);
+  for (i = 0; i < frames_count; i++) {
+    fdata = frame_data_sequence_find(cf->provider.frames,
+                                     frames != NULL ? frames[i] : i + 1);
 
     /* Create the progress bar if necessary.
        We check on every iteration of the loop, so that it takes no
@@ -2165,11 +2225,11 @@ process_specified_records(capture_file *cf, packet_range_t *range,
       /* let's not divide by zero. I should never be started
        * with count == 0, so let's assert that
        */
-      ws_assert(cf->count > 0);
-      progbar_val = (gfloat) progbar_count / cf->count;
+      ws_assert(frames_count > 0);
+      progbar_val = (gfloat) progbar_count / frames_count;
 
       g_snprintf(progbar_status_str, sizeof(progbar_status_str),
-                  "%4u of %u packets", progbar_count, cf->count);
+                  "%4u of %u packets", progbar_count, frames_count);
       update_progress_dlg(progbar, progbar_val, progbar_status_str);
 
       g_timer_start(prog_timer);
@@ -2227,9 +2287,24 @@ process_specified_records(capture_file *cf, packet_range_t *range,
   return ret;
 }
 
+static psp_return_t
+process_specified_records(capture_file *cf, packet_range_t *range,
+    const char *string1, const char *string2, gboolean terminate_is_stop,
+    gboolean (*callback)(capture_file *, frame_data *,
+                         wtap_rec *, Buffer *, void *),
+    void *callback_args,
+    gboolean show_progress_bar)
+{
+  return process_records(cf, range, NULL, 0, string1, string2,
+                         terminate_is_stop, callback, callback_args,
+                         show_progress_bar);
+}
+
 typedef struct {
   epan_dissect_t edt;
   column_info *cinfo;
+  gboolean partial;       /* tapping ranges of frames separately */
+  guint range_frames;     /* frames tapped in the current range */
 } retap_callback_args_t;
 
 static gboolean
@@ -2243,6 +2318,12 @@ retap_packet(capture_file *cf, frame_data *fdata, wtap_rec *rec, Buffer *buf,
                              fdata, args->cinfo);
   epan_dissect_reset(&args->edt);
 
+  if (args->partial && ++args->range_frames == RETAP_RANGE_FRAMES) {
+    merge_partial_tap_listeners();
+    begin_partial_tap_listeners();
+    args->range_frames = 0;
+  }
+
   return TRUE;
 }
 
@@ -2253,6 +2334,10 @@ cf_retap_packets(capture_file *cf)
   retap_callback_args_t callback_args;
   gboolean              create_proto_tree;
   guint                 tap_flags;
+  int                   stream_hfid;
+  guint32               stream;
+  const guint32        *stream_frames;
+  guint                 num_stream_frames;
   psp_return_t          ret;
 
   /* Presumably the user closed the capture file. */
@@ -2262,6 +2347,13 @@ cf_retap_packets(capture_file *cf)
 
   cf_callback_invoke(cf_cb_file_retap_started, cf);
 
+  /* If no tap listener wants the packets (e.g. the dialog that asked for
+     the retap was closed before it ran), don't read the file. */
+  if (!tap_listeners_require_dissection()) {
+    cf_callback_invoke(cf_cb_file_retap_finished, cf);
+    return CF_READ_OK;
+  }
+
   /* Get the union of the flags for all tap listeners. */
   tap_flags = union_of_tap_listener_flags();
 
@@ -2282,20 +2374,47 @@ cf_retap_packets(capture_file *cf)
   /* Reset the tap listeners. */
   reset_tap_listeners();
 
+  /* If every tap listener can collect its results for ranges of frames
+     and merge them, do so. The ranges are still dissected one after the
+     other, in frame order, on this thread; epan can't dissect frames on
+     several threads at once. */
+  callback_args.partial = tap_listeners_mergeable();
+  callback_args.range_frames = 0;
+  if (callback_args.partial)
+    begin_partial_tap_listeners();
+
   epan_dissect_init(&callback_args.edt, cf->epan, create_proto_tree, FALSE);
 
-  /* Iterate through the list of packets, dissecting all packets and
-     re-running the taps. */
-  packet_range_init(&range, cf);
-  packet_range_process_init(&range);
+  if (tap_listeners_dfilter_uint_eq(&stream_hfid, &stream) && stream_hfid != -1 &&
+      follow_stream_index_get_frames(stream_hfid, stream, &stream_frames, &num_stream_frames)) {
+    /* Every tap listener only wants the packets of one stream (e.g.
+       "Follow TCP Stream"), and we know which frames those are, so only
+       dissect them. If no frame has that stream, there's nothing to do;
+       process_records() would take a NULL list to mean every frame. */
+    if (num_stream_frames == 0)
+      ret = PSP_FINISHED;
+    else
+      ret = process_records(cf, NULL, stream_frames, num_stream_frames,
+                            "Recalculating statistics on", "the packets of the stream",
+                            TRUE, retap_packet, &callback_args, TRUE);
+  } else {
+    /* Iterate through the list of packets, dissecting all packets and
+       re-running the taps. */
+    packet_range_init(&range, cf);
+    packet_range_process_init(&range);
 
-  ret = process_specified_records(cf, &range, "Recalculating statistics on",
-                                  "all packets", TRUE, retap_packet,
-                                  &callback_args, TRUE);
+    ret = process_specified_records(cf, &range, "Recalculating statistics on",
+                                    "all packets", TRUE, retap_packet,
+                                    &callback_args, TRUE);
 
-  packet_range_cleanup(&range);
+    packet_range_cleanup(&range);
+  }
   epan_dissect_cleanup(&callback_args.edt);
 
+  /* Whether or not the retap finished, merge the frames that were tapped. */
+  if (callback_args.partial)
+    merge_partial_tap_listeners();
+
   cf_callback_invoke(cf_cb_file_retap_finished, cf);
 
   switch (ret) {
@@ -3918,6 +4037,7 @@ cf_mark_frame(capture_file *cf, frame_data *frame)
     frame->marked = TRUE;
     if (cf->count > cf->marked_count)
       cf->marked_count++;
+    cf->frames_state_gen++;
   }
 }
 
@@ -3931,6 +4051,7 @@ cf_unmark_frame(capture_file *cf, frame_data *frame)
     frame->marked = FALSE;
     if (cf->marked_count > 0)
       cf->marked_count--;
+    cf->frames_state_gen++;
   }
 }
 
@@ -3944,6 +4065,7 @@ cf_ignore_frame(capture_file *cf, frame_data *frame)
     frame->ignored = TRUE;
     if (cf->count > cf->ignored_count)
       cf->ignored_count++;
+    cf->frames_state_gen++;
   }
 }
 
@@ -3957,6 +4079,7 @@ cf_unignore_frame(capture_file *cf, frame_data *frame)
     frame->ignored = FALSE;
     if (cf->ignored_count > 0)
       cf->ignored_count--;
+    cf->frames_state_gen++;
   }
 }
 
@@ -4060,6 +4183,7 @@ cf_set_modified_block(capture_file *cf, frame_data *fd, const wtap_block_t new_b
   /* Either way, we have unsaved changes. */
   wtap_block_unref(pkt_block);
   cf->unsaved_changes = TRUE;
+  cf->frames_state_gen++;
   return TRUE;
 }
 
@@ -90,3 +90,42 @@ cap_file_provider_set_modified_block(struct packet_provider_data *prov, frame_da
 
   fd->has_modified_block = TRUE;
 }
+
+const nstime_t *
+cap_file_provider_get_time_shift(struct packet_provider_data *prov, const frame_data *fd)
+{
+  const nstime_t *shift;
+
+  if (!prov->frames_time_shifts || fd->num == 0 || fd->num > prov->frames_time_shifts->len)
+    return NULL;
+
+  shift = &g_array_index(prov->frames_time_shifts, nstime_t, fd->num - 1);
+  if (shift->secs == 0 && shift->nsecs == 0)
+    return NULL;
+  return shift;
+}
+
+void
+cap_file_provider_set_time_shift(struct packet_provider_data *prov, frame_data *fd, const nstime_t *shift)
+{
+  /*
+   * Most captures are never shifted, so the array is only allocated on
+   * the first shift; after that, time shifts usually apply to every
+   * frame, so an array is smaller than a tree of shifted frames.
+   */
+  if (shift == NULL || (shift->secs == 0 && shift->nsecs == 0)) {
+    if (prov->frames_time_shifts && fd->num != 0 && fd->num <= prov->frames_time_shifts->len)
+      nstime_set_zero(&g_array_index(prov->frames_time_shifts, nstime_t, fd->num - 1));
+    return;
+  }
+
+  if (fd->num == 0)
+    return;
+
+  if (!prov->frames_time_shifts)
+    prov->frames_time_shifts = g_array_new(FALSE, TRUE, sizeof(nstime_t));
+  if (fd->num > prov->frames_time_shifts->len)
+    g_array_set_size(prov->frames_time_shifts, fd->num);
+
+  g_array_index(prov->frames_time_shifts, nstime_t, fd->num - 1) = *shift;
+}
@@ -18,7 +18,9 @@
 #include <wsutil/ws_getopt.h>
 
 #include <wiretap/wtap.h>
+#include <wiretap/frame_index.h>
 
+#include <ui/clopts_common.h>
 #include <ui/cmdarg_err.h>
 #include <ui/exit_codes.h>
 #include <wsutil/filesystem.h>
@@ -40,6 +42,8 @@
 /* Additional exit codes */
 #define OUTPUT_FILE_ERROR 1
 
+#define LONGOPT_FRAME_INDEX LONGOPT_BASE_APPLICATION+1
+
 /* Show command-line usage */
 static void
 print_usage(FILE *output)
@@ -49,6 +53,9 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
     fprintf(output, "  -n        don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  --frame-index\n");
+    fprintf(output, "            use the input file's frame index, if it's up to date,\n");
+    fprintf(output, "            instead of reading the file twice; if it isn't, write one.\n");
     fprintf(output, "  -h        display this help and exit.\n");
     fprintf(output, "  -v        print version information and exit.\n");
 }
@@ -184,14 +191,18 @@ main(int argc, char *argv[])
     guint i;
     wtap_dump_params params;
     int                          ret = EXIT_SUCCESS;
+    gboolean use_frame_index = FALSE;
+    wtap_frame_index_t *frame_index = NULL;
 
     GPtrArray *frames;
+    FrameRecord_t *newFrameRecord;
     FrameRecord_t *prevFrame = NULL;
 
     int opt;
     static const struct ws_option long_options[] = {
         {"help", ws_no_argument, NULL, 'h'},
         {"version", ws_no_argument, NULL, 'v'},
+        {"frame-index", ws_no_argument, NULL, LONGOPT_FRAME_INDEX},
         {0, 0, 0, 0 }
     };
     int file_count;
@@ -236,6 +247,9 @@ main(int argc, char *argv[])
             case 'n':
                 write_output_regardless = FALSE;
                 break;
+            case LONGOPT_FRAME_INDEX:
+                use_frame_index = TRUE;
+                break;
             case 'h':
                 show_help_header("Reorder timestamps of input file frames into output file.");
                 print_usage(stdout);
@@ -297,34 +311,81 @@ main(int argc, char *argv[])
     /* Allocate the array of frame pointers. */
     frames = g_ptr_array_new();
 
-    /* Read each frame from infile */
-    wtap_rec_init(&rec);
-    ws_buffer_init(&buf, 1514);
-    while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
-        FrameRecord_t *newFrameRecord;
-
-        newFrameRecord = g_slice_new(FrameRecord_t);
-        newFrameRecord->num = frames->len + 1;
-        newFrameRecord->offset = data_offset;
-        if (rec.presence_flags & WTAP_HAS_TS) {
-            newFrameRecord->frame_time = rec.ts;
-        } else {
-            nstime_set_unset(&newFrameRecord->frame_time);
-        }
+    if (use_frame_index) {
+        frame_index = wtap_frame_index_load(wth, infile);
+    }
 
-        if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
-           wrong_order_count++;
+    if (frame_index != NULL) {
+        /* We know where every frame is; no need to read them twice. */
+        for (i = 0; i < wtap_frame_index_count(frame_index); i++) {
+            const wtap_frame_index_entry_t *entry = wtap_frame_index_get(frame_index, i);
+
+            newFrameRecord = g_slice_new(FrameRecord_t);
+            newFrameRecord->num = frames->len + 1;
+            newFrameRecord->offset = entry->offset;
+            if (entry->presence_flags & WTAP_HAS_TS) {
+                newFrameRecord->frame_time = entry->ts;
+            } else {
+                nstime_set_unset(&newFrameRecord->frame_time);
+            }
+
+            if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
+               wrong_order_count++;
+            }
+
+            g_ptr_array_add(frames, newFrameRecord);
+            prevFrame = newFrameRecord;
+        }
+        wtap_frame_index_free(frame_index);
+    } else {
+        if (use_frame_index) {
+            /* Not being able to write the index isn't fatal. */
+            frame_index = wtap_frame_index_new(infile, &err);
+            if (frame_index == NULL) {
+                fprintf(stderr, "reordercap: Can't create frame index for \"%s\": %s.\n",
+                        infile, g_strerror(err));
+            }
         }
 
-        g_ptr_array_add(frames, newFrameRecord);
-        prevFrame = newFrameRecord;
-        wtap_rec_reset(&rec);
-    }
-    wtap_rec_cleanup(&rec);
-    ws_buffer_free(&buf);
-    if (err != 0) {
-      /* Print a message noting that the read failed somewhere along the line. */
-      cfile_read_failure_message(infile, err, err_info);
+        /* Read each frame from infile */
+        wtap_rec_init(&rec);
+        ws_buffer_init(&buf, 1514);
+        while (wtap_read(wth, &rec, &buf, &err, &err_info, &data_offset)) {
+            newFrameRecord = g_slice_new(FrameRecord_t);
+            newFrameRecord->num = frames->len + 1;
+            newFrameRecord->offset = data_offset;
+            if (rec.presence_flags & WTAP_HAS_TS) {
+                newFrameRecord->frame_time = rec.ts;
+            } else {
+                nstime_set_unset(&newFrameRecord->frame_time);
+            }
+
+            if (prevFrame && frames_compare(&newFrameRecord, &prevFrame) < 0) {
+               wrong_order_count++;
+            }
+
+            if (frame_index != NULL) {
+                wtap_frame_index_add(frame_index, &rec, data_offset);
+            }
+
+            g_ptr_array_add(frames, newFrameRecord);
+            prevFrame = newFrameRecord;
+            wtap_rec_reset(&rec);
+        }
+        wtap_rec_cleanup(&rec);
+        ws_buffer_free(&buf);
+        if (err != 0) {
+          /* Print a message noting that the read failed somewhere along the line. */
+          cfile_read_failure_message(infile, err, err_info);
+        } else if (frame_index != NULL) {
+            if (!wtap_frame_index_save(frame_index, wth, infile, &err)) {
+                char *index_filename = wtap_frame_index_filename(infile);
+                fprintf(stderr, "reordercap: Can't write frame index \"%s\": %s.\n",
+                        index_filename, g_strerror(err));
+                g_free(index_filename);
+            }
+        }
+        wtap_frame_index_free(frame_index);
     }
 
     printf("%u frames, %u out of order\n", frames->len, wrong_order_count);
@@ -50,6 +50,7 @@
 #include "ui/failure_message.h"
 #include "wtap.h"
 #include <epan/epan_dissect.h>
+#include <epan/follow.h>
 #include <epan/tap.h>
 #include <epan/uat-int.h>
 #include <epan/secrets.h>
@@ -485,9 +486,16 @@ sharkd_cmdarg_err_cont(const char *msg_format, va_list ap)
   fprintf(stderr, "\n");
 }
 
+/*
+ * TRUE while cfile holds the file read by sharkd_preload_cap_file() and
+ * no "load" has used it yet.
+ */
+static gboolean cap_file_preloaded = FALSE;
+
 cf_status_t
 sharkd_cf_open(const char *fname, unsigned int type, gboolean is_tempfile, int *err)
 {
+  cap_file_preloaded = FALSE;
   return cf_open(&cfile, fname, type, is_tempfile, err);
 }
 
@@ -497,6 +505,71 @@ sharkd_load_cap_file(void)
   return load_cap_file(&cfile, 0, 0);
 }
 
+/*
+ * Returns TRUE, once, if fname is the file the daemon preloaded, so that
+ * the first "load" of it doesn't read it again. Any later "load" reads
+ * the file again, as it may have changed, or preferences may have.
+ */
+gboolean
+sharkd_use_preloaded_cap_file(const char *fname)
+{
+  if (!cap_file_preloaded || cfile.filename == NULL || strcmp(cfile.filename, fname) != 0)
+    return FALSE;
+
+  cap_file_preloaded = FALSE;
+  return TRUE;
+}
+
+/*
+ * Forget that cfile was preloaded, e.g. because preferences changed and
+ * its dissection is out of date.
+ */
+void
+sharkd_forget_preloaded_cap_file(void)
+{
+  cap_file_preloaded = FALSE;
+}
+
+/*
+ * Open and read a capture file before any session starts, so that the
+ * session processes forked by the daemon inherit its frames and first
+ * pass state instead of each reading it again.
+ */
+int
+sharkd_preload_cap_file(const char *fname)
+{
+  int err = 0;
+
+  if (sharkd_cf_open(fname, WTAP_TYPE_AUTO, FALSE, &err) != CF_OK)
+    return err != 0 ? err : -1;
+
+  err = sharkd_load_cap_file();
+  cap_file_preloaded = (err == 0);
+  return err;
+}
+
+/*
+ * In a forked session process, give the preloaded capture file its own
+ * random access descriptor; one inherited across fork() shares its file
+ * position with the other sessions.
+ */
+int
+sharkd_reopen_cap_file(void)
+{
+  int err = 0;
+
+  if (!cap_file_preloaded || cfile.provider.wth == NULL)
+    return 0;
+
+  /* Close the inherited descriptor(s) first, so they aren't leaked. */
+  wtap_fdclose(cfile.provider.wth);
+  if (!wtap_fdreopen(cfile.provider.wth, cfile.filename, &err)) {
+    cap_file_preloaded = FALSE;
+    return err;
+  }
+  return 0;
+}
+
 frame_data *
 sharkd_get_frame(guint32 framenum)
 {
@@ -572,6 +645,12 @@ sharkd_retap(void)
   int err;
   char *err_info = NULL;
 
+  int              stream_hfid;
+  guint32          stream;
+  const guint32   *stream_frames = NULL;
+  guint            num_frames;
+  guint            i;
+
   guint         tap_flags;
   gboolean      create_proto_tree;
   epan_dissect_t edt;
@@ -600,7 +679,17 @@ sharkd_retap(void)
 
   reset_tap_listeners();
 
-  for (framenum = 1; framenum <= cfile.count; framenum++) {
+  /* If all tap listeners only want the packets of one stream (e.g. "follow"),
+   * only dissect the frames recorded for that stream. */
+  if (!(tap_listeners_dfilter_uint_eq(&stream_hfid, &stream) && stream_hfid != -1 &&
+        follow_stream_index_get_frames(stream_hfid, stream, &stream_frames, &num_frames)))
+  {
+    stream_frames = NULL;
+    num_frames = cfile.count;
+  }
+
+  for (i = 0; i < num_frames; i++) {
+    framenum = stream_frames ? stream_frames[i] : i + 1;
     fdata = sharkd_get_frame(framenum);
 
     if (!wtap_seek_read(cfile.provider.wth, fdata->file_off, &rec, &buf, &err, &err_info))
@@ -756,6 +845,7 @@ int
 sharkd_set_modified_block(frame_data *fd, wtap_block_t new_block)
 {
   cap_file_provider_set_modified_block(&cfile.provider, fd, new_block);
+  cfile.frames_state_gen++;
   return 0;
 }
 
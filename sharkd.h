@@ -31,6 +31,10 @@ typedef void (*sharkd_dissect_func_t)(epan_dissect_t *edt, proto_tree *tree, str
 /* sharkd.c */
 cf_status_t sharkd_cf_open(const char *fname, unsigned int type, gboolean is_tempfile, int *err);
 int sharkd_load_cap_file(void);
+gboolean sharkd_use_preloaded_cap_file(const char *fname);
+void sharkd_forget_preloaded_cap_file(void);
+int sharkd_preload_cap_file(const char *fname);
+int sharkd_reopen_cap_file(void);
 int sharkd_retap(void);
 int sharkd_filter(const char *dftext, guint8 **result);
 frame_data *sharkd_get_frame(guint32 framenum);
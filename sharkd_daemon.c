@@ -52,6 +52,7 @@
 
 static int mode = 0;
 static socket_handle_t _server_fd = INVALID_SOCKET;
+static const char *preload_file = NULL;
 
 static socket_handle_t
 socket_init(char *path)
@@ -183,11 +184,15 @@ print_usage(FILE* output)
 	fprintf(output, "  -v, --version            show version information\n");
 	fprintf(output, "  -C <config profile>, --config-profile <config profile>\n");
 	fprintf(output, "                           start with specified configuration profile\n");
+	fprintf(output, "  -l <file>, --preload <file>\n");
+	fprintf(output, "                           read this capture file before accepting sessions;\n");
+	fprintf(output, "                           sessions that load it get it without reading it again\n");
 
 	fprintf(output, "\n");
 	fprintf(output, "  Examples:\n");
 	fprintf(output, "    sharkd -C myprofile\n");
 	fprintf(output, "    sharkd -a tcp:127.0.0.1:4446 -C myprofile\n");
+	fprintf(output, "    sharkd -a unix:/tmp/sharkd.sock -l /data/big.pcapng\n");
 
 	fprintf(output, "\n");
 	fprintf(output, "See the sharkd page of the Wireshark wiki for full details.\n");
@@ -217,7 +222,7 @@ sharkd_init(int argc, char **argv)
 	 * platform-dependent.
 	 */
 
-#define OPTSTRING "+" "a:hmvC:"
+#define OPTSTRING "+" "a:hmvC:l:"
 
 	static const char    optstring[] = OPTSTRING;
 
@@ -227,6 +232,7 @@ sharkd_init(int argc, char **argv)
 	  {"help", ws_no_argument, NULL, 'h'},
 	  {"version", ws_no_argument, NULL, 'v'},
 	  {"config-profile", ws_required_argument, NULL, 'C'},
+	  {"preload", ws_required_argument, NULL, 'l'},
 	  {0, 0, 0, 0 }
 	};
 
@@ -316,6 +322,10 @@ sharkd_init(int argc, char **argv)
 				exit(0);
 				break;
 
+			case 'l':
+				preload_file = ws_optarg;
+				break;
+
 			case 'm':
 				// m is an internal-only option used when the daemon session process is created
 				mode = SHARKD_MODE_GOLD_CONSOLE;
@@ -362,6 +372,26 @@ sharkd_loop(int argc _U_, char* argv[] _U_)
 sharkd_loop(int argc _U_, char* argv[])
 #endif
 {
+	/*
+	 * Read the preloaded file once, here; on UN*X the forked session
+	 * processes share its pages copy-on-write. On Windows each session
+	 * process is started with the same options and reads it itself.
+	 */
+#ifdef _WIN32
+	if (preload_file && (mode == SHARKD_MODE_CLASSIC_CONSOLE || mode == SHARKD_MODE_GOLD_CONSOLE))
+#else
+	if (preload_file)
+#endif
+	{
+		int err = sharkd_preload_cap_file(preload_file);
+
+		if (err != 0)
+		{
+			fprintf(stderr, "cannot preload %s\n", preload_file);
+			return -1;
+		}
+	}
+
 	if (mode == SHARKD_MODE_CLASSIC_CONSOLE || mode == SHARKD_MODE_GOLD_CONSOLE)
 	{
 		return sharkd_session_main(mode);
@@ -397,6 +427,9 @@ sharkd_loop(int argc _U_, char* argv[])
 			dup2(fd, 1);
 			close(fd);
 
+			if (sharkd_reopen_cap_file() != 0)
+				fprintf(stderr, "cannot reopen preloaded capture file, it will be read again\n");
+
 			exit(sharkd_session_main(mode));
 		}
 
@@ -82,6 +82,9 @@ struct sharkd_filter_item
 
 static GHashTable *filter_table = NULL;
 
+/* I/O graphs already computed, so that other intervals can be derived. */
+static io_graph_cache_t *iograph_cache = NULL;
+
 static int mode;
 static guint32 rpcid;
 
@@ -400,6 +403,7 @@ json_prep(char* buf, const jsmntok_t* tokens, int count)
 		{"frames",     "column*",    2, JSMN_UNDEFINED,    SHARKD_JSON_ANY,      OPTIONAL},
 		{"frames",     "filter",     2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
 		{"frames",     "skip",       2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, OPTIONAL},
+		{"frames",     "after",      2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, OPTIONAL},
 		{"frames",     "limit",      2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, OPTIONAL},
 		{"frames",     "refs",       2, JSMN_STRING,       SHARKD_JSON_STRING,   OPTIONAL},
 		{"intervals",  "interval",   2, JSMN_PRIMITIVE,    SHARKD_JSON_UINTEGER, OPTIONAL},
@@ -1065,6 +1069,13 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 	fprintf(stderr, "load: filename=%s\n", tok_file);
 
+	/* Preloaded by the daemon before this session was forked. */
+	if (sharkd_use_preloaded_cap_file(tok_file))
+	{
+		sharkd_json_simple_ok(rpcid);
+		return;
+	}
+
 	if (sharkd_cf_open(tok_file, WTAP_TYPE_AUTO, FALSE, &err) != CF_OK)
 	{
 		sharkd_json_error(
@@ -1074,6 +1085,8 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 		return;
 	}
 
+	io_graph_cache_clear(iograph_cache);
+
 	TRY
 	{
 		err = sharkd_load_cap_file();
@@ -1381,6 +1394,9 @@ sharkd_session_process_frames_cb(epan_dissect_t *edt, proto_tree *tree _U_,
  *                            If column0 is not specified default column set will be used.
  *   (o) filter - filter to be used
  *   (o) skip=N   - skip N frames
+ *   (o) after=N  - start after frame number N; to page through the frames, pass
+ *                  the num of the last frame returned with the same filter and limit.
+ *                  Unlike skip, this doesn't have to scan the frames before it.
  *   (o) limit=N  - show only N frames
  *   (o) refs  - list (comma separated) with sorted time reference frame numbers.
  *
@@ -1399,6 +1415,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 	const char *tok_filter = json_find_attr(buf, tokens, count, "filter");
 	const char *tok_column = json_find_attr(buf, tokens, count, "column0");
 	const char *tok_skip   = json_find_attr(buf, tokens, count, "skip");
+	const char *tok_after  = json_find_attr(buf, tokens, count, "after");
 	const char *tok_limit  = json_find_attr(buf, tokens, count, "limit");
 	const char *tok_refs   = json_find_attr(buf, tokens, count, "refs");
 
@@ -1406,6 +1423,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 
 	guint32 next_ref_frame = G_MAXUINT32;
 	guint32 skip;
+	guint32 after;
 	guint32 limit;
 
 	wtap_rec rec; /* Record metadata */
@@ -1451,6 +1469,13 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 			return;
 	}
 
+	after = 0;
+	if (tok_after)
+	{
+		if (!ws_strtou32(tok_after, NULL, &after))
+			return;
+	}
+
 	limit = 0;
 	if (tok_limit)
 	{
@@ -1469,7 +1494,7 @@ sharkd_session_process_frames(const char *buf, const jsmntok_t *tokens, int coun
 	wtap_rec_init(&rec);
 	ws_buffer_init(&rec_buf, 1514);
 
-	for (guint32 framenum = 1; framenum <= cfile.count; framenum++)
+	for (guint32 framenum = after + 1; framenum > after && framenum <= cfile.count; framenum++)
 	{
 		frame_data *fdata;
 		enum dissect_request_status status;
@@ -3585,11 +3610,15 @@ struct sharkd_iograph
 	int hf_index;
 	io_graph_item_unit_t calc_type;
 	guint32 interval;
+	const char *filter;
+	const char *field_name;
 
 	/* result */
 	int space_items;
 	int num_items;
 	io_graph_item_t *items;
+	gboolean tapped;
+	gboolean truncated;
 	GString *error;
 };
 
@@ -3602,7 +3631,10 @@ sharkd_iograph_packet(void *g, packet_info *pinfo, epan_dissect_t *edt, const vo
 
 	idx = get_io_graph_index(pinfo, graph->interval);
 	if (idx < 0 || idx >= SHARKD_IOGRAPH_MAX_ITEMS)
+	{
+		graph->truncated = TRUE;
 		return TAP_PACKET_DONT_REDRAW;
+	}
 
 	if (idx + 1 > graph->num_items)
 	{
@@ -3708,6 +3740,8 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 			field_name = field_name + 1;
 
 		graph->interval = interval_ms;
+		graph->filter = tok_filter;
+		graph->field_name = field_name;
 
 		graph->hf_index = -1;
 		graph->error = check_field_unit(field_name, &graph->hf_index, graph->calc_type);
@@ -3715,9 +3749,24 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 		graph->space_items = 0; /* TODO, can avoid realloc()s in sharkd_iograph_packet() by calculating: capture_time / interval */
 		graph->num_items = 0;
 		graph->items = NULL;
+		graph->tapped = FALSE;
+		graph->truncated = FALSE;
 
+		/* If this graph was already computed at this interval or at one
+		 * dividing it, we don't have to tap for it. */
 		if (!graph->error)
+		{
+			/* sharkd reports intervals, not times, so it has no use for the origin. */
+			double start_time;
+
+			graph->items = io_graph_cache_lookup(iograph_cache, &cfile, tok_filter, field_name, graph->calc_type, interval_ms, &graph->num_items, &start_time);
+		}
+
+		if (!graph->error && !graph->items)
+		{
 			graph->error = register_tap_listener("frame", graph, tok_filter, TL_REQUIRES_PROTO_TREE, NULL, sharkd_iograph_packet, NULL, NULL);
+			graph->tapped = TRUE;
+		}
 
 		graph_count++;
 
@@ -3731,7 +3780,7 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 			return;
 		}
 
-		if (graph->error == NULL)
+		if (graph->error == NULL && graph->tapped)
 			is_any_ok = TRUE;
 	}
 
@@ -3739,6 +3788,15 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 	if (is_any_ok)
 		sharkd_retap();
 
+	for (i = 0; i < graph_count; i++)
+	{
+		struct sharkd_iograph *graph = &graphs[i];
+
+		if (graph->tapped && !graph->truncated)
+			io_graph_cache_store(iograph_cache, &cfile, graph->filter, graph->field_name, graph->calc_type,
+			                     graph->hf_index, graph->interval, graph->items, graph->num_items, 0.0);
+	}
+
 	sharkd_json_result_prologue(rpcid);
 
 	sharkd_json_array_open("iograph");
@@ -3781,7 +3839,8 @@ sharkd_session_process_iograph(char *buf, const jsmntok_t *tokens, int count)
 		}
 		json_dumper_end_object(&dumper);
 
-		remove_tap_listener(graph);
+		if (graph->tapped)
+			remove_tap_listener(graph);
 		g_free(graph->items);
 	}
 	sharkd_json_array_close();
@@ -4394,6 +4453,9 @@ sharkd_session_process_setconf(char *buf, const jsmntok_t *tokens, int count)
 	switch (ret)
 	{
 	case PREFS_SET_OK:
+		/* The preference might change how packets are dissected. */
+		io_graph_cache_clear(iograph_cache);
+		sharkd_forget_preloaded_cap_file();
 		sharkd_json_simple_ok(rpcid);
 		break;
 
@@ -5033,6 +5095,7 @@ sharkd_session_main(int mode_setting)
 	dumper.output_file = stdout;
 
 	filter_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, sharkd_session_filter_free);
+	iograph_cache = io_graph_cache_new();
 
 #ifdef HAVE_MAXMINDDB
 	/* mmdbresolve was stopped before fork(), force starting it */
@@ -5081,6 +5144,7 @@ sharkd_session_main(int mode_setting)
 	}
 
 	g_hash_table_destroy(filter_table);
+	io_graph_cache_free(iograph_cache);
 	g_free(tokens);
 
 	return 0;
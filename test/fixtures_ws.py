@@ -131,6 +131,11 @@ def cmd_editcap(program):
     return program('editcap')
 
 
+@fixtures.fixture(scope='session')
+def cmd_reordercap(program):
+    return program('reordercap')
+
+
 @fixtures.fixture(scope='session')
 def cmd_wireshark(program):
     return program('wireshark')
@@ -15,6 +15,8 @@ import subprocess
 import subprocesstest
 import fixtures
 import shutil
+import socket
+import struct
 
 #glossaries = ('fields', 'protocols', 'values', 'decodes', 'defaultprefs', 'currentprefs')
 
@@ -44,6 +46,26 @@ class case_dumpcap_options(subprocesstest.SubprocessTestCase):
             process = self.runProcess((cmd_dumpcap, '-' + char_arg), env=base_env)
             self.assertIn(process.returncode, valid_returns)
 
+    def test_dumpcap_fanout_usage(self, cmd_dumpcap, base_env):
+        '''--fanout is listed only where it is supported'''
+        process = self.assertRun((cmd_dumpcap, '-h'), env=base_env)
+        if sys.platform.startswith('linux'):
+            self.assertIn('--fanout', process.stdout_str)
+        else:
+            self.assertNotIn('--fanout', process.stdout_str)
+
+    def test_dumpcap_fanout_invalid(self, cmd_dumpcap, base_env):
+        '''Invalid --fanout thread counts'''
+        if not sys.platform.startswith('linux'):
+            self.assertRun((cmd_dumpcap, '--fanout', '2'), env=base_env,
+                           expected_return=self.exit_command_line)
+            self.assertTrue(self.grepOutput('--fanout is only supported on Linux'))
+            return
+        for count in ('0', '-2', 'two'):
+            self.assertRun((cmd_dumpcap, '--fanout', count), env=base_env,
+                           expected_return=self.exit_command_line)
+            self.assertTrue(self.grepOutput('fanout thread count'))
+
 
 @fixtures.mark_usefixtures('base_env')
 @fixtures.uses_fixtures
@@ -285,6 +307,113 @@ class case_tshark_z_expert(subprocesstest.SubprocessTestCase):
         self.assertFalse(self.grepOutput('Chats'))
 
 
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_tshark_lazy_dissection(subprocesstest.SubprocessTestCase):
+    def check_same_fields(self, cmd_tshark, capture_file, cap_name, *args):
+        '''--lazy-dissection must not change the fields that are printed'''
+        full_proc = self.assertRun((cmd_tshark, '-r', capture_file(cap_name), '-T', 'fields') + args)
+        lazy_proc = self.assertRun((cmd_tshark, '-r', capture_file(cap_name), '-T', 'fields', '--lazy-dissection') + args)
+        self.assertNotIn('dissecting everything', lazy_proc.stderr_str)
+        self.assertTrue(full_proc.stdout_str.strip())
+        self.assertEqual(full_proc.stdout_str, lazy_proc.stdout_str)
+
+    def test_tshark_lazy_dissection_dns(self, cmd_tshark, capture_file):
+        self.check_same_fields(cmd_tshark, capture_file, 'dns+icmp.pcapng.gz',
+            '-Y', 'dns', '-e', 'frame.number', '-e', 'dns.qry.name', '-e', 'dns.a')
+
+    def test_tshark_lazy_dissection_http(self, cmd_tshark, capture_file):
+        self.check_same_fields(cmd_tshark, capture_file, 'http.pcap',
+            '-e', 'frame.number', '-e', 'tcp.stream', '-e', 'http.request.uri', '-e', 'http.response.code')
+
+    def test_tshark_lazy_dissection_read_filter(self, cmd_tshark, capture_file):
+        self.check_same_fields(cmd_tshark, capture_file, 'sip.pcapng',
+            '-2', '-R', 'sip.Method', '-e', 'frame.number', '-e', 'sip.Call-ID')
+
+    def test_tshark_lazy_dissection_gre(self, cmd_tshark, cmd_text2pcap):
+        '''Tunnels found in tables that don't support Decode As are kept'''
+        # IPv4 / GRE / IPv4 / UDP
+        testin_file = self.filename_from_id('testin.txt')
+        testout_file = self.filename_from_id(testout_pcap)
+        with open(testin_file, 'w') as f:
+            f.write('0000  45 00 00 34 00 01 00 00 40 2f 66 98 0a 00 00 01\n'
+                    '0010  0a 00 00 02 00 00 08 00 45 00 00 1c 00 02 00 00\n'
+                    '0020  40 11 f9 7b c0 a8 00 01 c0 a8 00 02 9c 40 9c 41\n'
+                    '0030  00 08 00 00\n')
+        self.assertRun((cmd_text2pcap, '-l228', testin_file, testout_file))
+        lazy_proc = self.assertRun((cmd_tshark, '-r', testout_file, '-T', 'fields', '--lazy-dissection', '-e', 'ip.src'))
+        self.assertNotIn('dissecting everything', lazy_proc.stderr_str)
+        self.assertEqual(lazy_proc.stdout_str.strip(), '10.0.0.1,192.168.0.1')
+
+    def write_udp_packets(self, cmd_text2pcap, packets):
+        '''Write (src, sport, dst, dport, payload) tuples as raw IPv4 packets'''
+        def ip_checksum(header):
+            total = sum(int.from_bytes(header[i:i + 2], 'big') for i in range(0, len(header), 2))
+            while total > 0xffff:
+                total = (total & 0xffff) + (total >> 16)
+            return ~total & 0xffff
+
+        testin_file = self.filename_from_id('testin.txt')
+        testout_file = self.filename_from_id(testout_pcap)
+        with open(testin_file, 'w') as f:
+            for ident, (src, sport, dst, dport, payload) in enumerate(packets, 1):
+                udp = struct.pack('!HHHH', sport, dport, 8 + len(payload), 0) + payload
+                ip = bytearray(struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(udp), ident, 0, 64, 17, 0,
+                    socket.inet_aton(src), socket.inet_aton(dst)))
+                struct.pack_into('!H', ip, 10, ip_checksum(ip))
+                pkt = bytes(ip) + udp
+                for offset in range(0, len(pkt), 16):
+                    f.write('{:04x}  {}\n'.format(offset, pkt[offset:offset + 16].hex(' ')))
+        self.assertRun((cmd_text2pcap, '-l228', testin_file, testout_file))
+        return testout_file
+
+    def test_tshark_lazy_dissection_rtp(self, cmd_tshark, cmd_text2pcap):
+        '''RTP set up by skipped SIP and SDP is still found'''
+        def sip(first_line, to, contact, rtp_addr, rtp_port):
+            sdp = ('v=0\r\n'
+                   'o=- 1 1 IN IP4 {0}\r\n'
+                   's=-\r\n'
+                   'c=IN IP4 {0}\r\n'
+                   't=0 0\r\n'
+                   'm=audio {1} RTP/AVP 0\r\n').format(rtp_addr, rtp_port)
+            return ('{}\r\n'
+                    'Via: SIP/2.0/UDP 10.0.0.1:5060;branch=z9hG4bK-lazy-1\r\n'
+                    'From: <sip:alice@10.0.0.1>;tag=1\r\n'
+                    'To: {}\r\n'
+                    'Call-ID: lazy-rtp@10.0.0.1\r\n'
+                    'CSeq: 1 INVITE\r\n'
+                    'Contact: {}\r\n'
+                    'Content-Type: application/sdp\r\n'
+                    'Content-Length: {}\r\n'
+                    '\r\n{}').format(first_line, to, contact, len(sdp), sdp).encode()
+
+        def rtp(seq, ssrc):
+            # Version 2, PCMU, 20 bytes of silence
+            return struct.pack('!BBHII', 0x80, 0, seq, seq * 160, ssrc) + b'\xff' * 20
+
+        testout_file = self.write_udp_packets(cmd_text2pcap, (
+            ('10.0.0.1', 5060, '10.0.0.2', 5060, sip('INVITE sip:bob@10.0.0.2 SIP/2.0',
+                '<sip:bob@10.0.0.2>', '<sip:alice@10.0.0.1:5060>', '10.0.0.1', 40000)),
+            ('10.0.0.2', 5060, '10.0.0.1', 5060, sip('SIP/2.0 200 OK',
+                '<sip:bob@10.0.0.2>;tag=2', '<sip:bob@10.0.0.2:5060>', '10.0.0.2', 40002)),
+            ('10.0.0.1', 40000, '10.0.0.2', 40002, rtp(1, 0x11223344)),
+            ('10.0.0.2', 40002, '10.0.0.1', 40000, rtp(1, 0x55667788)),
+            ('10.0.0.1', 40000, '10.0.0.2', 40002, rtp(2, 0x11223344)),
+        ))
+        fields = ('-T', 'fields', '-e', 'frame.number', '-e', 'rtp.ssrc', '-e', 'rtp.seq')
+        full_proc = self.assertRun((cmd_tshark, '-r', testout_file) + fields)
+        lazy_proc = self.assertRun((cmd_tshark, '-r', testout_file, '--lazy-dissection') + fields)
+        self.assertNotIn('dissecting everything', lazy_proc.stderr_str)
+        self.assertIn('0x11223344', full_proc.stdout_str)
+        self.assertIn('0x55667788', full_proc.stdout_str)
+        self.assertEqual(full_proc.stdout_str, lazy_proc.stdout_str)
+
+    def test_tshark_lazy_dissection_columns(self, cmd_tshark, capture_file):
+        '''Column output needs everything, so nothing is skipped'''
+        self.assertRun((cmd_tshark, '-r', capture_file('http.pcap'), '--lazy-dissection'))
+        self.assertTrue(self.grepOutput('dissecting everything'))
+
+
 @fixtures.mark_usefixtures('test_env')
 @fixtures.uses_fixtures
 class case_tshark_extcap(subprocesstest.SubprocessTestCase):
@@ -29,10 +29,13 @@ def cmd_dftest(program):
 def checkDFilterCount(dfilter_cmd, base_env):
     def checkDFilterCount_real(dfilter, expected_count):
         """Run a display filter and expect a certain number of packets."""
+        # Have TShark abort if the threaded backend and the interpreter
+        # disagree on any packet.
+        env = dict(base_env, WIRESHARK_DFILTER_CHECK_BACKENDS='1')
         output = subprocess.check_output(dfilter_cmd(dfilter),
                                          universal_newlines=True,
                                          stderr=subprocess.STDOUT,
-                                         env=base_env)
+                                         env=env)
 
         dfp_count = output.count("\n")
         msg = "Expected %d, got: %s\noutput: %r" % \
@@ -75,3 +78,18 @@ def checkDFilterSucceed(cmd_dftest, base_env):
             assert expect_stdout in outs, \
                 'Expected the string %s in the output' % expect_stdout
     return checkDFilterSucceed_real
+
+@fixtures.fixture
+def checkDFilterBackends(cmd_dftest, base_env):
+    def checkDFilterBackends_real(dfilter):
+        """Run a display filter with both dftest backends and expect them to agree."""
+        proc = subprocess.Popen([cmd_dftest, '-b', '1', dfilter],
+                                stdout=subprocess.PIPE,
+                                stderr=subprocess.PIPE,
+                                universal_newlines=True,
+                                env=base_env)
+        outs, errs = proc.communicate()
+        assert proc.returncode == 0, \
+            'Unexpected dftest exit code: %d. stderr:\n%s\n' % \
+            (proc.returncode, errs)
+    return checkDFilterBackends_real
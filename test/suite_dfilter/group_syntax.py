@@ -90,3 +90,11 @@ class case_syntax(unittest.TestCase):
     def test_deprecated_3(self, checkDFilterSucceed):
         dfilter = "ip.version in {4 6}"
         checkDFilterSucceed(dfilter, "Use ',' to separate set elements")
+
+    def test_backends_1(self, checkDFilterBackends):
+        dfilter = "ip.src == 0.0.0.0 && eth.dst == 00:00:00:00:00:00"
+        checkDFilterBackends(dfilter)
+
+    def test_backends_2(self, checkDFilterBackends):
+        dfilter = "tcp.port != 0 || frame.len >= 1 || data.data == 00:00"
+        checkDFilterBackends(dfilter)
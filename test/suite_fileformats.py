@@ -9,6 +9,7 @@
 '''File format conversion tests'''
 
 import os.path
+import struct
 import subprocesstest
 import unittest
 import fixtures
@@ -249,3 +250,140 @@ class case_fileformat_mime(subprocesstest.SubprocessTestCase):
                 '-e', 'pcapng.block.length_trailer',
             ))
         self.assertEqual(proc.stdout_str.strip(), '480\t128,88,132,132\t128,88,132,132')
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_editcap_dedup(subprocesstest.SubprocessTestCase):
+    packet_a = bytes(range(60))
+    packet_x = bytes(range(60, 0, -1))
+
+    def write_pcap(self, filename, packets):
+        '''Write (seconds, microseconds, data) tuples to a pcap file.'''
+        with open(filename, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+            for secs, usecs, data in packets:
+                f.write(struct.pack('<IIII', secs, usecs, len(data), len(data)))
+                f.write(data)
+
+    def run_dedup(self, cmd_editcap, packets, *args):
+        infile = self.filename_from_id('dedup-in.pcap')
+        outfile = self.filename_from_id('dedup-out.pcap')
+        self.write_pcap(infile, packets)
+        self.assertRun((cmd_editcap,) + args + (infile, outfile))
+        return outfile
+
+    def test_dedup_window(self, cmd_editcap):
+        '''-D finds a duplicate anywhere in the window'''
+        a, x = self.packet_a, self.packet_x
+        # The window includes the current frame.
+        outfile = self.run_dedup(cmd_editcap, ((1, 0, a), (2, 0, x), (3, 0, x), (4, 0, a)), '-D', '4')
+        self.checkPacketCount(2, cap_file=outfile)
+        outfile = self.run_dedup(cmd_editcap, ((1, 0, a), (2, 0, x), (3, 0, x), (4, 0, a)), '-D', '3')
+        self.checkPacketCount(3, cap_file=outfile)
+
+    def test_dedup_time_window(self, cmd_editcap):
+        '''-w drops a copy that is within the time window'''
+        a, x = self.packet_a, self.packet_x
+        outfile = self.run_dedup(cmd_editcap, ((10, 0, a), (10, 200000, x), (10, 500000, a)), '-w', '1')
+        self.checkPacketCount(2, cap_file=outfile)
+        outfile = self.run_dedup(cmd_editcap, ((10, 0, a), (10, 200000, x), (12, 0, a)), '-w', '1')
+        self.checkPacketCount(3, cap_file=outfile)
+
+    def test_dedup_time_window_out_of_order(self, cmd_editcap):
+        '''-w stops looking back at the first frame beyond the time window'''
+        a, x = self.packet_a, self.packet_x
+        # The older copy is within the window, but a frame between them
+        # isn't, so it's not seen.
+        outfile = self.run_dedup(cmd_editcap, ((10, 0, a), (0, 0, x), (10, 500000, a)), '-w', '1')
+        self.checkPacketCount(3, cap_file=outfile)
+        # Frames newer than the current one are skipped.
+        outfile = self.run_dedup(cmd_editcap, ((10, 0, a), (20, 0, x), (10, 500000, a)), '-w', '1')
+        self.checkPacketCount(2, cap_file=outfile)
+
+
+@fixtures.mark_usefixtures('test_env')
+@fixtures.uses_fixtures
+class case_reordercap_frame_index(subprocesstest.SubprocessTestCase):
+    # (seconds, microseconds) of each frame; two of them are out of order.
+    frame_times = ((3, 0), (1, 0), (2, 0), (2, 500000), (1, 500000))
+
+    def setUp(self):
+        super().setUp()
+        self.infile = self.filename_from_id('reorder-in.pcap')
+        self.index_file = self.infile + '.frameindex'
+        with open(self.infile, 'wb') as f:
+            f.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+            for n, (secs, usecs) in enumerate(self.frame_times):
+                data = bytes((n,)) * 60
+                f.write(struct.pack('<IIII', secs, usecs, len(data), len(data)))
+                f.write(data)
+
+    def reorder(self, cmd_reordercap, outname, *args):
+        outfile = self.filename_from_id(outname)
+        proc = self.assertRun((cmd_reordercap,) + args + (self.infile, outfile))
+        self.assertEqual(proc.stdout_str.strip(), '5 frames, 2 out of order')
+        with open(outfile, 'rb') as f:
+            return f.read()
+
+    def read_index(self):
+        with open(self.index_file, 'rb') as f:
+            return f.read()
+
+    def test_no_index(self, cmd_reordercap):
+        '''reordercap without --frame-index doesn't write an index'''
+        self.reorder(cmd_reordercap, 'reorder-out.pcap')
+        self.assertFalse(os.path.exists(self.index_file))
+
+    def test_index_written_and_used(self, cmd_reordercap):
+        '''--frame-index writes an index, then reads it back'''
+        expected = self.reorder(cmd_reordercap, 'reorder-plain.pcap')
+        written = self.reorder(cmd_reordercap, 'reorder-write.pcap', '--frame-index')
+        self.assertEqual(written, expected)
+        index = self.read_index()
+        self.assertEqual(index[:8], b'WSFRMIDX')
+        # 48-byte header plus 40 bytes per frame.
+        self.assertEqual(len(index), 48 + 40 * len(self.frame_times))
+        # An index that is read isn't written again.
+        os.utime(self.index_file, (0, 0))
+        used = self.reorder(cmd_reordercap, 'reorder-read.pcap', '--frame-index')
+        self.assertEqual(used, expected)
+        self.assertEqual(os.stat(self.index_file).st_mtime, 0)
+        self.assertEqual(self.read_index(), index)
+
+    def test_stale_index(self, cmd_reordercap):
+        '''an index for an older version of the capture file is rejected'''
+        expected = self.reorder(cmd_reordercap, 'reorder-plain.pcap')
+        self.reorder(cmd_reordercap, 'reorder-write.pcap', '--frame-index')
+        index = self.read_index()
+        infile_stat = os.stat(self.infile)
+        os.utime(self.infile, (infile_stat.st_atime, infile_stat.st_mtime - 3600))
+        stale = self.reorder(cmd_reordercap, 'reorder-stale.pcap', '--frame-index')
+        self.assertEqual(stale, expected)
+        # The file was read again and the index rewritten for its new mtime.
+        self.assertNotEqual(self.read_index(), index)
+        self.assertEqual(len(self.read_index()), len(index))
+
+    def test_stale_index_nsecs(self, cmd_reordercap):
+        '''an index is rejected if the capture file's mtime moved by a nanosecond'''
+        self.reorder(cmd_reordercap, 'reorder-write.pcap', '--frame-index')
+        index = self.read_index()
+        infile_stat = os.stat(self.infile)
+        os.utime(self.infile, ns=(infile_stat.st_atime_ns, infile_stat.st_mtime_ns + 1))
+        if os.stat(self.infile).st_mtime_ns == infile_stat.st_mtime_ns:
+            self.skipTest('The file system does not store nanosecond timestamps.')
+        self.reorder(cmd_reordercap, 'reorder-stale.pcap', '--frame-index')
+        self.assertNotEqual(self.read_index(), index)
+
+    def test_corrupt_index(self, cmd_reordercap):
+        '''an index with a bad header or missing entries is rejected'''
+        expected = self.reorder(cmd_reordercap, 'reorder-plain.pcap')
+        self.reorder(cmd_reordercap, 'reorder-write.pcap', '--frame-index')
+        index = self.read_index()
+        for corrupt in (b'XXXXXXXX' + index[8:], index[:-20]):
+            with open(self.index_file, 'wb') as f:
+                f.write(corrupt)
+            output = self.reorder(cmd_reordercap, 'reorder-corrupt.pcap', '--frame-index')
+            self.assertEqual(output, expected)
+            # The file was read again and a good index written.
+            self.assertEqual(self.read_index(), index)
@@ -93,3 +93,23 @@ class case_outputformats(subprocesstest.SubprocessTestCase):
         ''' Check that the option -j works with -Tek.'''
         check_outputformat("ek", extra_args=['-j', 'dhcp'], expected="dhcp-filter.ek",
             multiline=True)
+
+    def test_outputformat_arrow(self, cmd_tshark, capture_file):
+        '''Checks that -Tarrow writes the fields as an Arrow IPC stream.'''
+        testout_file = self.filename_from_id('testout.arrows')
+        self.assertRun('"{0}" -r "{1}" -T arrow -e frame.number -e ip.src -e _ws.col.Protocol > "{2}"'.format(
+            cmd_tshark, capture_file('dhcp.pcap'), testout_file), shell=True)
+        with open(testout_file, 'rb') as f:
+            stream = f.read()
+        # A schema message first and the end-of-stream marker last.
+        self.assertEqual(stream[:4], b'\xff\xff\xff\xff')
+        self.assertEqual(stream[-8:], b'\xff\xff\xff\xff\x00\x00\x00\x00')
+        try:
+            import pyarrow
+        except ImportError:
+            return
+        table = pyarrow.ipc.open_stream(stream).read_all()
+        self.assertEqual(table.column('frame.number').to_pylist(), [1, 2, 3, 4])
+        self.assertEqual(table.column('ip.src').to_pylist(),
+            [bytes([0, 0, 0, 0]), bytes([192, 168, 0, 1])] * 2)
+        self.assertEqual(table.column('_ws.col.Protocol').to_pylist(), ['DHCP'] * 4)
@@ -183,6 +183,21 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
             },
         ))
 
+    def test_sharkd_req_frames_after(self, check_sharkd_session, capture_file):
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"frames", "params":{"limit": 2}},
+            {"jsonrpc":"2.0", "id":3, "method":"frames", "params":{"after": 2, "limit": 2}},
+            {"jsonrpc":"2.0", "id":4, "method":"frames", "params":{"after": 4}},
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,"result":[MatchObject({"num": 1}), MatchObject({"num": 2})]},
+            {"jsonrpc":"2.0","id":3,"result":[MatchObject({"num": 3}), MatchObject({"num": 4})]},
+            {"jsonrpc":"2.0","id":4,"result":[]},
+        ))
+
     def test_sharkd_req_tap_invalid(self, check_sharkd_session, capture_file):
         # XXX Unrecognized taps result in an empty line, modify
         #     run_sharkd_session such that checking for it is possible.
@@ -308,6 +323,64 @@ class case_sharkd(subprocesstest.SubprocessTestCase):
             },
         ))
 
+    def test_sharkd_req_follow_udp_stream(self, check_sharkd_session, capture_file):
+        # Only the frames indexed for the stream are retapped.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"follow",
+            "params":{"follow": "UDP", "filter": "udp.stream == 1"}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,
+            "result":MatchObject({
+             "payloads": [MatchObject({"n": 2}), MatchObject({"n": 4})]})
+            },
+        ))
+
+    def test_sharkd_req_follow_tcp_stream(self, check_sharkd_session, capture_file):
+        # The two streams are interleaved.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('rsasnakeoil2.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"follow",
+            "params":{"follow": "TCP", "filter": "tcp.stream == 1"}
+            },
+            {"jsonrpc":"2.0", "id":3, "method":"follow",
+            "params":{"follow": "TCP", "filter": "tcp.stream == 1 && tcp.srcport == 443"}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,
+            "result":MatchObject({
+             "payloads": [MatchObject({"n": n}) for n in (25, 27, 29, 30, 31, 32, 36, 37, 44, 45, 51, 54)]})
+            },
+            {"jsonrpc":"2.0","id":3,
+            "result":MatchObject({
+             "payloads": [MatchObject({"n": n}) for n in (27, 30, 32, 37, 45, 54)]})
+            },
+        ))
+
+    def test_sharkd_req_follow_empty_stream(self, check_sharkd_session, capture_file):
+        # No frame has the stream, so no frame is retapped.
+        check_sharkd_session((
+            {"jsonrpc":"2.0", "id":1, "method":"load",
+            "params":{"file": capture_file('dhcp.pcap')}
+            },
+            {"jsonrpc":"2.0", "id":2, "method":"follow",
+            "params":{"follow": "UDP", "filter": "udp.stream == 7"}
+            },
+        ), (
+            {"jsonrpc":"2.0","id":1,"result":{"status":"OK"}},
+            {"jsonrpc":"2.0","id":2,
+            "result":{"shost": "NONE", "sport": "0", "sbytes": 0,
+             "chost": "NONE", "cport": "0", "cbytes": 0}
+            },
+        ))
+
     def test_sharkd_req_iograph_bad(self, check_sharkd_session, capture_file):
         check_sharkd_session((
             {"jsonrpc":"2.0", "id":1, "method":"load",
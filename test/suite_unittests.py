@@ -23,6 +23,10 @@ class case_unittests(subprocesstest.SubprocessTestCase):
         '''exntest'''
         self.assertRun(program('exntest'), env=base_env)
 
+    def test_unit_io_graph_item_test(self, program, base_env):
+        '''io_graph_item_test'''
+        self.assertRun(program('io_graph_item_test'), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         self.assertRun(program('oids_test'), env=base_env)
@@ -26,6 +26,7 @@
 
 #ifdef _WIN32
 # include <winsock2.h>
+# include <io.h>     /* for _setmode */
 #endif
 
 #ifndef _WIN32
@@ -134,6 +135,9 @@
 #define LONGOPT_ELASTIC_MAPPING_FILTER  LONGOPT_BASE_APPLICATION+4
 #define LONGOPT_EXPORT_TLS_SESSION_KEYS LONGOPT_BASE_APPLICATION+5
 #define LONGOPT_CAPTURE_COMMENT         LONGOPT_BASE_APPLICATION+6
+#define LONGOPT_READ_AHEAD              LONGOPT_BASE_APPLICATION+7
+#define LONGOPT_LAZY_DISSECTION         LONGOPT_BASE_APPLICATION+8
+#define LONGOPT_AUTO_RESET_MEMORY       LONGOPT_BASE_APPLICATION+9
 
 capture_file cfile;
 
@@ -145,6 +149,9 @@ static frame_data prev_cap_frame;
 static gboolean perform_two_pass_analysis;
 static guint32 epan_auto_reset_count = 0;
 static gboolean epan_auto_reset = FALSE;
+static size_t epan_auto_reset_memory = 0;  /* 0 means no memory limit */
+static guint read_ahead_count = 0;  /* 0 means don't read ahead */
+static gboolean lazy_dissection = FALSE;
 
 /*
  * The way the packet decode is to be written.
@@ -156,7 +163,8 @@ typedef enum {
   WRITE_FIELDS,   /* User defined list of fields */
   WRITE_JSON,     /* JSON */
   WRITE_JSON_RAW, /* JSON only raw hex */
-  WRITE_EK        /* JSON bulk insert to Elasticsearch */
+  WRITE_EK,       /* JSON bulk insert to Elasticsearch */
+  WRITE_ARROW     /* User defined list of fields as an Arrow IPC stream */
   /* Add CSV and the like here */
 } output_action_e;
 
@@ -390,6 +398,9 @@ print_usage(FILE *output)
   fprintf(output, "Processing:\n");
   fprintf(output, "  -2                       perform a two-pass analysis\n");
   fprintf(output, "  -M <packet count>        perform session auto reset\n");
+  fprintf(output, "  --auto-reset-memory <megabytes>\n");
+  fprintf(output, "                           perform session auto reset when the file scope\n");
+  fprintf(output, "                           allocator holds this much memory in blocks\n");
   fprintf(output, "  -R <read filter>, --read-filter <read filter>\n");
   fprintf(output, "                           packet Read filter in Wireshark display filter syntax\n");
   fprintf(output, "                           (requires -2)\n");
@@ -412,6 +423,10 @@ print_usage(FILE *output)
   fprintf(output, "                           enable dissection of heuristic protocol\n");
   fprintf(output, "  --disable-heuristic <short_name>\n");
   fprintf(output, "                           disable dissection of heuristic protocol\n");
+  fprintf(output, "  --read-ahead <count>     read up to <count> packets ahead of dissection\n");
+  fprintf(output, "                           in a separate thread (one-pass analysis only)\n");
+  fprintf(output, "  --lazy-dissection        only dissect the protocols needed by the filters and\n");
+  fprintf(output, "                           \"-T fields\" output\n");
 
   /*fprintf(output, "\n");*/
   fprintf(output, "Output:\n");
@@ -428,7 +443,7 @@ print_usage(FILE *output)
   fprintf(output, "  -P, --print              print packet summary even when writing to a file\n");
   fprintf(output, "  -S <separator>           the line separator to print between packets\n");
   fprintf(output, "  -x                       add output of hex and ASCII dump (Packet Bytes)\n");
-  fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|?\n");
+  fprintf(output, "  -T pdml|ps|psml|json|jsonraw|ek|tabs|text|fields|arrow|?\n");
   fprintf(output, "                           format of text output (def: text)\n");
   fprintf(output, "  -j <protocolfilter>      protocols layers filter if -T ek|pdml|json selected\n");
   fprintf(output, "                           (e.g. \"ip ip.flags text\", filter does not expand child\n");
@@ -671,6 +686,47 @@ must_do_dissection(dfilter_t *rfcode, dfilter_t *dfcode,
       tap_listeners_require_dissection() || dissect_color;
 }
 
+/*
+ * Turn on lazy dissection, if requested and if what we print only
+ * depends on the fields used by the filters and by "-T fields".
+ */
+static void
+setup_lazy_dissection(dfilter_t *rfcode, dfilter_t *dfcode)
+{
+  GArray    *hfids;
+  const int *fields;
+  int        num_fields;
+
+  if (!lazy_dissection)
+    return;
+
+  if (print_packet_info &&
+      ((output_action != WRITE_FIELDS && output_action != WRITE_ARROW) ||
+       output_fields_has_cols(output_fields))) {
+    ws_warning("--lazy-dissection is only done with -q, -w or \"-T fields\" without column fields; dissecting everything");
+    return;
+  }
+  if (tap_listeners_require_dissection() || dissect_color) {
+    ws_warning("--lazy-dissection can't be done with taps or coloring rules; dissecting everything");
+    return;
+  }
+
+  hfids = g_array_new(FALSE, FALSE, (guint)sizeof(int));
+  if (rfcode) {
+    fields = dfilter_get_interesting_fields(rfcode, &num_fields);
+    g_array_append_vals(hfids, fields, num_fields);
+  }
+  if (dfcode) {
+    fields = dfilter_get_interesting_fields(dfcode, &num_fields);
+    g_array_append_vals(hfids, fields, num_fields);
+  }
+  output_fields_append_hfids(output_fields, hfids);
+
+  if (!enable_lazy_dissection(hfids))
+    ws_warning("--lazy-dissection: can't tell which protocols lead to the requested fields; dissecting everything");
+  g_array_free(hfids, TRUE);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -700,6 +756,9 @@ main(int argc, char *argv[])
     {"no-duplicate-keys", ws_no_argument, NULL, LONGOPT_NO_DUPLICATE_KEYS},
     {"elastic-mapping-filter", ws_required_argument, NULL, LONGOPT_ELASTIC_MAPPING_FILTER},
     {"capture-comment", ws_required_argument, NULL, LONGOPT_CAPTURE_COMMENT},
+    {"read-ahead", ws_required_argument, NULL, LONGOPT_READ_AHEAD},
+    {"lazy-dissection", ws_no_argument, NULL, LONGOPT_LAZY_DISSECTION},
+    {"auto-reset-memory", ws_required_argument, NULL, LONGOPT_AUTO_RESET_MEMORY},
     {0, 0, 0, 0 }
   };
   gboolean             arg_error = FALSE;
@@ -1074,6 +1133,25 @@ main(int argc, char *argv[])
       epan_auto_reset_count = get_positive_int(ws_optarg, "epan reset count");
       epan_auto_reset = TRUE;
       break;
+    case LONGOPT_AUTO_RESET_MEMORY:
+    {
+      int reset_memory_mb;
+
+      if(perform_two_pass_analysis){
+        cmdarg_err("--auto-reset-memory does not support two pass analysis.");
+        arg_error=TRUE;
+      }
+      reset_memory_mb = get_positive_int(ws_optarg, "epan reset memory");
+      /* A 32-bit size_t can't hold 4096 MB or more. */
+      if ((gsize)reset_memory_mb > G_MAXSIZE / (1024 * 1024)) {
+        cmdarg_err("--auto-reset-memory %d MB is too large.", reset_memory_mb);
+        arg_error=TRUE;
+        break;
+      }
+      epan_auto_reset_memory = (size_t)reset_memory_mb * 1024 * 1024;
+      epan_auto_reset = TRUE;
+      break;
+    }
     case 'a':        /* autostop criteria */
     case 'b':        /* Ringbuffer option */
     case 'f':        /* capture filter */
@@ -1339,11 +1417,17 @@ main(int argc, char *argv[])
         output_action = WRITE_JSON_RAW;
         print_details = TRUE;   /* Need details */
         print_summary = FALSE;  /* Don't allow summary */
+      } else if (strcmp(ws_optarg, "arrow") == 0) {
+        output_action = WRITE_ARROW;
+        print_details = TRUE;   /* Need full tree info */
+        print_summary = FALSE;  /* Don't allow summary */
       }
       else {
         cmdarg_err("Invalid -T parameter \"%s\"; it must be one of:", ws_optarg);                   /* x */
         cmdarg_err_cont("\t\"fields\"  The values of fields specified with the -e option, in a form\n"
                         "\t          specified by the -E option.\n"
+                        "\t\"arrow\"   The values of fields specified with the -e option, as typed\n"
+                        "\t          columns in an Apache Arrow IPC stream.\n"
                         "\t\"pdml\"    Packet Details Markup Language, an XML-based format for the\n"
                         "\t          details of a decoded packet. This information is equivalent to\n"
                         "\t          the packet details printed with the -V flag.\n"
@@ -1470,6 +1554,12 @@ main(int argc, char *argv[])
       }
       g_ptr_array_add(capture_comments, g_strdup(ws_optarg));
       break;
+    case LONGOPT_READ_AHEAD:
+      read_ahead_count = get_natural_int(ws_optarg, "read-ahead count");
+      break;
+    case LONGOPT_LAZY_DISSECTION:
+      lazy_dissection = TRUE;
+      break;
     default:
     case '?':        /* Bad flag - print usage message */
       switch(ws_optopt) {
@@ -1508,15 +1598,21 @@ main(int argc, char *argv[])
     goto clean_exit;
   }
 
+  if (read_ahead_count > 0 && perform_two_pass_analysis) {
+    cmdarg_err("--read-ahead can't be used with two-pass analysis (-2)");
+    exit_status = INVALID_OPTION;
+    goto clean_exit;
+  }
+
   /* If we specified output fields, but not the output field type... */
-  if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action) && 0 != output_fields_num_fields(output_fields)) {
+  if ((WRITE_FIELDS != output_action && WRITE_XML != output_action && WRITE_JSON != output_action && WRITE_EK != output_action && WRITE_ARROW != output_action) && 0 != output_fields_num_fields(output_fields)) {
         cmdarg_err("Output fields were specified with \"-e\", "
-            "but \"-Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
+            "but \"-Tarrow, -Tek, -Tfields, -Tjson or -Tpdml\" was not specified.");
         exit_status = INVALID_OPTION;
         goto clean_exit;
-  } else if (WRITE_FIELDS == output_action && 0 == output_fields_num_fields(output_fields)) {
-        cmdarg_err("\"-Tfields\" was specified, but no fields were "
-                    "specified with \"-e\".");
+  } else if ((WRITE_FIELDS == output_action || WRITE_ARROW == output_action) && 0 == output_fields_num_fields(output_fields)) {
+        cmdarg_err("\"-T%s\" was specified, but no fields were "
+                    "specified with \"-e\".", WRITE_ARROW == output_action ? "arrow" : "fields");
 
         exit_status = INVALID_OPTION;
         goto clean_exit;
@@ -1999,6 +2095,15 @@ main(int argc, char *argv[])
         ws_assert_not_reached();
       }
     }
+
+    /* The dissection output is written with lots of small stdio calls.
+       When it goes to a pipe or a file and we haven't been asked to
+       flush after each packet, use a buffer large enough to hold a few
+       packets so that we make fewer, larger writes. */
+    if (!line_buffered && !ws_isatty(ws_fileno(stdout))) {
+      static char stdout_buf[64 * 1024];
+      setvbuf(stdout, stdout_buf, _IOFBF, sizeof stdout_buf);
+    }
   }
 
   /* PDU export requested. Take the ownership of the '-w' file, apply tap
@@ -2091,6 +2196,7 @@ main(int argc, char *argv[])
        other things, what taps are listening, so determine that after
        starting the statistics taps. */
     do_dissection = must_do_dissection(rfcode, dfcode, pdu_export_arg);
+    setup_lazy_dissection(rfcode, dfcode);
 
     /* Process the packets in the file */
     ws_debug("tshark: invoking process_cap_file() to process the packets");
@@ -2268,6 +2374,7 @@ main(int argc, char *argv[])
        other things, what taps are listening, so determine that after
        starting the statistics taps. */
     do_dissection = must_do_dissection(rfcode, dfcode, pdu_export_arg);
+    setup_lazy_dissection(rfcode, dfcode);
 
     /*
      * XXX - this returns FALSE if an error occurred, but it also
@@ -3110,6 +3217,167 @@ typedef enum {
   PASS_INTERRUPTED
 } pass_status_t;
 
+/*
+ * Read-ahead for the one-pass case.
+ *
+ * A reader thread calls wtap_read() and hands filled records to the
+ * dissection thread through a pair of queues, so that reading and
+ * decompressing the input file overlaps with dissecting and printing.
+ * The records and buffers are preallocated and recycled, which bounds
+ * the amount of memory used to "read_ahead_count" records.
+ *
+ * The dissection thread still looks at the wtap (interface descriptions,
+ * for example) while the reader thread is reading, so this is only done
+ * for file types that can't add interfaces or decryption secrets after
+ * the file has been opened.
+ */
+typedef struct {
+  wtap_rec     rec;
+  Buffer       buf;
+  gint64       data_offset;
+  gboolean     eof;         /* no more records; err and err_info are valid */
+  int          err;
+  gchar       *err_info;
+} read_ahead_elem_t;
+
+typedef struct {
+  wtap              *wth;
+  GThread           *thread;
+  GAsyncQueue       *free_q;    /* elements the reader thread can fill */
+  GAsyncQueue       *full_q;    /* elements waiting to be dissected */
+  read_ahead_elem_t *elems;
+  guint              num_elems;
+  read_ahead_elem_t *cur;       /* element being dissected, if any */
+  gboolean           done;      /* the reader thread has reported EOF */
+  gint               stop;      /* tell the reader thread to stop early */
+} read_ahead_t;
+
+static gboolean
+read_ahead_supported(wtap *wth)
+{
+  int file_type_subtype = wtap_file_type_subtype(wth);
+
+  return file_type_subtype == wtap_pcap_file_type_subtype() ||
+         file_type_subtype == wtap_pcap_nsec_file_type_subtype();
+}
+
+static gpointer
+read_ahead_thread(gpointer data)
+{
+  read_ahead_t      *ra = (read_ahead_t *)data;
+  read_ahead_elem_t *elem;
+
+  do {
+    elem = (read_ahead_elem_t *)g_async_queue_pop(ra->free_q);
+    elem->err = 0;
+    elem->err_info = NULL;
+    if (g_atomic_int_get(&ra->stop) || read_interrupted)
+      elem->eof = TRUE;
+    else
+      elem->eof = !wtap_read(ra->wth, &elem->rec, &elem->buf,
+                             &elem->err, &elem->err_info, &elem->data_offset);
+    g_async_queue_push(ra->full_q, elem);
+  } while (!elem->eof);
+
+  return NULL;
+}
+
+static read_ahead_t *
+read_ahead_new(wtap *wth, guint count)
+{
+  read_ahead_t *ra = g_new0(read_ahead_t, 1);
+  guint         i;
+
+  ra->wth = wth;
+  ra->free_q = g_async_queue_new();
+  ra->full_q = g_async_queue_new();
+  ra->num_elems = count;
+  ra->elems = g_new0(read_ahead_elem_t, count);
+  for (i = 0; i < count; i++) {
+    wtap_rec_init(&ra->elems[i].rec);
+    ws_buffer_init(&ra->elems[i].buf, 1514);
+    g_async_queue_push(ra->free_q, &ra->elems[i]);
+  }
+  ra->thread = g_thread_new("Read-ahead", read_ahead_thread, ra);
+
+  return ra;
+}
+
+/*
+ * Give the element we've finished with back to the reader thread and
+ * wait for the next one.  Returns FALSE, with *err and *err_info set,
+ * at the end of the file.
+ */
+static gboolean
+read_ahead_next(read_ahead_t *ra, wtap_rec **recp, Buffer **bufp,
+                int *err, gchar **err_info, gint64 *data_offset)
+{
+  read_ahead_elem_t *elem;
+
+  if (ra->cur != NULL) {
+    wtap_rec_reset(&ra->cur->rec);
+    g_async_queue_push(ra->free_q, ra->cur);
+    ra->cur = NULL;
+  }
+  if (ra->done) {
+    *err = 0;
+    return FALSE;
+  }
+
+  elem = (read_ahead_elem_t *)g_async_queue_pop(ra->full_q);
+  if (elem->eof) {
+    ra->done = TRUE;
+    *err = elem->err;
+    *err_info = elem->err_info;
+    return FALSE;
+  }
+  ra->cur = elem;
+  *recp = &elem->rec;
+  *bufp = &elem->buf;
+  *data_offset = elem->data_offset;
+  return TRUE;
+}
+
+static void
+read_ahead_free(read_ahead_t *ra)
+{
+  read_ahead_elem_t *elem;
+  guint              i;
+
+  if (ra->cur != NULL) {
+    wtap_rec_reset(&ra->cur->rec);
+    g_async_queue_push(ra->free_q, ra->cur);
+    ra->cur = NULL;
+  }
+
+  /*
+   * If we stopped before the end of the file, tell the reader thread
+   * to stop, and keep giving it elements until it says it's done, so
+   * that it's never left waiting for one.
+   */
+  g_atomic_int_set(&ra->stop, 1);
+  while (!ra->done) {
+    elem = (read_ahead_elem_t *)g_async_queue_pop(ra->full_q);
+    if (elem->eof) {
+      g_free(elem->err_info);
+      ra->done = TRUE;
+    } else {
+      wtap_rec_reset(&elem->rec);
+      g_async_queue_push(ra->free_q, elem);
+    }
+  }
+  g_thread_join(ra->thread);
+
+  for (i = 0; i < ra->num_elems; i++) {
+    ws_buffer_free(&ra->elems[i].buf);
+    wtap_rec_cleanup(&ra->elems[i].rec);
+  }
+  g_free(ra->elems);
+  g_async_queue_unref(ra->free_q);
+  g_async_queue_unref(ra->full_q);
+  g_free(ra);
+}
+
 static pass_status_t
 process_cap_file_first_pass(capture_file *cf, int max_packet_count,
                             gint64 max_byte_count, int *err, gchar **err_info)
@@ -3420,6 +3688,9 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
 {
   wtap_rec        rec;
   Buffer          buf;
+  wtap_rec       *recp = &rec;
+  Buffer         *bufp = &buf;
+  read_ahead_t   *ra = NULL;
   gboolean create_proto_tree = FALSE;
   gboolean        filtering_tap_listeners;
   guint           tap_flags;
@@ -3481,8 +3752,18 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
    */
   set_resolution_synchrony(TRUE);
 
+  if (read_ahead_count > 0) {
+    if (read_ahead_supported(cf->provider.wth))
+      ra = read_ahead_new(cf->provider.wth, read_ahead_count);
+    else
+      ws_warning("Read-ahead isn't supported for %s files; reading without it",
+                 wtap_file_type_subtype_name(wtap_file_type_subtype(cf->provider.wth)));
+  }
+
   *err = 0;
-  while (wtap_read(cf->provider.wth, &rec, &buf, err, err_info, &data_offset)) {
+  while (ra != NULL ?
+         read_ahead_next(ra, &recp, &bufp, err, err_info, &data_offset) :
+         wtap_read(cf->provider.wth, &rec, &buf, err, err_info, &data_offset)) {
     if (read_interrupted) {
       status = PASS_INTERRUPTED;
       break;
@@ -3502,13 +3783,13 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
 
     reset_epan_mem(cf, edt, create_proto_tree, print_packet_info && print_details);
 
-    if (process_packet_single_pass(cf, edt, data_offset, &rec, &buf, tap_flags)) {
+    if (process_packet_single_pass(cf, edt, data_offset, recp, bufp, tap_flags)) {
       /* Either there's no read filtering or this packet passed the
          filter, so, if we're writing to a capture file, write
          this packet out. */
       if (pdh != NULL) {
         ws_debug("tshark: writing packet #%d to outfile", framenum);
-        if (!wtap_dump(pdh, &rec, ws_buffer_start_ptr(&buf), err, err_info)) {
+        if (!wtap_dump(pdh, recp, ws_buffer_start_ptr(bufp), err, err_info)) {
           /* Error writing to the output file. */
           ws_debug("tshark: error writing to a capture file (%d)", *err);
           *err_framenum = framenum;
@@ -3528,13 +3809,16 @@ process_cap_file_single_pass(capture_file *cf, wtap_dumper *pdh,
       *err = 0; /* This is not an error */
       break;
     }
-    wtap_rec_reset(&rec);
+    wtap_rec_reset(recp);
   }
   if (*err != 0 && status == PASS_SUCCEEDED) {
     /* Error reading from the input file. */
     status = PASS_READ_ERROR;
   }
 
+  if (ra != NULL)
+    read_ahead_free(ra);
+
   if (edt)
     epan_dissect_free(edt);
 
@@ -3920,6 +4204,14 @@ write_preamble(capture_file *cf)
     write_fields_preamble(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_ARROW:
+#ifdef _WIN32
+    /* Don't let the C runtime mangle the binary output. */
+    _setmode(1, O_BINARY);
+#endif
+    write_arrow_preamble(output_fields, stdout);
+    return !ferror(stdout);
+
   case WRITE_JSON:
   case WRITE_JSON_RAW:
     jdumper = write_json_preamble(stdout);
@@ -4273,6 +4565,10 @@ print_packet(capture_file *cf, epan_dissect_t *edt)
     }
     break;
 
+  case WRITE_ARROW:
+    write_arrow_proto_tree(output_fields, edt, &cf->cinfo, stdout);
+    return !ferror(stdout);
+
   case WRITE_JSON:
     if (print_summary)
       ws_assert_not_reached();
@@ -4336,6 +4632,9 @@ write_finale(void)
     write_fields_finale(output_fields, stdout);
     return !ferror(stdout);
 
+  case WRITE_ARROW:
+    return write_arrow_finale(output_fields, stdout) && !ferror(stdout);
+
   case WRITE_JSON:
   case WRITE_JSON_RAW:
     write_json_finale(&jdumper);
@@ -4524,7 +4823,19 @@ tshark_cmdarg_err_cont(const char *msg_format, va_list ap)
 
 static void reset_epan_mem(capture_file *cf,epan_dissect_t *edt, gboolean tree, gboolean visual)
 {
-  if (!epan_auto_reset || (cf->count < epan_auto_reset_count))
+  if (!epan_auto_reset)
+    return;
+
+  /*
+   * Reset after -M packets, or once the blocks of the file scope
+   * allocator (conversations, reassembly data and the rest of the
+   * per-capture state that's allocated there) have grown past
+   * --auto-reset-memory, whichever comes first.  A count of 0 means
+   * only the memory limit applies.
+   */
+  if ((epan_auto_reset_count == 0 || cf->count < epan_auto_reset_count) &&
+      (epan_auto_reset_memory == 0 ||
+       wmem_memory_in_use(wmem_file_scope()) < epan_auto_reset_memory))
     return;
 
   fprintf(stderr, "resetting session.\n");
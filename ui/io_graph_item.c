@@ -12,8 +12,10 @@
 
 #include "config.h"
 
+#include <string.h>
 
 #include <epan/epan_dissect.h>
+#include <wsutil/glib-compat.h>
 
 #include "ui/io_graph_item.h"
 
@@ -263,3 +265,211 @@ double get_io_graph_item(const io_graph_item_t *items_, io_graph_item_unit_t val
     }
     return value;
 }
+
+/* Is the maximum (if want_max) or minimum of src beyond the one of dst? */
+static gboolean
+io_graph_item_extreme_beyond(const io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, gboolean want_max)
+{
+    switch (proto_registrar_get_ftype(hf_index)) {
+    case FT_UINT8:
+    case FT_UINT16:
+    case FT_UINT24:
+    case FT_UINT32:
+    case FT_UINT40:
+    case FT_UINT48:
+    case FT_UINT56:
+    case FT_UINT64:
+        return want_max ? (guint64)src->int_max > (guint64)dst->int_max
+                        : (guint64)src->int_min < (guint64)dst->int_min;
+    case FT_INT8:
+    case FT_INT16:
+    case FT_INT24:
+    case FT_INT32:
+    case FT_INT40:
+    case FT_INT48:
+    case FT_INT56:
+    case FT_INT64:
+        return want_max ? src->int_max > dst->int_max
+                        : src->int_min < dst->int_min;
+    case FT_FLOAT:
+        return want_max ? src->float_max > dst->float_max
+                        : src->float_min < dst->float_min;
+    case FT_DOUBLE:
+        return want_max ? src->double_max > dst->double_max
+                        : src->double_min < dst->double_min;
+    case FT_RELATIVE_TIME:
+        return want_max ? nstime_cmp(&src->time_max, &dst->time_max) > 0
+                        : nstime_cmp(&src->time_min, &dst->time_min) < 0;
+    default:
+        return FALSE;
+    }
+}
+
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, io_graph_item_unit_t item_unit)
+{
+    if (dst->first_frame_in_invl == 0) {
+        dst->first_frame_in_invl = src->first_frame_in_invl;
+    }
+    if (src->last_frame_in_invl != 0) {
+        dst->last_frame_in_invl = src->last_frame_in_invl;
+    }
+
+    /* Maxima and minima; if dst has no fields yet, src's are the new ones. */
+    if (hf_index >= 0 && src->fields > 0) {
+        if (dst->fields == 0 || io_graph_item_extreme_beyond(dst, src, hf_index, TRUE)) {
+            dst->int_max = src->int_max;
+            dst->float_max = src->float_max;
+            dst->double_max = src->double_max;
+            dst->time_max = src->time_max;
+            if (item_unit == IOG_ITEM_UNIT_CALC_MAX) {
+                dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+            }
+        }
+        if (dst->fields == 0 || io_graph_item_extreme_beyond(dst, src, hf_index, FALSE)) {
+            dst->int_min = src->int_min;
+            dst->float_min = src->float_min;
+            dst->double_min = src->double_min;
+            dst->time_min = src->time_min;
+            if (item_unit == IOG_ITEM_UNIT_CALC_MIN) {
+                dst->extreme_frame_in_invl = src->extreme_frame_in_invl;
+            }
+        }
+    }
+
+    dst->frames += src->frames;
+    dst->bytes += src->bytes;
+    dst->fields += src->fields;
+    dst->int_tot += src->int_tot;
+    dst->float_tot += src->float_tot;
+    dst->double_tot += src->double_tot;
+    /* For LOAD graphs this adds up the part of each call that falls into
+     * the finer intervals, which is the part that falls into the coarser
+     * one. */
+    nstime_add(&dst->time_tot, &src->time_tot);
+}
+
+typedef struct {
+    guint32 frame_count;
+    guint32 frames_state_gen;
+    int hf_index;
+    int interval;
+    int num_items;
+    io_graph_item_t *items;
+    double start_time;
+} io_graph_cache_entry_t;
+
+struct _io_graph_cache_t {
+    GHashTable *entries;    /* key -> io_graph_cache_entry_t */
+};
+
+static void
+io_graph_cache_entry_free(gpointer data)
+{
+    io_graph_cache_entry_t *entry = (io_graph_cache_entry_t *)data;
+
+    g_free(entry->items);
+    g_free(entry);
+}
+
+static gchar *
+io_graph_cache_key(const char *filter, const char *field_name, io_graph_item_unit_t item_unit)
+{
+    /* The unit matters for the frame with the minimum or maximum value. */
+    return g_strdup_printf("%d\x1f%s\x1f%s", item_unit,
+                           field_name ? field_name : "", filter ? filter : "");
+}
+
+io_graph_cache_t *io_graph_cache_new(void)
+{
+    io_graph_cache_t *cache = g_new(io_graph_cache_t, 1);
+
+    cache->entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, io_graph_cache_entry_free);
+    return cache;
+}
+
+void io_graph_cache_free(io_graph_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+    g_hash_table_destroy(cache->entries);
+    g_free(cache);
+}
+
+void io_graph_cache_clear(io_graph_cache_t *cache)
+{
+    g_hash_table_remove_all(cache->entries);
+}
+
+void io_graph_cache_store(io_graph_cache_t *cache, const capture_file *cap_file,
+                          const char *filter, const char *field_name, io_graph_item_unit_t item_unit,
+                          int hf_index, int interval, const io_graph_item_t *items, int num_items,
+                          double start_time)
+{
+    io_graph_cache_entry_t *entry;
+    gchar *key;
+
+    if (!cap_file || interval <= 0 || num_items < 0) {
+        return;
+    }
+
+    key = io_graph_cache_key(filter, field_name, item_unit);
+    entry = (io_graph_cache_entry_t *)g_hash_table_lookup(cache->entries, key);
+    if (entry && entry->frame_count == cap_file->count &&
+            entry->frames_state_gen == cap_file->frames_state_gen && entry->hf_index == hf_index &&
+            interval % entry->interval == 0) {
+        /* We already have this interval or a finer one. */
+        g_free(key);
+        return;
+    }
+
+    entry = g_new(io_graph_cache_entry_t, 1);
+    entry->frame_count = cap_file->count;
+    entry->frames_state_gen = cap_file->frames_state_gen;
+    entry->hf_index = hf_index;
+    entry->interval = interval;
+    entry->num_items = num_items;
+    entry->items = (io_graph_item_t *)g_memdup2(items, sizeof(io_graph_item_t) * num_items);
+    entry->start_time = start_time;
+    g_hash_table_replace(cache->entries, key, entry);
+}
+
+io_graph_item_t *io_graph_cache_lookup(io_graph_cache_t *cache, const capture_file *cap_file,
+                                       const char *filter, const char *field_name, io_graph_item_unit_t item_unit,
+                                       int interval, int *num_items, double *start_time)
+{
+    io_graph_cache_entry_t *entry;
+    io_graph_item_t *items;
+    gchar *key;
+    int factor;
+    int i;
+
+    if (!cap_file || interval <= 0) {
+        return NULL;
+    }
+
+    key = io_graph_cache_key(filter, field_name, item_unit);
+    entry = (io_graph_cache_entry_t *)g_hash_table_lookup(cache->entries, key);
+    g_free(key);
+    if (!entry || entry->frame_count != cap_file->count ||
+            entry->frames_state_gen != cap_file->frames_state_gen || interval % entry->interval != 0) {
+        return NULL;
+    }
+
+    /* Interval i of the coarser graph covers intervals i * factor up to
+     * (i + 1) * factor - 1 of the cached one. */
+    factor = interval / entry->interval;
+    *start_time = entry->start_time;
+    *num_items = (entry->num_items + factor - 1) / factor;
+    items = g_new(io_graph_item_t, *num_items > 0 ? *num_items : 1);
+    if (factor == 1) {
+        memcpy(items, entry->items, sizeof(io_graph_item_t) * entry->num_items);
+        return items;
+    }
+
+    reset_io_graph_items(items, *num_items);
+    for (i = 0; i < entry->num_items; i++) {
+        merge_io_graph_item(&items[i / factor], &entry->items[i], entry->hf_index, item_unit);
+    }
+    return items;
+}
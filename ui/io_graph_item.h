@@ -395,6 +395,87 @@ update_io_graph_item(io_graph_item_t *items, int idx, packet_info *pinfo, epan_d
     return TRUE;
 }
 
+/** Add the values of one io_graph_item_t to another, as if the packets
+ * counted in src had been counted in dst.
+ *
+ * This is used to derive the items of a coarser interval from the items
+ * of a finer one, which must divide it.
+ *
+ * @param dst [in,out] Item to update.
+ * @param src [in] Item to add.
+ * @param hf_index [in] Header field index for advanced statistics.
+ * @param item_unit [in] The type of unit to calculate. From IOG_ITEM_UNITS.
+ */
+void merge_io_graph_item(io_graph_item_t *dst, const io_graph_item_t *src, int hf_index, io_graph_item_unit_t item_unit);
+
+/** A cache of io_graph_item_t arrays, so that a graph whose filter, unit
+ * and field were already tapped can be redrawn at the same or at a coarser
+ * interval without retapping.
+ *
+ * Each entry holds the items of the finest interval that was stored for
+ * it; coarser intervals that are a multiple of it are derived with
+ * merge_io_graph_item(). Entries are dropped when the number of frames in
+ * the capture file changes, or when frames are marked, ignored, commented,
+ * time referenced or time shifted, all of which can change what a filter
+ * matches or when a frame falls.
+ */
+typedef struct _io_graph_cache_t io_graph_cache_t;
+
+/** Create an empty cache.
+ *
+ * @return A new cache. Free it with io_graph_cache_free().
+ */
+io_graph_cache_t *io_graph_cache_new(void);
+
+/** Free a cache and all its entries.
+ *
+ * @param cache [in] The cache to free. May be NULL.
+ */
+void io_graph_cache_free(io_graph_cache_t *cache);
+
+/** Remove all the entries of a cache, e.g. because the packets were
+ * dissected again.
+ *
+ * @param cache [in,out] The cache to clear.
+ */
+void io_graph_cache_clear(io_graph_cache_t *cache);
+
+/** Store the items of a graph that was tapped over the whole capture file.
+ *
+ * @param cache [in,out] The cache.
+ * @param cap_file [in] Capture file that was tapped.
+ * @param filter [in] Display filter of the graph. May be NULL.
+ * @param field_name [in] Value unit field of the graph. May be NULL.
+ * @param item_unit [in] The type of unit to calculate. From IOG_ITEM_UNITS.
+ * @param hf_index [in] Header field index for advanced statistics.
+ * @param interval [in] Timing interval in ms.
+ * @param items [in] Items to store. They are copied.
+ * @param num_items [in] Number of items.
+ * @param start_time [in] Time origin of the graph, in seconds. This is the
+ *        absolute time of the first tapped packet minus its relative time.
+ */
+void io_graph_cache_store(io_graph_cache_t *cache, const capture_file *cap_file,
+                          const char *filter, const char *field_name, io_graph_item_unit_t item_unit,
+                          int hf_index, int interval, const io_graph_item_t *items, int num_items,
+                          double start_time);
+
+/** Get the items of a graph from the cache.
+ *
+ * @param cache [in] The cache.
+ * @param cap_file [in] Capture file to graph.
+ * @param filter [in] Display filter of the graph. May be NULL.
+ * @param field_name [in] Value unit field of the graph. May be NULL.
+ * @param item_unit [in] The type of unit to calculate. From IOG_ITEM_UNITS.
+ * @param interval [in] Timing interval in ms.
+ * @param num_items [out] Number of items returned.
+ * @param start_time [out] Time origin stored with the items.
+ * @return The items, which must be freed by the caller with g_free(), or
+ *         NULL if the cache can't provide them.
+ */
+io_graph_item_t *io_graph_cache_lookup(io_graph_cache_t *cache, const capture_file *cap_file,
+                                       const char *filter, const char *field_name, io_graph_item_unit_t item_unit,
+                                       int interval, int *num_items, double *start_time);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,187 @@
+/* io_graph_item_test.c
+ * Tests for the I/O graph item cache
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "io_graph_item.h"
+
+#define NUM_ITEMS 5
+
+/* Five 100 ms intervals, with 1, 2, 3, 4 and 5 frames of 10 bytes each. */
+static void
+make_items(io_graph_item_t *items)
+{
+    int i;
+
+    reset_io_graph_items(items, NUM_ITEMS);
+    for (i = 0; i < NUM_ITEMS; i++) {
+        items[i].frames = i + 1;
+        items[i].bytes = (i + 1) * 10;
+        items[i].first_frame_in_invl = i * 10 + 1;
+        items[i].last_frame_in_invl = i * 10 + i + 1;
+    }
+}
+
+static void
+init_cap_file(capture_file *cf)
+{
+    memset(cf, 0, sizeof *cf);
+    cf->count = 15;
+}
+
+static void
+test_cache_same_interval(void)
+{
+    io_graph_cache_t *cache = io_graph_cache_new();
+    io_graph_item_t items[NUM_ITEMS];
+    io_graph_item_t *cached;
+    capture_file cf;
+    int num_items = -1;
+    double start_time = 0.0;
+
+    init_cap_file(&cf);
+    make_items(items);
+    io_graph_cache_store(cache, &cf, "tcp", NULL, IOG_ITEM_UNIT_PACKETS,
+                         -1, 100, items, NUM_ITEMS, 1234.5);
+
+    cached = io_graph_cache_lookup(cache, &cf, "tcp", NULL, IOG_ITEM_UNIT_PACKETS,
+                                   100, &num_items, &start_time);
+    g_assert_nonnull(cached);
+    g_assert_cmpint(num_items, ==, NUM_ITEMS);
+    g_assert_true(memcmp(cached, items, sizeof items) == 0);
+    /* The origin is the one the graph was tapped with. */
+    g_assert_cmpfloat(start_time, ==, 1234.5);
+    g_free(cached);
+
+    /* Other filters and units aren't cached. */
+    g_assert_null(io_graph_cache_lookup(cache, &cf, "udp", NULL, IOG_ITEM_UNIT_PACKETS,
+                                        100, &num_items, &start_time));
+    g_assert_null(io_graph_cache_lookup(cache, &cf, "tcp", NULL, IOG_ITEM_UNIT_BYTES,
+                                        100, &num_items, &start_time));
+
+    io_graph_cache_free(cache);
+}
+
+static void
+test_cache_roll_up(void)
+{
+    io_graph_cache_t *cache = io_graph_cache_new();
+    io_graph_item_t items[NUM_ITEMS];
+    io_graph_item_t *cached;
+    capture_file cf;
+    int num_items = -1;
+    double start_time = 0.0;
+
+    init_cap_file(&cf);
+    make_items(items);
+    io_graph_cache_store(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_BYTES,
+                         -1, 100, items, NUM_ITEMS, 10.0);
+
+    cached = io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_BYTES,
+                                   200, &num_items, &start_time);
+    g_assert_nonnull(cached);
+    g_assert_cmpint(num_items, ==, 3);
+    g_assert_cmpuint(cached[0].frames, ==, 3);
+    g_assert_cmpuint(cached[0].bytes, ==, 30);
+    g_assert_cmpuint(cached[0].first_frame_in_invl, ==, 1);
+    g_assert_cmpuint(cached[0].last_frame_in_invl, ==, 12);
+    g_assert_cmpuint(cached[1].frames, ==, 7);
+    g_assert_cmpuint(cached[1].bytes, ==, 70);
+    g_assert_cmpuint(cached[2].frames, ==, 5);
+    g_assert_cmpuint(cached[2].last_frame_in_invl, ==, 45);
+    g_assert_cmpfloat(start_time, ==, 10.0);
+    g_free(cached);
+
+    /* 150 ms intervals can't be derived from 100 ms ones. */
+    g_assert_null(io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_BYTES,
+                                        150, &num_items, &start_time));
+
+    /* A coarser graph doesn't replace the finer one. */
+    io_graph_cache_store(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_BYTES,
+                         -1, 1000, items, 1, 10.0);
+    cached = io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_BYTES,
+                                   100, &num_items, &start_time);
+    g_assert_nonnull(cached);
+    g_assert_cmpint(num_items, ==, NUM_ITEMS);
+    g_free(cached);
+
+    io_graph_cache_free(cache);
+}
+
+static void
+test_cache_invalidation(void)
+{
+    io_graph_cache_t *cache = io_graph_cache_new();
+    io_graph_item_t items[NUM_ITEMS];
+    capture_file cf;
+    int num_items = -1;
+    double start_time = 0.0;
+
+    init_cap_file(&cf);
+    make_items(items);
+    io_graph_cache_store(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                         -1, 100, items, NUM_ITEMS, 0.0);
+
+    /* More frames were read. */
+    cf.count++;
+    g_assert_null(io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                                        100, &num_items, &start_time));
+    cf.count--;
+
+    /* A frame was marked, ignored, time referenced or time shifted. */
+    cf.frames_state_gen++;
+    g_assert_null(io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                                        100, &num_items, &start_time));
+
+    /* A graph tapped with the new state replaces the old one. */
+    io_graph_cache_store(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                         -1, 200, items, NUM_ITEMS, 5.0);
+    g_free(io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                                 200, &num_items, &start_time));
+    g_assert_cmpfloat(start_time, ==, 5.0);
+
+    io_graph_cache_clear(cache);
+    g_assert_null(io_graph_cache_lookup(cache, &cf, NULL, NULL, IOG_ITEM_UNIT_PACKETS,
+                                        200, &num_items, &start_time));
+
+    io_graph_cache_free(cache);
+}
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+
+    g_test_add_func("/io_graph_cache/same_interval", test_cache_same_interval);
+    g_test_add_func("/io_graph_cache/roll_up", test_cache_roll_up);
+    g_test_add_func("/io_graph_cache/invalidation", test_cache_invalidation);
+
+    ret = g_test_run();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -82,7 +82,8 @@ QString CaptureFile::no_capture_file_ = QObject::tr("[no capture file]");
 CaptureFile::CaptureFile(QObject *parent, capture_file *cap_file) :
     QObject(parent),
     cap_file_(cap_file),
-    file_state_(QString())
+    file_state_(QString()),
+    retap_pending_(false)
 {
 #ifdef HAVE_LIBPCAP
     capture_callback_add(captureCallback, (gpointer) this);
@@ -212,6 +213,9 @@ int CaptureFile::timestampPrecision()
 
 void CaptureFile::retapPackets()
 {
+    // This retap feeds every tap listener registered so far, including
+    // those of any pending delayed retap.
+    retap_pending_ = false;
     if (cap_file_) {
         cf_retap_packets(cap_file_);
     }
@@ -219,7 +223,18 @@ void CaptureFile::retapPackets()
 
 void CaptureFile::delayedRetapPackets()
 {
-    QTimer::singleShot(0, this, SLOT(retapPackets()));
+    if (retap_pending_) {
+        return;
+    }
+    retap_pending_ = true;
+    QTimer::singleShot(0, this, SLOT(runDelayedRetap()));
+}
+
+void CaptureFile::runDelayedRetap()
+{
+    if (retap_pending_) {
+        retapPackets();
+    }
 }
 
 void CaptureFile::reload()
@@ -135,6 +135,9 @@ public slots:
      * is processed. If you call this instead of retapPackets or
      * cf_retap_packets in a dialog's constructor it will be displayed before
      * tapping starts.
+     *
+     * Requests made before the retap starts are coalesced, so that dialogs
+     * opened together (e.g. with several -z options) share a single pass.
      */
     void delayedRetapPackets();
 
@@ -148,6 +151,9 @@ public slots:
      */
     void setCaptureStopFlag(bool stop_flag = true);
 
+private slots:
+    void runDelayedRetap();
+
 private:
     static void captureFileCallback(gint event, gpointer data, gpointer user_data);
 #ifdef HAVE_LIBPCAP
@@ -162,6 +168,7 @@ private:
 
     capture_file *cap_file_;
     QString file_state_;
+    bool retap_pending_;
 };
 
 #endif // CAPTURE_FILE_H
@@ -189,10 +189,12 @@ bool ConversationDialog::addTrafficTable(register_ct_t* table)
 
     conv_tree->trafficTreeHash()->user_data = conv_tree;
 
-    registerTapListener(proto_get_protocol_filter_name(proto_id), conv_tree->trafficTreeHash(), filter, 0,
-                        ConversationTreeWidget::tapReset,
-                        get_conversation_packet_func(table),
-                        ConversationTreeWidget::tapDraw);
+    if (registerTapListener(proto_get_protocol_filter_name(proto_id), conv_tree->trafficTreeHash(), filter, 0,
+                            ConversationTreeWidget::tapReset,
+                            get_conversation_packet_func(table),
+                            ConversationTreeWidget::tapDraw)) {
+        set_conversation_table_mergeable(conv_tree->trafficTreeHash());
+    }
 
     return true;
 }
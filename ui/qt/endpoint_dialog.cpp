@@ -165,10 +165,12 @@ bool EndpointDialog::addTrafficTable(register_ct_t *table)
 
     endp_tree->trafficTreeHash()->user_data = endp_tree;
 
-    registerTapListener(proto_get_protocol_filter_name(proto_id), endp_tree->trafficTreeHash(), filter, 0,
-                        EndpointTreeWidget::tapReset,
-                        get_hostlist_packet_func(table),
-                        EndpointTreeWidget::tapDraw);
+    if (registerTapListener(proto_get_protocol_filter_name(proto_id), endp_tree->trafficTreeHash(), filter, 0,
+                            EndpointTreeWidget::tapReset,
+                            get_hostlist_packet_func(table),
+                            EndpointTreeWidget::tapDraw)) {
+        set_hostlist_table_mergeable(endp_tree->trafficTreeHash());
+    }
     return true;
 }
 
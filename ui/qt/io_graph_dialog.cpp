@@ -312,6 +312,7 @@ IOGraphDialog::IOGraphDialog(QWidget &parent, CaptureFile &cf, QString displayFi
     need_replot_(false),
     need_retap_(false),
     auto_axes_(true),
+    graph_cache_(io_graph_cache_new()),
     number_ticker_(new QCPAxisTicker),
     datetime_ticker_(new QCPAxisTickerDateTime)
 {
@@ -353,6 +354,7 @@ IOGraphDialog::IOGraphDialog(QWidget &parent, CaptureFile &cf, QString displayFi
 
     stat_timer_ = new QTimer(this);
     connect(stat_timer_, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    connect(&cap_file_, &CaptureFile::captureEvent, this, &IOGraphDialog::graphCacheCaptureEvent);
     stat_timer_->start(stat_update_interval_);
 
     // Intervals (ms)
@@ -459,6 +461,7 @@ IOGraphDialog::~IOGraphDialog()
     foreach(IOGraph* iog, ioGraphs_) {
         delete iog;
     }
+    io_graph_cache_free(graph_cache_);
     delete ui;
     ui = NULL;
 }
@@ -640,6 +643,36 @@ void IOGraphDialog::scheduleReplot(bool now)
     updateLegend();
 }
 
+// Fill in the visible graphs from graph_cache_. Returns true if all of
+// them were found.
+bool IOGraphDialog::loadGraphsFromCache()
+{
+    capture_file *cf = cap_file_.capFile();
+    bool have_visible = false;
+
+    if (!cf) return false;
+
+    foreach(IOGraph* iog, ioGraphs_) {
+        if (!iog->visible()) continue;
+        if (!iog->loadFromCache(graph_cache_, cf)) return false;
+        have_visible = true;
+    }
+    return have_visible;
+}
+
+void IOGraphDialog::graphCacheCaptureEvent(CaptureEvent e)
+{
+    // Redissecting or reloading may change what the graphs count.
+    if ((e.captureContext() == CaptureEvent::Rescan ||
+         e.captureContext() == CaptureEvent::Reload) &&
+            e.eventType() == CaptureEvent::Started) {
+        io_graph_cache_clear(graph_cache_);
+    } else if (e.captureContext() == CaptureEvent::File &&
+            e.eventType() == CaptureEvent::Closing) {
+        io_graph_cache_clear(graph_cache_);
+    }
+}
+
 void IOGraphDialog::scheduleRecalc(bool now)
 {
     need_recalc_ = true;
@@ -1145,42 +1178,55 @@ void IOGraphDialog::updateStatistics()
 
     if (need_retap_ && !file_closed_ && prefs.gui_io_graph_automatic_update) {
         need_retap_ = false;
-        cap_file_.retapPackets();
-        // The user might have closed the window while tapping, which means
-        // we might no longer exist.
-    } else {
-        if (need_recalc_ && !file_closed_ && prefs.gui_io_graph_automatic_update) {
-            need_recalc_ = false;
-            need_replot_ = true;
-            int enabled_graphs = 0;
-
-            if (uat_model_ != NULL) {
-                for (int row = 0; row < uat_model_->rowCount(); row++) {
-                    if (graphIsEnabled(row)) {
-                        ++enabled_graphs;
-                    }
+        if (!loadGraphsFromCache()) {
+            beginRetapPackets();
+            cap_file_.retapPackets();
+            // The user might have closed the window while tapping, in which
+            // case we're deleted by endRetapPackets.
+            if (!file_closed_ && cap_file_.capFile() && !cap_file_.capFile()->stop_flag) {
+                foreach(IOGraph* iog, ioGraphs_) {
+                    iog->storeInCache(graph_cache_, cap_file_.capFile());
                 }
             }
-            // With multiple visible graphs, disable Y scaling to avoid
-            // multiple, distinct units.
-            emit recalcGraphData(cap_file_.capFile(), enabled_graphs == 1);
-            if (!tracer_->graph()) {
-                if (base_graph_ && base_graph_->data()->size() > 0) {
-                    tracer_->setGraph(base_graph_);
-                    tracer_->setVisible(true);
-                } else {
-                    tracer_->setVisible(false);
+            endRetapPackets();
+            return;
+        }
+        // We already tapped for these graphs, at this interval or at a
+        // finer one, so we only have to recalculate.
+        need_recalc_ = true;
+    }
+
+    if (need_recalc_ && !file_closed_ && prefs.gui_io_graph_automatic_update) {
+        need_recalc_ = false;
+        need_replot_ = true;
+        int enabled_graphs = 0;
+
+        if (uat_model_ != NULL) {
+            for (int row = 0; row < uat_model_->rowCount(); row++) {
+                if (graphIsEnabled(row)) {
+                    ++enabled_graphs;
                 }
             }
         }
-        if (need_replot_) {
-            need_replot_ = false;
-            if (auto_axes_) {
-                resetAxes();
+        // With multiple visible graphs, disable Y scaling to avoid
+        // multiple, distinct units.
+        emit recalcGraphData(cap_file_.capFile(), enabled_graphs == 1);
+        if (!tracer_->graph()) {
+            if (base_graph_ && base_graph_->data()->size() > 0) {
+                tracer_->setGraph(base_graph_);
+                tracer_->setVisible(true);
+            } else {
+                tracer_->setVisible(false);
             }
-            ui->ioPlot->replot();
         }
     }
+    if (need_replot_) {
+        need_replot_ = false;
+        if (auto_axes_) {
+            resetAxes();
+        }
+        ui->ioPlot->replot();
+    }
 }
 
 void IOGraphDialog::loadProfileGraphs()
@@ -1913,6 +1959,53 @@ void IOGraph::clearAllData()
     start_time_ = 0.0;
 }
 
+// Replace our items with the ones derived from the cache, if it has them.
+bool IOGraph::loadFromCache(io_graph_cache_t *cache, capture_file *cap_file)
+{
+    int num_items = 0;
+    double start_time = 0.0;
+    bool advanced = val_units_ >= IOG_ITEM_UNIT_CALC_SUM;
+    QByteArray filter = filter_.toUtf8();
+    QByteArray field = vu_field_.toUtf8();
+    io_graph_item_t *items;
+
+    if (!config_err_.isEmpty()) return false;
+
+    items = io_graph_cache_lookup(cache, cap_file, filter.constData(),
+                                  advanced ? field.constData() : NULL,
+                                  val_units_, interval_, &num_items, &start_time);
+    if (!items) return false;
+    if (num_items > max_io_items_) {
+        g_free(items);
+        return false;
+    }
+
+    clearAllData();
+    memcpy(items_, items, sizeof(io_graph_item_t) * num_items);
+    g_free(items);
+    cur_idx_ = num_items - 1;
+    // The origin tapPacket set when the items were tapped, so that time
+    // references move it the same way.
+    start_time_ = start_time;
+    return true;
+}
+
+// Remember our items after a retap of the whole file.
+void IOGraph::storeInCache(io_graph_cache_t *cache, capture_file *cap_file) const
+{
+    bool advanced = val_units_ >= IOG_ITEM_UNIT_CALC_SUM;
+    QByteArray filter = filter_.toUtf8();
+    QByteArray field = vu_field_.toUtf8();
+
+    // Skip graphs with errors, and graphs that ran past max_io_items_,
+    // which we can't roll up correctly.
+    if (!config_err_.isEmpty() || cur_idx_ >= max_io_items_ - 1) return;
+
+    io_graph_cache_store(cache, cap_file, filter.constData(),
+                         advanced ? field.constData() : NULL,
+                         val_units_, hf_index_, interval_, items_, cur_idx_ + 1, start_time_);
+}
+
 void IOGraph::recalcGraphData(capture_file *cap_file, bool enable_scaling)
 {
     /* Moving average variables */
@@ -80,6 +80,8 @@ public:
     QString scaledValueUnit() const { return scaled_value_unit_; }
 
     void clearAllData();
+    bool loadFromCache(io_graph_cache_t *cache, capture_file *cap_file);
+    void storeInCache(io_graph_cache_t *cache, capture_file *cap_file) const;
 
     unsigned int moving_avg_period_;
     unsigned int y_axis_factor_;
@@ -187,6 +189,7 @@ private:
     bool need_recalc_; // Medium weight: recalculate values, then replot
     bool need_retap_; // Heavy weight: re-read packet data
     bool auto_axes_;
+    io_graph_cache_t *graph_cache_; // Tapped graphs, for other intervals
 
     QSharedPointer<QCPAxisTicker> number_ticker_;
     QSharedPointer<QCPAxisTickerDateTime> datetime_ticker_;
@@ -207,6 +210,7 @@ private:
     bool saveCsv(const QString &file_name) const;
     IOGraph *currentActiveGraph() const;
     bool graphIsEnabled(int row) const;
+    bool loadGraphsFromCache();
 
 private slots:
     void copyFromProfile(QString filename);
@@ -217,6 +221,7 @@ private slots:
 
     void resetAxes();
     void updateStatistics(void);
+    void graphCacheCaptureEvent(CaptureEvent e);
     void copyAsCsvClicked();
 
     void on_intervalComboBox_currentIndexChanged(int index);
@@ -76,6 +76,7 @@ PacketListModel::PacketListModel(QObject *parent, capture_file *cf) :
     Q_ASSERT(glbl_plist_model == Q_NULLPTR);
     glbl_plist_model = this;
     setCaptureFile(cf);
+    invalidateSortCache();
 
     physical_rows_.reserve(reserved_packets_);
     visible_rows_.reserve(reserved_packets_);
@@ -163,6 +164,7 @@ guint PacketListModel::recreateVisibleRows()
 
 void PacketListModel::clear() {
     emit beginResetModel();
+    PacketListRecord::clearColumnCache();
     qDeleteAll(physical_rows_);
     physical_rows_.resize(0);
     visible_rows_.resize(0);
@@ -172,6 +174,7 @@ void PacketListModel::clear() {
     max_row_height_ = 0;
     max_line_count_ = 1;
     idle_dissection_row_ = 0;
+    invalidateSortCache();
 }
 
 void PacketListModel::invalidateAllColumnStrings()
@@ -339,6 +342,7 @@ int PacketListModel::sort_column_is_numeric_;
 int PacketListModel::text_sort_column_;
 Qt::SortOrder PacketListModel::sort_order_;
 capture_file *PacketListModel::sort_cap_file_;
+const QVector<PacketListModel::SortKey> *PacketListModel::sort_model_keys_;
 
 QElapsedTimer busy_timer_;
 const int busy_timeout_ = 65; // ms, approximately 15 fps
@@ -351,6 +355,7 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
     text_sort_column_ = PacketListRecord::textColumn(column);
     sort_order_ = order;
     sort_cap_file_ = cap_file_;
+    sort_model_keys_ = &sort_keys_;
 
     QString col_title = get_column_title(column);
 
@@ -363,7 +368,27 @@ void PacketListModel::sort(int column, Qt::SortOrder order)
 
     busy_timer_.start();
     sort_column_is_numeric_ = isNumericColumn(sort_column_);
-    std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    // Comparisons fetch the column string of every record. Don't let the
+    // column cache evict them while we're sorting.
+    PacketListRecord::holdColumnCache(true);
+
+    unsigned data_ver = PacketListRecord::columnDataVersion();
+    if (column == last_sort_column_ && order != last_sort_order_ &&
+            data_ver == last_sort_data_ver_ && physical_rows_.count() == last_sort_count_) {
+        // Ties are broken by frame number, so the order is total and
+        // flipping the direction is the same as reversing the rows.
+        std::reverse(physical_rows_.begin(), physical_rows_.end());
+    } else {
+        if (text_sort_column_ >= 0 && sort_column_is_numeric_) {
+            buildSortKeys();
+        }
+        std::sort(physical_rows_.begin(), physical_rows_.end(), recordLessThan);
+    }
+    last_sort_column_ = column;
+    last_sort_order_ = order;
+    last_sort_data_ver_ = PacketListRecord::columnDataVersion();
+    last_sort_count_ = static_cast<int>(physical_rows_.count());
+    PacketListRecord::holdColumnCache(false);
 
     emit beginResetModel();
     visible_rows_.resize(0);
@@ -478,15 +503,13 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
         // Column comes directly from frame data
         cmp_val = frame_data_compare(sort_cap_file_->epan, r1->frameData(), r2->frameData(), sort_cap_file_->cinfo.columns[sort_column_].col_fmt);
     } else  {
-        if (r1->columnString(sort_cap_file_, sort_column_).constData() == r2->columnString(sort_cap_file_, sort_column_).constData()) {
-            cmp_val = 0;
-        } else if (sort_column_is_numeric_) {
+        if (sort_column_is_numeric_) {
             // Custom column with numeric data (or something like a port number).
-            // Attempt to convert to numbers.
-            // XXX This is slow. Can we avoid doing this?
-            bool ok_r1, ok_r2;
-            double num_r1 = parseNumericColumn(r1->columnString(sort_cap_file_, sort_column_), &ok_r1);
-            double num_r2 = parseNumericColumn(r2->columnString(sort_cap_file_, sort_column_), &ok_r2);
+            // The keys were parsed up front by buildSortKeys.
+            const SortKey &key_r1 = sort_model_keys_->at(r1->frameData()->num);
+            const SortKey &key_r2 = sort_model_keys_->at(r2->frameData()->num);
+            bool ok_r1 = key_r1.valid, ok_r2 = key_r2.valid;
+            double num_r1 = key_r1.value, num_r2 = key_r2.value;
 
             if (!ok_r1 && !ok_r2) {
                 cmp_val = 0;
@@ -497,6 +520,8 @@ bool PacketListModel::recordLessThan(PacketListRecord *r1, PacketListRecord *r2)
             } else if (!ok_r2 || (num_r1 > num_r2)) {
                 cmp_val = 1;
             }
+        } else if (r1->columnString(sort_cap_file_, sort_column_).constData() == r2->columnString(sort_cap_file_, sort_column_).constData()) {
+            cmp_val = 0;
         } else {
             cmp_val = r1->columnString(sort_cap_file_, sort_column_).compare(r2->columnString(sort_cap_file_, sort_column_));
         }
@@ -527,6 +552,51 @@ double PacketListModel::parseNumericColumn(const QString &val, bool *ok)
     return num;
 }
 
+// Parse the sort column of every record once. The keys are kept until the
+// column strings or the set of records change, so sorting the same column
+// again doesn't have to dissect or parse anything.
+void PacketListModel::buildSortKeys()
+{
+    unsigned data_ver = PacketListRecord::columnDataVersion();
+    int count = static_cast<int>(physical_rows_.count());
+
+    if (sort_keys_column_ == sort_column_ && sort_keys_data_ver_ == data_ver &&
+            sort_keys_count_ == count) {
+        return;
+    }
+
+    int max_num = 0;
+    foreach (PacketListRecord *record, physical_rows_) {
+        max_num = qMax(max_num, (int)record->frameData()->num);
+    }
+    sort_keys_.resize(max_num + 1);
+
+    foreach (PacketListRecord *record, physical_rows_) {
+        if (busy_timer_.elapsed() > busy_timeout_) {
+            wsApp->processEvents(QEventLoop::ExcludeUserInputEvents | QEventLoop::ExcludeSocketNotifiers, 1);
+            busy_timer_.restart();
+        }
+        SortKey &key = sort_keys_[record->frameData()->num];
+        key.value = parseNumericColumn(record->columnString(sort_cap_file_, sort_column_), &key.valid);
+    }
+
+    sort_keys_column_ = sort_column_;
+    sort_keys_data_ver_ = PacketListRecord::columnDataVersion();
+    sort_keys_count_ = count;
+}
+
+void PacketListModel::invalidateSortCache()
+{
+    sort_keys_.clear();
+    sort_keys_column_ = -1;
+    sort_keys_data_ver_ = 0;
+    sort_keys_count_ = 0;
+    last_sort_column_ = -1;
+    last_sort_order_ = Qt::AscendingOrder;
+    last_sort_data_ver_ = 0;
+    last_sort_count_ = 0;
+}
+
 // ::data is const so we have to make changes here.
 void PacketListModel::emitItemHeightChanged(const QModelIndex &ih_index)
 {
@@ -764,6 +834,18 @@ void PacketListModel::ensureRowColorized(int row)
     }
 }
 
+void PacketListModel::setViewportRows(int first, int last)
+{
+    QVector<PacketListRecord *> records;
+
+    first = qMax(first, 0);
+    last = qMin(last, visible_rows_.count() - 1);
+    for (int row = first; row <= last; row++) {
+        records << visible_rows_[row];
+    }
+    PacketListRecord::setVisibleRecords(records);
+}
+
 int PacketListModel::visibleIndexOf(frame_data *fdata) const
 {
     int row = 0;
@@ -51,6 +51,12 @@ public:
     frame_data *getRowFdata(QModelIndex idx);
     frame_data *getRowFdata(int row);
     void ensureRowColorized(int row);
+    /**
+     * @brief Keep the column strings of the rows on screen cached.
+     * @param first The first row in the viewport.
+     * @param last The last row in the viewport.
+     */
+    void setViewportRows(int first, int last);
     int visibleIndexOf(frame_data *fdata) const;
     /**
      * @brief Invalidate any cached column strings.
@@ -101,6 +107,29 @@ private:
     static bool recordLessThan(PacketListRecord *r1, PacketListRecord *r2);
     static double parseNumericColumn(const QString &val, bool *ok);
 
+    // Numeric sort keys, indexed by frame number. Parsing each column
+    // string once up front is much cheaper than parsing both strings in
+    // every comparison.
+    struct SortKey {
+        double value;
+        bool valid;
+    };
+    QVector<SortKey> sort_keys_;
+    // The keys of the model being sorted, for recordLessThan.
+    static const QVector<SortKey> *sort_model_keys_;
+    int sort_keys_column_;
+    unsigned sort_keys_data_ver_;
+    int sort_keys_count_;
+
+    // The most recent sort, used to turn an order toggle into a reverse.
+    int last_sort_column_;
+    Qt::SortOrder last_sort_order_;
+    unsigned last_sort_data_ver_;
+    int last_sort_count_;
+
+    void buildSortKeys();
+    void invalidateSortCache();
+
     QElapsedTimer *idle_dissection_timer_;
     int idle_dissection_row_;
 
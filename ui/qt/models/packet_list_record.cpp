@@ -28,6 +28,17 @@
 QMap<int, int> PacketListRecord::cinfo_column_;
 unsigned PacketListRecord::col_data_ver_ = 1;
 unsigned PacketListRecord::rows_color_ver_ = 1;
+PacketListRecord *PacketListRecord::lru_head_ = NULL;
+PacketListRecord *PacketListRecord::lru_tail_ = NULL;
+int PacketListRecord::cached_record_count_ = 0;
+bool PacketListRecord::hold_column_cache_ = false;
+QSet<PacketListRecord *> PacketListRecord::visible_records_;
+QVector<QSet<QString> > PacketListRecord::col_text_pool_;
+
+// Maximum number of records that keep their column strings around.
+static const int max_cached_records_ = 50000;
+// Maximum number of distinct strings shared per column.
+static const int max_pooled_strings_ = 10000;
 
 PacketListRecord::PacketListRecord(frame_data *frameData) :
     fdata_(frameData),
@@ -37,12 +48,19 @@ PacketListRecord::PacketListRecord(frame_data *frameData) :
     color_ver_(0),
     colorized_(false),
     conv_index_(0),
-    read_failed_(false)
+    read_failed_(false),
+    lru_prev_(NULL),
+    lru_next_(NULL),
+    in_column_cache_(false)
 {
 }
 
 PacketListRecord::~PacketListRecord()
 {
+    if (in_column_cache_) {
+        unlinkColumnCache();
+    }
+    visible_records_.remove(this);
     col_text_.clear();
 }
 
@@ -55,14 +73,12 @@ void PacketListRecord::ensureColorized(capture_file *cap_file)
         return;
     }
 
-    //
-    // XXX - do we need to check whether the data versions match?
-    // If the record's color is already correct, we shouldn't need
-    // to redissect it to colorize it.
-    //
+    // Only colorize here. Column strings are filled in when the row is
+    // drawn, which keeps the background colorization pass from caching
+    // the text of every record in the file.
     bool dissect_color = !colorized_ || ( color_ver_ != rows_color_ver_ );
-    if (data_ver_ != col_data_ver_ || dissect_color) {
-        dissect(cap_file, dissect_color);
+    if (dissect_color) {
+        dissect(cap_file, false, dissect_color);
     }
 }
 
@@ -84,12 +100,105 @@ const QString PacketListRecord::columnString(capture_file *cap_file, int column,
     //
     bool dissect_color = ( colorized && !colorized_ ) || ( color_ver_ != rows_color_ver_ );
     if (column >= col_text_.count() || col_text_.at(column).isNull() || data_ver_ != col_data_ver_ || dissect_color) {
-        dissect(cap_file, dissect_color);
+        dissect(cap_file, col_text_.isEmpty() || data_ver_ != col_data_ver_, dissect_color);
+    } else if (in_column_cache_ && lru_tail_ != this) {
+        // Cache hit. Mark the record as the most recently used.
+        unlinkColumnCache();
+        linkColumnCache();
     }
 
     return col_text_.at(column);
 }
 
+void PacketListRecord::invalidateAllRecords()
+{
+    col_data_ver_++;
+    // Stale strings are released as records are re-dissected.
+    col_text_pool_.clear();
+}
+
+void PacketListRecord::holdColumnCache(bool hold)
+{
+    hold_column_cache_ = hold;
+    trimColumnCache();
+}
+
+void PacketListRecord::setVisibleRecords(const QVector<PacketListRecord *> &records)
+{
+    visible_records_.clear();
+    foreach (PacketListRecord *record, records) {
+        visible_records_.insert(record);
+    }
+}
+
+// Must be called before the cached records are deleted.
+void PacketListRecord::clearColumnCache()
+{
+    PacketListRecord *record = lru_head_;
+
+    while (record) {
+        PacketListRecord *next = record->lru_next_;
+        record->lru_prev_ = record->lru_next_ = NULL;
+        record->in_column_cache_ = false;
+        record = next;
+    }
+    lru_head_ = lru_tail_ = NULL;
+    cached_record_count_ = 0;
+    visible_records_.clear();
+    col_text_pool_.clear();
+}
+
+// Append the record to the cache as its most recently used entry.
+void PacketListRecord::linkColumnCache()
+{
+    lru_prev_ = lru_tail_;
+    lru_next_ = NULL;
+    if (lru_tail_) {
+        lru_tail_->lru_next_ = this;
+    } else {
+        lru_head_ = this;
+    }
+    lru_tail_ = this;
+    in_column_cache_ = true;
+    cached_record_count_++;
+}
+
+void PacketListRecord::unlinkColumnCache()
+{
+    if (lru_prev_) {
+        lru_prev_->lru_next_ = lru_next_;
+    } else {
+        lru_head_ = lru_next_;
+    }
+    if (lru_next_) {
+        lru_next_->lru_prev_ = lru_prev_;
+    } else {
+        lru_tail_ = lru_prev_;
+    }
+    lru_prev_ = lru_next_ = NULL;
+    in_column_cache_ = false;
+    cached_record_count_--;
+}
+
+void PacketListRecord::trimColumnCache()
+{
+    if (hold_column_cache_) {
+        return;
+    }
+
+    // Evict from the least recently used end, skipping records that are
+    // on screen; they'd just be dissected again on the next paint.
+    PacketListRecord *record = lru_head_;
+    while (record && cached_record_count_ > max_cached_records_) {
+        PacketListRecord *next = record->lru_next_;
+        if (!visible_records_.contains(record)) {
+            record->unlinkColumnCache();
+            record->col_text_.clear();
+        }
+        record = next;
+    }
+}
+
 void PacketListRecord::resetColumns(column_info *cinfo)
 {
     invalidateAllRecords();
@@ -108,7 +217,7 @@ void PacketListRecord::resetColumns(column_info *cinfo)
     }
 }
 
-void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
+void PacketListRecord::dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color)
 {
     // packet_list_store.c:packet_list_dissect_and_cache_record
     epan_dissect_t edt;
@@ -117,8 +226,6 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
     wtap_rec rec; /* Record metadata */
     Buffer buf;   /* Record data */
 
-    gboolean dissect_columns = col_text_.isEmpty() || data_ver_ != col_data_ver_;
-
     if (!cap_file) {
         return;
     }
@@ -150,6 +257,7 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
             col_fill_in_error(cinfo, fdata_, FALSE, FALSE /* fill_fd_columns */);
 
             cacheColumnStrings(cinfo);
+            data_ver_ = col_data_ver_;
         }
         if (dissect_color) {
             fdata_->color_filter = NULL;
@@ -200,13 +308,13 @@ void PacketListRecord::dissect(capture_file *cap_file, bool dissect_color)
         /* "Stringify" non frame_data vals */
         epan_dissect_fill_in_columns(&edt, FALSE, FALSE /* fill_fd_columns */);
         cacheColumnStrings(cinfo);
+        data_ver_ = col_data_ver_;
     }
 
     if (dissect_color) {
         colorized_ = true;
         color_ver_ = rows_color_ver_;
     }
-    data_ver_ = col_data_ver_;
 
     struct conversation * conv = find_conversation_pinfo(&edt.pi, 0);
     conv_index_ = ! conv ? 0 : conv->conv_index;
@@ -301,7 +409,7 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
             col_str = QString(cinfo->columns[column].col_data);
         }
 
-        col_text_ << col_str;
+        col_text_ << internColumnString(cinfo, column, col_str);
         col_lines = col_str.count('\n');
         if (col_lines > lines_) {
             lines_ = col_lines;
@@ -309,4 +417,35 @@ void PacketListRecord::cacheColumnStrings(column_info *cinfo)
         }
 #endif // MINIMIZE_STRING_COPYING
     }
+
+    if (in_column_cache_) {
+        unlinkColumnCache();
+    }
+    linkColumnCache();
+    trimColumnCache();
+}
+
+// Protocol, address, port and most custom columns have only a handful of
+// distinct values. Hand out a shared copy of strings we've already seen
+// instead of keeping one per record. Columns that are unique per packet
+// (frame data based columns and Info) are left alone.
+const QString PacketListRecord::internColumnString(column_info *cinfo, int column, const QString &col_str)
+{
+    if (cinfo_column_.value(column, -1) < 0 || cinfo->columns[column].col_fmt == COL_INFO) {
+        return col_str;
+    }
+
+    if (col_text_pool_.count() < cinfo->num_cols) {
+        col_text_pool_.resize(cinfo->num_cols);
+    }
+
+    QSet<QString> &pool = col_text_pool_[column];
+    QSet<QString>::const_iterator it = pool.constFind(col_str);
+    if (it != pool.constEnd()) {
+        return *it;
+    }
+    if (pool.count() < max_pooled_strings_) {
+        pool.insert(col_str);
+    }
+    return col_str;
 }
@@ -21,7 +21,9 @@
 
 #include <QByteArray>
 #include <QList>
+#include <QSet>
 #include <QVariant>
+#include <QVector>
 
 struct conversation;
 struct _GStringChunk;
@@ -43,9 +45,17 @@ public:
     unsigned int conversation() { return conv_index_; }
 
     int columnTextSize(const char *str);
-    static void invalidateAllRecords() { col_data_ver_++; }
+    static void invalidateAllRecords();
+    // Changes whenever cached column strings are invalidated.
+    static unsigned columnDataVersion() { return col_data_ver_; }
     static void resetColumns(column_info *cinfo);
     static void resetColorization() { rows_color_ver_++; }
+    // Column strings are kept for a bounded number of records, least
+    // recently used first out. Records that fall out of the cache are
+    // re-dissected when they're drawn. Records on screen are never evicted.
+    static void holdColumnCache(bool hold);
+    static void setVisibleRecords(const QVector<PacketListRecord *> &records);
+    static void clearColumnCache();
 
     inline int lineCount() { return lines_; }
     inline int lineCountChanged() { return line_count_changed_; }
@@ -72,8 +82,25 @@ private:
 
     bool read_failed_;
 
-    void dissect(capture_file *cap_file, bool dissect_color = false);
+    /** Records holding column strings, least recently used first */
+    static PacketListRecord *lru_head_;
+    static PacketListRecord *lru_tail_;
+    static int cached_record_count_;
+    PacketListRecord *lru_prev_;
+    PacketListRecord *lru_next_;
+    static bool hold_column_cache_;
+    bool in_column_cache_;
+    /** Records in the view's viewport */
+    static QSet<PacketListRecord *> visible_records_;
+    /** Per-column string pools. Used to share repeated column text */
+    static QVector<QSet<QString> > col_text_pool_;
+
+    void dissect(capture_file *cap_file, bool dissect_columns, bool dissect_color = false);
     void cacheColumnStrings(column_info *cinfo);
+    const QString internColumnString(column_info *cinfo, int column, const QString &col_str);
+    void linkColumnCache();
+    void unlinkColumnCache();
+    static void trimColumnCache();
 };
 
 #endif // PACKET_LIST_RECORD_H
@@ -788,6 +788,13 @@ void PacketList::paintEvent(QPaintEvent *event)
     // require a new overlay, e.g. page up/down, scrolling, column
     // resizing, etc.
     create_near_overlay_ = true;
+
+    QModelIndex first_idx = indexAt(viewport()->rect().topLeft());
+    if (first_idx.isValid()) {
+        QModelIndex last_idx = indexAt(viewport()->rect().bottomLeft());
+        packet_list_model_->setViewportRows(first_idx.row(),
+                last_idx.isValid() ? last_idx.row() : packet_list_model_->rowCount() - 1);
+    }
     QTreeView::paintEvent(event);
 }
 
@@ -245,6 +245,7 @@ void ResponseTimeDelayDialog::fillTree()
         reject(); // XXX Stay open instead?
         return;
     }
+    set_rtd_table_mergeable(&rtd_data);
 
     statsTreeWidget()->setSortingEnabled(false);
 
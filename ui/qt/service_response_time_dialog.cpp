@@ -290,6 +290,7 @@ void ServiceResponseTimeDialog::fillTree()
         reject(); // XXX Stay open instead?
         return;
     }
+    set_srt_table_mergeable(&srt_data_);
 
     statsTreeWidget()->setSortingEnabled(false);
 
@@ -2707,6 +2707,41 @@ gboolean wtap_dump_get_needs_reload(wtap_dumper *wdh) {
         return wdh->needs_reload;
 }
 
+/*
+ * Size of the stdio buffer for uncompressed output to a regular file.
+ * Most records are written with several small fwrite() calls, so a large
+ * buffer turns them into few large write() calls.
+ */
+#define DUMP_FILE_IO_BUF_SIZE	(1024 * 1024)
+
+/*
+ * Give an uncompressed output stream a larger buffer than the stdio
+ * default, which is typically only a block in size.
+ */
+static FILE *
+wtap_dump_file_setvbuf(wtap_dumper *wdh, FILE *fh)
+{
+	size_t buffsize = IO_BUF_SIZE;
+	ws_statb64 statb;
+
+	if (fh == NULL)
+		return NULL;
+
+	if (ws_fstat64(ws_fileno(fh), &statb) == 0) {
+		if (S_ISREG(statb.st_mode)) {
+			buffsize = DUMP_FILE_IO_BUF_SIZE;
+		}
+#ifdef HAVE_STRUCT_STAT_ST_BLKSIZE
+		if ((size_t)statb.st_blksize > buffsize) {
+			buffsize = statb.st_blksize;
+		}
+#endif
+	}
+	wdh->io_buffer = (char *)g_malloc(buffsize);
+	setvbuf(fh, wdh->io_buffer, _IOFBF, buffsize);
+	return fh;
+}
+
 /* internally open a file for writing (compressed or not) */
 #ifdef HAVE_ZLIB
 static WFILE_T
@@ -2715,14 +2750,14 @@ wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
 		return gzwfile_open(filename);
 	} else {
-		return ws_fopen(filename, "wb");
+		return wtap_dump_file_setvbuf(wdh, ws_fopen(filename, "wb"));
 	}
 }
 #else
 static WFILE_T
-wtap_dump_file_open(wtap_dumper *wdh _U_, const char *filename)
+wtap_dump_file_open(wtap_dumper *wdh, const char *filename)
 {
-	return ws_fopen(filename, "wb");
+	return wtap_dump_file_setvbuf(wdh, ws_fopen(filename, "wb"));
 }
 #endif
 
@@ -2734,14 +2769,14 @@ wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED) {
 		return gzwfile_fdopen(fd);
 	} else {
-		return ws_fdopen(fd, "wb");
+		return wtap_dump_file_setvbuf(wdh, ws_fdopen(fd, "wb"));
 	}
 }
 #else
 static WFILE_T
-wtap_dump_file_fdopen(wtap_dumper *wdh _U_, int fd)
+wtap_dump_file_fdopen(wtap_dumper *wdh, int fd)
 {
-	return ws_fdopen(fd, "wb");
+	return wtap_dump_file_setvbuf(wdh, ws_fdopen(fd, "wb"));
 }
 #endif
 
@@ -2785,12 +2820,20 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 static int
 wtap_dump_file_close(wtap_dumper *wdh)
 {
+	int ret;
+
 #ifdef HAVE_ZLIB
 	if (wdh->compression_type == WTAP_GZIP_COMPRESSED)
 		return gzwfile_close((GZWFILE_T)wdh->fh);
 	else
 #endif
-		return fclose((FILE *)wdh->fh);
+	{
+		/* The buffer must outlive the stream, which flushes it. */
+		ret = fclose((FILE *)wdh->fh);
+		g_free(wdh->io_buffer);
+		wdh->io_buffer = NULL;
+		return ret;
+	}
 }
 
 gint64
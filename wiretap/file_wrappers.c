@@ -24,6 +24,14 @@
 
 #include <wsutil/file_util.h>
 
+#ifndef _WIN32
+/*
+ * Regular files are read with pread() at our idea of the file position,
+ * so that the descriptor's own position doesn't have to be kept in sync.
+ */
+#define USE_PREAD
+#endif
+
 #ifdef HAVE_ZLIB
 #define ZLIB_CONST
 #include <zlib.h>
@@ -203,6 +211,11 @@ struct wtap_reader {
 #ifdef USE_LZ4
     LZ4F_dctx *lz4_dctx;
 #endif
+#ifdef USE_PREAD
+    gboolean is_regular;        /* TRUE if fd refers to a regular file */
+#endif
+    gboolean raw_bufs_grown;    /* TRUE if the buffers were grown for uncompressed data */
+    gboolean raw_bufs_charged;  /* TRUE if they count against raw_bufs_total */
 };
 
 /* Current read offset within a buffer. */
@@ -266,6 +279,17 @@ buf_read(FILE_T state, struct wtap_reader_buf *buf)
         to_read = space_left;
     }
 
+#ifdef USE_PREAD
+    if (state->is_regular) {
+        /*
+         * Read at raw_pos; if the file has been truncated underneath us,
+         * this just returns 0 (EOF) or fewer bytes than it used to have.
+         */
+        do {
+            ret = pread(state->fd, read_ptr, to_read, (off_t)state->raw_pos);
+        } while (ret < 0 && errno == EINTR);
+    } else
+#endif
     ret = ws_read(state->fd, read_ptr, to_read);
     if (ret < 0) {
         state->err = errno;
@@ -291,6 +315,63 @@ fill_in_buffer(FILE_T state)
     return 0;
 }
 
+/* Use bigger buffers once we know the file is an uncompressed regular
+   file; we then read it straight into the output buffer, and with the
+   default (block-sized) buffers that's a system call for every few
+   packets.  Reading a cached file with pread() took about 60 ms per
+   256 MiB with 4 KiB reads and about 43 ms with 64 KiB reads; 256 KiB
+   reads were no faster than 64 KiB ones.
+
+   Programs such as mergecap keep many files open at once, so the extra
+   memory is limited across all open files; files opened once the limit
+   is reached keep the default buffers. */
+#define RAW_READ_BUF_SIZE	(64U * 1024U)
+#define RAW_READ_BUFS_LIMIT	(4U * 1024U * 1024U)
+
+/* Bytes of grown input and output buffers, over all open files. */
+static gint raw_bufs_total;
+
+static void
+grow_raw_buffers(FILE_T state)
+{
+    guint8 *in_buf, *out_buf;
+    guint out_next;
+
+    if (state->raw_bufs_grown)
+        return;
+    state->raw_bufs_grown = TRUE;
+#ifdef USE_PREAD
+    if (!state->is_regular)
+        return;
+#else
+    return;
+#endif
+    if (state->size >= RAW_READ_BUF_SIZE)
+        return;
+    if ((guint)g_atomic_int_add(&raw_bufs_total, 3 * RAW_READ_BUF_SIZE) +
+        3 * RAW_READ_BUF_SIZE > RAW_READ_BUFS_LIMIT) {
+        g_atomic_int_add(&raw_bufs_total, -(gint)(3 * RAW_READ_BUF_SIZE));
+        return;
+    }
+    state->raw_bufs_charged = TRUE;
+
+    /* The input buffer is empty at this point, but gz_reset() will read
+       into it again if we go back to the beginning of the file. */
+    in_buf = (guint8 *)g_try_realloc(state->in.buf, RAW_READ_BUF_SIZE);
+    if (in_buf == NULL)
+        return;
+    state->in.buf = in_buf;
+    buf_reset(&state->in);
+
+    out_next = offset_in_buffer(&state->out);
+    out_buf = (guint8 *)g_try_realloc(state->out.buf, RAW_READ_BUF_SIZE << 1);
+    if (out_buf == NULL)
+        return;     /* still the old, smaller, size */
+    state->out.buf = out_buf;
+    state->out.next = out_buf + out_next;
+    state->size = RAW_READ_BUF_SIZE;
+}
+
 #define ZLIB_WINSIZE 32768
 
 struct fast_seek_point {
@@ -926,6 +1007,7 @@ gz_head(FILE_T state)
         buf_reset(&state->in);
     }
     state->compression = UNCOMPRESSED;
+    grow_raw_buffers(state);
     return 0;
 }
 
@@ -1081,7 +1163,7 @@ file_fdopen(int fd)
      * being 8K, or APFS, where st_blksize is big on at least some
      * versions of macOS).
      */
-#ifdef _STATBUF_ST_BLKSIZE
+#if defined(_STATBUF_ST_BLKSIZE) || defined(USE_PREAD)
     ws_statb64 st;
 #endif
 #ifdef HAVE_ZSTD
@@ -1116,6 +1198,10 @@ file_fdopen(int fd)
     if (state->start == -1) state->start = 0;
     state->raw_pos = state->start;
 
+#ifdef USE_PREAD
+    state->is_regular = ws_fstat64(fd, &st) >= 0 && S_ISREG(st.st_mode);
+#endif
+
     /* initialize stream */
     gz_reset(state);
 
@@ -1514,7 +1600,7 @@ file_seek(FILE_T file, gint64 offset, int whence, int *err)
         /*
          * Yes.  Just seek there within the file.
          */
-        if (ws_lseek64(file->fd, offset - file->out.avail, SEEK_CUR) == -1) {
+        if (ws_lseek64(file->fd, file->raw_pos + offset - file->out.avail, SEEK_SET) == -1) {
             *err = errno;
             return -1;
         }
@@ -1919,6 +2005,8 @@ file_close(FILE_T file)
         g_free(file->out.buf);
         g_free(file->in.buf);
     }
+    if (file->raw_bufs_charged)
+        g_atomic_int_add(&raw_bufs_total, -(gint)(3 * RAW_READ_BUF_SIZE));
     g_free(file->fast_seek_cur);
     file->err = 0;
     file->err_info = NULL;
@@ -0,0 +1,355 @@
+/* frame_index.c
+ * Routines for reading and writing sidecar frame index files.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#define WS_LOG_DOMAIN LOG_DOMAIN_WIRETAP
+
+#include <errno.h>
+#include <string.h>
+
+#include "frame_index.h"
+#include "wtap-int.h"
+
+#include <wsutil/file_util.h>
+#include <wsutil/pint.h>
+#include <wsutil/wslog.h>
+
+/*
+ * File format; all values are little-endian.
+ *
+ * Header:
+ *
+ *    magic            8 bytes, "WSFRMIDX"
+ *    version          4 bytes
+ *    num_shbs         4 bytes, section headers in the capture file
+ *    file_size        8 bytes, size of the capture file
+ *    file_mtime       8 bytes, modification time of the capture file
+ *    num_idbs         4 bytes, interface descriptions in the capture file
+ *    file_mtime_nsecs 4 bytes, nanoseconds of the modification time, or 0
+ *                     if the platform doesn't provide them
+ *    num_entries      8 bytes
+ *
+ * followed by num_entries entries of:
+ *
+ *    offset           8 bytes
+ *    ts.secs          8 bytes
+ *    ts.nsecs         4 bytes
+ *    caplen           4 bytes
+ *    len              4 bytes
+ *    interface_id     4 bytes
+ *    presence_flags   4 bytes
+ *    rec_type         4 bytes
+ *
+ * The size and modification time are those the capture file had before
+ * any of its records were read, so that records appended while it was
+ * being read make the index out of date rather than silently missing.
+ */
+#define FRAME_INDEX_MAGIC       "WSFRMIDX"
+#define FRAME_INDEX_MAGIC_LEN   8
+#define FRAME_INDEX_VERSION     2
+#define FRAME_INDEX_HEADER_LEN  48
+#define FRAME_INDEX_ENTRY_LEN   40
+
+struct wtap_frame_index {
+    GArray *entries;            /* of wtap_frame_index_entry_t */
+    guint64 file_size;          /* capture file size, before reading it */
+    guint64 file_mtime;         /* and its modification time */
+    guint32 file_mtime_nsecs;
+};
+
+static void
+frame_index_get_mtime(const ws_statb64 *statb, guint64 *secs, guint32 *nsecs)
+{
+    *secs = (guint64)statb->st_mtime;
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+    *nsecs = (guint32)statb->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    *nsecs = (guint32)statb->st_mtimespec.tv_nsec;
+#else
+    *nsecs = 0;
+#endif
+}
+
+wtap_frame_index_t *
+wtap_frame_index_new(const char *capture_filename, int *err)
+{
+    ws_statb64 statb;
+    wtap_frame_index_t *idx;
+
+    if (ws_stat64(capture_filename, &statb) != 0) {
+        *err = errno;
+        return NULL;
+    }
+
+    idx = g_new(wtap_frame_index_t, 1);
+    idx->entries = g_array_new(FALSE, FALSE, sizeof(wtap_frame_index_entry_t));
+    idx->file_size = (guint64)statb.st_size;
+    frame_index_get_mtime(&statb, &idx->file_mtime, &idx->file_mtime_nsecs);
+    return idx;
+}
+
+void
+wtap_frame_index_add(wtap_frame_index_t *idx, const wtap_rec *rec,
+    gint64 offset)
+{
+    wtap_frame_index_entry_t entry;
+
+    entry.offset = offset;
+    entry.presence_flags = rec->presence_flags;
+    entry.rec_type = rec->rec_type;
+    if (rec->presence_flags & WTAP_HAS_TS)
+        entry.ts = rec->ts;
+    else
+        nstime_set_unset(&entry.ts);
+    entry.caplen = rec->rec_header.packet_header.caplen;
+    entry.len = rec->rec_header.packet_header.len;
+    entry.interface_id = rec->rec_header.packet_header.interface_id;
+    if (rec->rec_type != REC_TYPE_PACKET) {
+        /*
+         * Other record types keep their lengths elsewhere; we don't
+         * need them to find or sort the record, so don't bother.
+         */
+        entry.caplen = 0;
+        entry.len = 0;
+        entry.interface_id = 0;
+        entry.presence_flags &= ~(WTAP_HAS_CAP_LEN|WTAP_HAS_INTERFACE_ID);
+    }
+    g_array_append_val(idx->entries, entry);
+}
+
+guint
+wtap_frame_index_count(const wtap_frame_index_t *idx)
+{
+    return idx->entries->len;
+}
+
+const wtap_frame_index_entry_t *
+wtap_frame_index_get(const wtap_frame_index_t *idx, guint n)
+{
+    if (n >= idx->entries->len)
+        return NULL;
+    return &g_array_index(idx->entries, wtap_frame_index_entry_t, n);
+}
+
+char *
+wtap_frame_index_filename(const char *capture_filename)
+{
+    return g_strconcat(capture_filename, WTAP_FRAME_INDEX_EXTENSION, NULL);
+}
+
+static guint
+frame_index_num_idbs(wtap *wth)
+{
+    return wth->interface_data ? wth->interface_data->len : 0;
+}
+
+gboolean
+wtap_frame_index_save(const wtap_frame_index_t *idx, wtap *wth,
+    const char *capture_filename, int *err)
+{
+    ws_statb64 statb;
+    guint64 mtime;
+    guint32 mtime_nsecs;
+    char *index_filename;
+    FILE *fh;
+    guint8 hdr[FRAME_INDEX_HEADER_LEN];
+    guint8 ent[FRAME_INDEX_ENTRY_LEN];
+    guint i;
+
+    if (ws_stat64(capture_filename, &statb) != 0) {
+        *err = errno;
+        return FALSE;
+    }
+
+    index_filename = wtap_frame_index_filename(capture_filename);
+
+    /*
+     * If the file changed while we were reading it, the index might
+     * not have all of its records; don't leave an index, old or new,
+     * that claims to describe it.
+     */
+    frame_index_get_mtime(&statb, &mtime, &mtime_nsecs);
+    if ((guint64)statb.st_size != idx->file_size ||
+        mtime != idx->file_mtime || mtime_nsecs != idx->file_mtime_nsecs) {
+        ws_debug("%s: file changed while being read, not writing a frame index",
+                 capture_filename);
+        ws_unlink(index_filename);
+        g_free(index_filename);
+        return TRUE;
+    }
+
+    fh = ws_fopen(index_filename, "wb");
+    if (fh == NULL) {
+        *err = errno;
+        g_free(index_filename);
+        return FALSE;
+    }
+
+    memcpy(hdr, FRAME_INDEX_MAGIC, FRAME_INDEX_MAGIC_LEN);
+    phtole32(&hdr[8], FRAME_INDEX_VERSION);
+    phtole32(&hdr[12], wtap_file_get_num_shbs(wth));
+    phtole64(&hdr[16], idx->file_size);
+    phtole64(&hdr[24], idx->file_mtime);
+    phtole32(&hdr[32], frame_index_num_idbs(wth));
+    phtole32(&hdr[36], idx->file_mtime_nsecs);
+    phtole64(&hdr[40], idx->entries->len);
+    if (fwrite(hdr, sizeof hdr, 1, fh) != 1)
+        goto write_error;
+
+    for (i = 0; i < idx->entries->len; i++) {
+        const wtap_frame_index_entry_t *entry =
+            &g_array_index(idx->entries, wtap_frame_index_entry_t, i);
+
+        phtole64(&ent[0], (guint64)entry->offset);
+        phtole64(&ent[8], (guint64)entry->ts.secs);
+        phtole32(&ent[16], (guint32)entry->ts.nsecs);
+        phtole32(&ent[20], entry->caplen);
+        phtole32(&ent[24], entry->len);
+        phtole32(&ent[28], entry->interface_id);
+        phtole32(&ent[32], entry->presence_flags);
+        phtole32(&ent[36], entry->rec_type);
+        if (fwrite(ent, sizeof ent, 1, fh) != 1)
+            goto write_error;
+    }
+
+    if (fclose(fh) != 0) {
+        *err = errno;
+        ws_unlink(index_filename);
+        g_free(index_filename);
+        return FALSE;
+    }
+    g_free(index_filename);
+    return TRUE;
+
+write_error:
+    *err = errno;
+    fclose(fh);
+    ws_unlink(index_filename);
+    g_free(index_filename);
+    return FALSE;
+}
+
+wtap_frame_index_t *
+wtap_frame_index_load(wtap *wth, const char *capture_filename)
+{
+    ws_statb64 statb;
+    guint64 mtime;
+    guint32 mtime_nsecs;
+    char *index_filename;
+    FILE *fh;
+    guint8 hdr[FRAME_INDEX_HEADER_LEN];
+    guint8 ent[FRAME_INDEX_ENTRY_LEN];
+    guint64 num_entries, i;
+    wtap_frame_index_t *idx;
+
+    /*
+     * Seeking to arbitrary records in a compressed file without
+     * having read through it first is slow, so don't bother.
+     */
+    if (wtap_get_compression_type(wth) != WTAP_UNCOMPRESSED)
+        return NULL;
+
+    if (ws_stat64(capture_filename, &statb) != 0)
+        return NULL;
+
+    index_filename = wtap_frame_index_filename(capture_filename);
+    fh = ws_fopen(index_filename, "rb");
+    g_free(index_filename);
+    if (fh == NULL)
+        return NULL;
+
+    if (fread(hdr, sizeof hdr, 1, fh) != 1 ||
+        memcmp(hdr, FRAME_INDEX_MAGIC, FRAME_INDEX_MAGIC_LEN) != 0 ||
+        pletoh32(&hdr[8]) != FRAME_INDEX_VERSION) {
+        ws_debug("%s: not a frame index we understand", capture_filename);
+        fclose(fh);
+        return NULL;
+    }
+    frame_index_get_mtime(&statb, &mtime, &mtime_nsecs);
+    if (pletoh64(&hdr[16]) != (guint64)statb.st_size ||
+        pletoh64(&hdr[24]) != mtime ||
+        pletoh32(&hdr[36]) != mtime_nsecs) {
+        ws_debug("%s: frame index is out of date", capture_filename);
+        fclose(fh);
+        return NULL;
+    }
+    /*
+     * If there are section headers or interface descriptions that
+     * we'd only see by reading through the file, the reader can't
+     * interpret records after them by seeking directly to them.
+     */
+    if (pletoh32(&hdr[12]) != wtap_file_get_num_shbs(wth) ||
+        pletoh32(&hdr[32]) != frame_index_num_idbs(wth)) {
+        ws_debug("%s: file has blocks after the first record, not using the frame index",
+                 capture_filename);
+        fclose(fh);
+        return NULL;
+    }
+
+    num_entries = pletoh64(&hdr[40]);
+    if (num_entries > G_MAXUINT ||
+        num_entries > (guint64)statb.st_size) {
+        /* Every record takes at least one byte of the capture file. */
+        fclose(fh);
+        return NULL;
+    }
+
+    idx = g_new(wtap_frame_index_t, 1);
+    idx->entries = g_array_sized_new(FALSE, FALSE,
+        sizeof(wtap_frame_index_entry_t), (guint)num_entries);
+    idx->file_size = (guint64)statb.st_size;
+    idx->file_mtime = mtime;
+    idx->file_mtime_nsecs = mtime_nsecs;
+    for (i = 0; i < num_entries; i++) {
+        wtap_frame_index_entry_t entry;
+
+        if (fread(ent, sizeof ent, 1, fh) != 1) {
+            ws_debug("%s: frame index is truncated", capture_filename);
+            wtap_frame_index_free(idx);
+            fclose(fh);
+            return NULL;
+        }
+        entry.offset = (gint64)pletoh64(&ent[0]);
+        entry.ts.secs = (time_t)pletoh64(&ent[8]);
+        entry.ts.nsecs = (int)pletoh32(&ent[16]);
+        entry.caplen = pletoh32(&ent[20]);
+        entry.len = pletoh32(&ent[24]);
+        entry.interface_id = pletoh32(&ent[28]);
+        entry.presence_flags = pletoh32(&ent[32]);
+        entry.rec_type = pletoh32(&ent[36]);
+        g_array_append_val(idx->entries, entry);
+    }
+    fclose(fh);
+
+    return idx;
+}
+
+void
+wtap_frame_index_free(wtap_frame_index_t *idx)
+{
+    if (idx == NULL)
+        return;
+    g_array_free(idx->entries, TRUE);
+    g_free(idx);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
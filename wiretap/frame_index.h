@@ -0,0 +1,152 @@
+/** @file
+ *
+ * Sidecar frame index files.
+ *
+ * A frame index records, for every record in a capture file, where the
+ * record starts and the metadata needed to count, sort or seek to it
+ * without reading it.  It's stored in a separate file next to the
+ * capture file, and is only used if the capture file still has the
+ * size and modification time it had when the index was written.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __FRAME_INDEX_H__
+#define __FRAME_INDEX_H__
+
+#include "wiretap/wtap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** Extension appended to a capture file name to get its index file name. */
+#define WTAP_FRAME_INDEX_EXTENSION ".frameindex"
+
+/** One record of a capture file. */
+typedef struct {
+    gint64   offset;            /**< Offset to pass to wtap_seek_read() */
+    nstime_t ts;                /**< Time stamp, if WTAP_HAS_TS is set */
+    guint32  caplen;            /**< Captured length, if WTAP_HAS_CAP_LEN is set */
+    guint32  len;               /**< Original length */
+    guint32  interface_id;      /**< Interface ID, if WTAP_HAS_INTERFACE_ID is set */
+    guint32  presence_flags;    /**< WTAP_HAS_ flags of the record */
+    guint    rec_type;          /**< REC_TYPE_ value of the record */
+} wtap_frame_index_entry_t;
+
+typedef struct wtap_frame_index wtap_frame_index_t;
+
+/**
+ * @brief Create an empty frame index for a capture file.
+ *
+ * This notes the size and modification time of the capture file, so it
+ * should be called before any records are read from it.
+ *
+ * @param capture_filename The name of the capture file.
+ * @param[out] err Set to an errno value on failure.
+ * @return The frame index, or NULL if the capture file can't be stat'ed.
+ */
+WS_DLL_PUBLIC
+wtap_frame_index_t *wtap_frame_index_new(const char *capture_filename,
+    int *err);
+
+/**
+ * @brief Append a record, as returned by wtap_read(), to a frame index.
+ *
+ * @param idx The frame index.
+ * @param rec The record.
+ * @param offset The data offset returned by wtap_read().
+ */
+WS_DLL_PUBLIC
+void wtap_frame_index_add(wtap_frame_index_t *idx, const wtap_rec *rec,
+    gint64 offset);
+
+/**
+ * @brief Get the number of records in a frame index.
+ */
+WS_DLL_PUBLIC
+guint wtap_frame_index_count(const wtap_frame_index_t *idx);
+
+/**
+ * @brief Get a record from a frame index.
+ *
+ * @param idx The frame index.
+ * @param n The record number, starting at 0.
+ * @return The record, or NULL if n is out of range.
+ */
+WS_DLL_PUBLIC
+const wtap_frame_index_entry_t *wtap_frame_index_get(const wtap_frame_index_t *idx,
+    guint n);
+
+/**
+ * @brief Get the name of the index file for a capture file.
+ *
+ * @return A newly allocated string, to be freed with g_free().
+ */
+WS_DLL_PUBLIC
+char *wtap_frame_index_filename(const char *capture_filename);
+
+/**
+ * @brief Write a frame index for a capture file.
+ *
+ * All the records of the capture file should have been read with
+ * wtap_read(), and added to the index, before this is called.  If the
+ * capture file's size or modification time changed since the index was
+ * created, no index is written, and any existing one is removed.
+ *
+ * @param idx The frame index.
+ * @param wth The wtap from which the records were read.
+ * @param capture_filename The name of the capture file.
+ * @param[out] err Set to an errno value on failure.
+ * @return TRUE on success, FALSE on failure.
+ */
+WS_DLL_PUBLIC
+gboolean wtap_frame_index_save(const wtap_frame_index_t *idx, wtap *wth,
+    const char *capture_filename, int *err);
+
+/**
+ * @brief Read the frame index for a capture file, if it has a usable one.
+ *
+ * The index is only used if it matches the current size and modification
+ * time (to the nanosecond, where the platform provides it) of the capture
+ * file, and if all the section headers and interface
+ * descriptions the records refer to were available as soon as the file
+ * was opened, so that wtap_seek_read() can be used on any record without
+ * reading the records before it.
+ *
+ * @param wth The wtap for the capture file, just opened.
+ * @param capture_filename The name of the capture file.
+ * @return The frame index, or NULL if there's no usable index.
+ */
+WS_DLL_PUBLIC
+wtap_frame_index_t *wtap_frame_index_load(wtap *wth,
+    const char *capture_filename);
+
+/**
+ * @brief Free a frame index.
+ */
+WS_DLL_PUBLIC
+void wtap_frame_index_free(wtap_frame_index_t *idx);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FRAME_INDEX_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
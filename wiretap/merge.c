@@ -204,21 +204,129 @@ merge_select_frame_type(int in_file_count, merge_in_file_t in_files[])
 }
 
 /*
- * returns TRUE if first argument is earlier than second
+ * The input files that have a record available, kept as a binary heap
+ * ordered by the time stamp of that record, so that finding the next
+ * record to write is O(log n) rather than O(n) in the number of input
+ * files; that matters when merging thousands of ring buffer files.
+ */
+typedef struct {
+    merge_in_file_t *in_files;
+    guint            in_file_count;
+    guint           *heap;          /* indices into in_files */
+    guint            heap_len;
+    gboolean         filled;        /* has every file been read from yet? */
+    int              last;          /* file whose record was returned last, or -1 */
+} merge_heap_t;
+
+static void
+merge_heap_init(merge_heap_t *mh, merge_in_file_t *in_files, const guint in_file_count)
+{
+    mh->in_files      = in_files;
+    mh->in_file_count = in_file_count;
+    mh->heap          = g_new(guint, in_file_count);
+    mh->heap_len      = 0;
+    mh->filled        = FALSE;
+    mh->last          = -1;
+}
+
+static void
+merge_heap_cleanup(merge_heap_t *mh)
+{
+    g_free(mh->heap);
+    mh->heap = NULL;
+}
+
+/*
+ * Returns TRUE if the record available from file a is to be written
+ * before the one from file b.
+ *
+ * Records with no time stamp come before all other records.  Yes, this
+ * means you won't get a chronological merge of those records, but you
+ * obviously *can't* get that.  Ties are broken the same way the old
+ * linear scan over the files did: records without a time stamp from the
+ * first such file, records with equal time stamps from the last file.
  */
 static gboolean
-is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
+merge_heap_before(const merge_heap_t *mh, guint a, guint b)
 {
-    if (l->secs > r->secs) {  /* left is later */
-        return FALSE;
-    } else if (l->secs < r->secs) { /* left is earlier */
+    const wtap_rec *ra = &mh->in_files[a].rec;
+    const wtap_rec *rb = &mh->in_files[b].rec;
+    gboolean a_has_ts = (ra->presence_flags & WTAP_HAS_TS) != 0;
+    gboolean b_has_ts = (rb->presence_flags & WTAP_HAS_TS) != 0;
+
+    if (!a_has_ts || !b_has_ts) {
+        if (a_has_ts != b_has_ts)
+            return !a_has_ts;
+        return a < b;
+    }
+    if (ra->ts.secs != rb->ts.secs)
+        return ra->ts.secs < rb->ts.secs;
+    if (ra->ts.nsecs != rb->ts.nsecs)
+        return ra->ts.nsecs < rb->ts.nsecs;
+    return a > b;
+}
+
+static void
+merge_heap_push(merge_heap_t *mh, guint file)
+{
+    guint pos = mh->heap_len++;
+
+    while (pos > 0) {
+        guint parent = (pos - 1) / 2;
+        if (!merge_heap_before(mh, file, mh->heap[parent]))
+            break;
+        mh->heap[pos] = mh->heap[parent];
+        pos = parent;
+    }
+    mh->heap[pos] = file;
+}
+
+static guint
+merge_heap_pop(merge_heap_t *mh)
+{
+    guint top = mh->heap[0];
+    guint file = mh->heap[--mh->heap_len];
+    guint pos = 0;
+
+    for (;;) {
+        guint child = 2 * pos + 1;
+        if (child >= mh->heap_len)
+            break;
+        if (child + 1 < mh->heap_len &&
+            merge_heap_before(mh, mh->heap[child + 1], mh->heap[child]))
+            child++;
+        if (!merge_heap_before(mh, mh->heap[child], file))
+            break;
+        mh->heap[pos] = mh->heap[child];
+        pos = child;
+    }
+    if (mh->heap_len > 0)
+        mh->heap[pos] = file;
+
+    return top;
+}
+
+/*
+ * Read the next record from a file and, if there is one, put the file
+ * on the heap.  Returns FALSE on a read error.
+ */
+static gboolean
+merge_heap_read(merge_heap_t *mh, guint file, int *err, gchar **err_info)
+{
+    merge_in_file_t *in_file = &mh->in_files[file];
+    gint64 data_offset;
+
+    if (!wtap_read(in_file->wth, &in_file->rec, &in_file->frame_buffer,
+                   err, err_info, &data_offset)) {
+        if (*err != 0) {
+            in_file->state = GOT_ERROR;
+            return FALSE;
+        }
+        in_file->state = AT_EOF;
         return TRUE;
-    } else if (l->nsecs > r->nsecs) { /* tv_sec equal, l.usec later */
-        return FALSE;
     }
-    /* either one < two or one == two
-     * either way, return one
-     */
+    in_file->state = RECORD_PRESENT;
+    merge_heap_push(mh, file);
     return TRUE;
 }
 
@@ -234,8 +342,7 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * On an EOF (meaning all the files are at EOF), set *err to 0 and return
  * NULL.
  *
- * @param in_file_count number of entries in in_files
- * @param in_files input file array
+ * @param mh heap of the input files
  * @param err wiretap error, if failed
  * @param err_info wiretap error string, if failed
  * @return pointer to merge_in_file_t for file from which that packet
@@ -243,80 +350,49 @@ is_earlier(nstime_t *l, nstime_t *r) /* XXX, move to nstime.c */
  * all files
  */
 static merge_in_file_t *
-merge_read_packet(int in_file_count, merge_in_file_t in_files[],
-                  int *err, gchar **err_info)
+merge_read_packet(merge_heap_t *mh, int *err, gchar **err_info)
 {
-    int i;
-    int ei = -1;
-    nstime_t tv = NSTIME_INIT_MAX;
-    wtap_rec *rec;
+    guint i;
+    guint ei;
 
     /*
      * Make sure we have a record available from each file that's not at
-     * EOF, and search for the record with the earliest time stamp or
-     * with no time stamp (those records are treated as earlier than
-     * all other records).  Yes, this means you won't get a chronological
-     * merge of those records, but you obviously *can't* get that.
+     * EOF.  Only the file we returned a record from last time needs a
+     * new one, except on the first call, when all of them do.
      */
-    for (i = 0; i < in_file_count; i++) {
-        gint64 data_offset;
-
-        if (in_files[i].state == RECORD_NOT_PRESENT) {
-            /*
-             * No packet available, and we haven't seen an error or EOF yet,
-             * so try to read the next packet.
-             */
-            if (!wtap_read(in_files[i].wth, &in_files[i].rec,
-                           &in_files[i].frame_buffer, err, err_info,
-                           &data_offset)) {
-                if (*err != 0) {
-                    in_files[i].state = GOT_ERROR;
-                    return &in_files[i];
-                }
-                in_files[i].state = AT_EOF;
-            } else
-                in_files[i].state = RECORD_PRESENT;
-        }
-
-        if (in_files[i].state == RECORD_PRESENT) {
-            rec = &in_files[i].rec;
-            if (!(rec->presence_flags & WTAP_HAS_TS)) {
-                /*
-                 * No time stamp.  Pick this record, and stop looking.
-                 */
-                ei = i;
-                break;
-            }
-            if (is_earlier(&rec->ts, &tv)) {
-                /*
-                 * This record's time stamp is earlier than any of the
-                 * records we've seen so far.  Pick it, for now, but
-                 * keep looking.
-                 */
-                tv = rec->ts;
-                ei = i;
-            }
+    if (!mh->filled) {
+        for (i = 0; i < mh->in_file_count; i++) {
+            if (!merge_heap_read(mh, i, err, err_info))
+                return &mh->in_files[i];
         }
+        mh->filled = TRUE;
+    } else if (mh->last != -1) {
+        if (!merge_heap_read(mh, (guint)mh->last, err, err_info))
+            return &mh->in_files[mh->last];
     }
 
-    if (ei == -1) {
+    if (mh->heap_len == 0) {
         /* All the streams are at EOF.  Return an EOF indication. */
+        mh->last = -1;
         *err = 0;
         return NULL;
     }
 
+    ei = merge_heap_pop(mh);
+    mh->last = (int)ei;
+
     /* We'll need to read another packet from this file. */
-    in_files[ei].state = RECORD_NOT_PRESENT;
+    mh->in_files[ei].state = RECORD_NOT_PRESENT;
 
     /* Count this packet. */
-    in_files[ei].packet_num++;
+    mh->in_files[ei].packet_num++;
 
     /*
      * Return a pointer to the merge_in_file_t of the file from which the
      * packet was read.
      */
     *err = 0;
-    return &in_files[ei];
+    return &mh->in_files[ei];
 }
 
 /** Read the next packet, in file sequence order, from the set of files
@@ -848,6 +924,9 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
     int                 count = 0;
     gboolean            stop_flag = FALSE;
     wtap_rec *rec,      snap_rec;
+    merge_heap_t        mh;
+
+    merge_heap_init(&mh, in_files, in_file_count);
 
     for (;;) {
         *err = 0;
@@ -857,8 +936,7 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
                                                err_info);
         }
         else {
-            in_file = merge_read_packet(in_file_count, in_files, err,
-                                        err_info);
+            in_file = merge_read_packet(&mh, err, err_info);
         }
 
         if (in_file == NULL) {
@@ -948,6 +1026,8 @@ merge_process_packets(wtap_dumper *pdh, const int file_type,
         wtap_rec_reset(rec);
     }
 
+    merge_heap_cleanup(&mh);
+
     if (cb)
         cb->callback_func(MERGE_EVENT_DONE, count, in_files, in_file_count, cb->data);
 
@@ -4781,6 +4781,8 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     const union wtap_pseudo_header *pseudo_header = &rec->rec_header.packet_header.pseudo_header;
     pcapng_block_header_t bh;
     pcapng_enhanced_packet_block_t epb;
+    guint8 hdr_buf[sizeof bh + sizeof epb];
+    guint8 trailer_buf[3 + sizeof bh.block_total_length];
     guint32 options_size = 0;
     guint64 ts;
     const guint32 zero_pad = 0;
@@ -4812,11 +4814,7 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     bh.block_type = BLOCK_TYPE_EPB;
     bh.block_total_length = (guint32)sizeof(bh) + (guint32)sizeof(epb) + phdr_len + rec->rec_header.packet_header.caplen + pad_len + options_total_length + options_size + 4;
 
-    if (!wtap_dump_file_write(wdh, &bh, sizeof bh, err))
-        return FALSE;
-    wdh->bytes_dumped += sizeof bh;
-
-    /* write block fixed content */
+    /* fill in block fixed content */
     if (rec->presence_flags & WTAP_HAS_INTERFACE_ID)
         epb.interface_id        = rec->rec_header.packet_header.interface_id;
     else {
@@ -4861,9 +4859,15 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
     epb.captured_len        = rec->rec_header.packet_header.caplen + phdr_len;
     epb.packet_len          = rec->rec_header.packet_header.len + phdr_len;
 
-    if (!wtap_dump_file_write(wdh, &epb, sizeof epb, err))
+    /*
+     * This is called for every packet, so write the block header and
+     * the fixed content with one call rather than two.
+     */
+    memcpy(hdr_buf, &bh, sizeof bh);
+    memcpy(hdr_buf + sizeof bh, &epb, sizeof epb);
+    if (!wtap_dump_file_write(wdh, hdr_buf, sizeof hdr_buf, err))
         return FALSE;
-    wdh->bytes_dumped += sizeof epb;
+    wdh->bytes_dumped += sizeof hdr_buf;
 
     /* write pseudo header */
     if (!pcap_write_phdr(wdh, rec->rec_header.packet_header.pkt_encap, pseudo_header, err)) {
@@ -4876,6 +4880,21 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
         return FALSE;
     wdh->bytes_dumped += rec->rec_header.packet_header.caplen;
 
+    /*
+     * If we have no options, write the padding and the block footer
+     * with one call.
+     */
+    if (options_size == 0) {
+        memset(trailer_buf, 0, pad_len);
+        memcpy(trailer_buf + pad_len, &bh.block_total_length,
+               sizeof bh.block_total_length);
+        if (!wtap_dump_file_write(wdh, trailer_buf,
+                                  pad_len + sizeof bh.block_total_length, err))
+            return FALSE;
+        wdh->bytes_dumped += pad_len + sizeof bh.block_total_length;
+        return TRUE;
+    }
+
     /* write padding (if any) */
     if (pad_len != 0) {
         if (!wtap_dump_file_write(wdh, &zero_pad, pad_len, err))
@@ -4883,11 +4902,9 @@ pcapng_write_enhanced_packet_block(wtap_dumper *wdh, const wtap_rec *rec,
         wdh->bytes_dumped += pad_len;
     }
 
-    /* Write options, if we have any */
-    if (options_size != 0) {
-        if (!write_options(wdh, rec->block, write_wtap_epb_option, err))
-            return FALSE;
-    }
+    /* Write options */
+    if (!write_options(wdh, rec->block, write_wtap_epb_option, err))
+        return FALSE;
 
     /* write block footer */
     if (!wtap_dump_file_write(wdh, &bh.block_total_length,
@@ -94,6 +94,7 @@ typedef gboolean (*subtype_finish_func)(struct wtap_dumper*, int*, gchar**);
 
 struct wtap_dumper {
     WFILE_T                 fh;
+    char                    *io_buffer;      /* stdio buffer for uncompressed output, or NULL */
     int                     file_type_subtype;
     int                     snaplen;
     int                     encap;
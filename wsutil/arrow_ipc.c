@@ -0,0 +1,805 @@
+/* arrow_ipc.c
+ * Routines for writing tables in the Apache Arrow IPC streaming format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_WSUTIL
+
+#include "arrow_ipc.h"
+
+#include <string.h>
+
+#include <wsutil/ws_assert.h>
+#include <wsutil/wslog.h>
+
+/*
+ * Constants from the Arrow format definitions, Schema.fbs and Message.fbs
+ * in https://github.com/apache/arrow/tree/main/format
+ */
+#define ARROW_METADATA_V5           4
+
+#define ARROW_HEADER_SCHEMA         1
+#define ARROW_HEADER_DICTIONARY     2
+#define ARROW_HEADER_RECORD_BATCH   3
+
+#define ARROW_TYPE_ID_INT           2
+#define ARROW_TYPE_ID_FLOAT         3
+#define ARROW_TYPE_ID_BINARY        4
+#define ARROW_TYPE_ID_UTF8          5
+#define ARROW_TYPE_ID_BOOL          6
+#define ARROW_TYPE_ID_TIMESTAMP     10
+#define ARROW_TYPE_ID_FIXED_BINARY  15
+#define ARROW_TYPE_ID_DURATION      18
+
+#define ARROW_PRECISION_DOUBLE      2
+#define ARROW_TIME_UNIT_NANOSECOND  3
+
+#define ARROW_DEFAULT_BATCH_ROWS    65536
+/* Start over with a new dictionary once a column has this many entries. */
+#define ARROW_MAX_DICTIONARY_SIZE   (1 << 20)
+
+typedef struct {
+    char           *name;
+    arrow_type_e    type;
+    guint           width;          /* byte width of fixed size binary values */
+    GByteArray     *validity;
+    GByteArray     *values;         /* values, bitmap, offsets or indices */
+    GByteArray     *data;           /* variable size binary data */
+    guint           null_count;
+    gboolean        is_set;         /* set in the current row */
+    /* String dictionary */
+    GHashTable     *dict;           /* string -> index + 1 */
+    guint           dict_size;
+    GByteArray     *dict_offsets;   /* entries not written yet */
+    GByteArray     *dict_data;
+    gboolean        dict_written;   /* FALSE if the next dictionary batch replaces the dictionary */
+} arrow_column;
+
+struct arrow_writer {
+    FILE           *fh;
+    guint           batch_rows;
+    GPtrArray      *columns;
+    guint           rows;           /* rows in the current batch */
+    gboolean        schema_written;
+    gboolean        error;
+};
+
+/*
+ * A minimal FlatBuffers (https://flatbuffers.dev/) builder for the Arrow
+ * metadata. The buffer is built front to back: a table's vtable is written
+ * right before the table and the objects it refers to are written after
+ * it, after which their offsets are linked in.
+ */
+typedef struct {
+    guint8      size;       /* 0 if absent, otherwise 1, 2, 4 or 8 */
+    gboolean    is_offset;
+    guint64     value;
+} fb_field;
+
+#define FB_MAX_FIELDS   8
+
+/* Pads the buffer so that (len + extra) is a multiple of align. */
+static void
+fb_align(GByteArray *fb, guint align, guint extra)
+{
+    static const guint8 zeros[8];
+
+    g_byte_array_append(fb, zeros, (align - (fb->len + extra) % align) % align);
+}
+
+/* Appends a little endian value. */
+static void
+fb_put(GByteArray *fb, guint64 value, guint size)
+{
+    guint8 bytes[8];
+
+    for (guint i = 0; i < size; i++) {
+        bytes[i] = (guint8)(value >> (8 * i));
+    }
+    g_byte_array_append(fb, bytes, size);
+}
+
+/* Points the offset field at pos to target. */
+static void
+fb_link(GByteArray *fb, guint pos, guint target)
+{
+    guint32 offset = target - pos;
+
+    for (guint i = 0; i < 4; i++) {
+        fb->data[pos + i] = (guint8)(offset >> (8 * i));
+    }
+}
+
+/*
+ * Writes a table and its vtable. Fields are laid out largest first so that
+ * they're naturally aligned. Returns the position of the table and stores
+ * the positions of the offset fields in pos.
+ */
+static guint
+fb_table(GByteArray *fb, const fb_field *fields, guint nfields, guint *pos)
+{
+    guint16 field_offset[FB_MAX_FIELDS] = { 0 };
+    guint size = 4;     /* soffset to the vtable */
+    guint vtable, table, i, s;
+
+    for (s = 8; s >= 1; s /= 2) {
+        for (i = 0; i < nfields; i++) {
+            if (fields[i].size == s) {
+                field_offset[i] = size;
+                size += s;
+            }
+        }
+    }
+
+    fb_align(fb, 2, 0);
+    vtable = fb->len;
+    fb_put(fb, 4 + 2 * nfields, 2);
+    fb_put(fb, size, 2);
+    for (i = 0; i < nfields; i++) {
+        fb_put(fb, field_offset[i], 2);
+    }
+
+    /* 8 byte fields directly follow the 4 byte soffset. */
+    fb_align(fb, 8, 4);
+    table = fb->len;
+    fb_put(fb, table - vtable, 4);
+    for (s = 8; s >= 1; s /= 2) {
+        for (i = 0; i < nfields; i++) {
+            if (fields[i].size == s) {
+                if (pos) {
+                    pos[i] = fb->len;
+                }
+                fb_put(fb, fields[i].is_offset ? 0 : fields[i].value, s);
+            }
+        }
+    }
+
+    return table;
+}
+
+/* Writes the length of a vector. Returns the position of its first element. */
+static guint
+fb_vector(GByteArray *fb, guint count, guint elem_align)
+{
+    if (elem_align > 4) {
+        fb_align(fb, elem_align, 4);
+    } else {
+        fb_align(fb, 4, 0);
+    }
+    fb_put(fb, count, 4);
+    return fb->len;
+}
+
+static guint
+fb_string(GByteArray *fb, const char *str)
+{
+    guint len = (guint)strlen(str);
+    guint pos;
+
+    fb_align(fb, 4, 0);
+    pos = fb->len;
+    fb_put(fb, len, 4);
+    g_byte_array_append(fb, (const guint8 *)str, len + 1);
+    return pos;
+}
+
+/* Starts a Message. Returns the position of its header field. */
+static guint
+fb_message(GByteArray *fb, guint8 header_type, guint64 body_length)
+{
+    const fb_field fields[] = {
+        { 2, FALSE, ARROW_METADATA_V5 },    /* version */
+        { 1, FALSE, header_type },          /* header_type */
+        { 4, TRUE, 0 },                     /* header */
+        { 8, FALSE, body_length },          /* bodyLength */
+    };
+    guint pos[G_N_ELEMENTS(fields)];
+
+    g_byte_array_set_size(fb, 0);
+    fb_put(fb, 0, 4);   /* root table */
+    fb_link(fb, 0, fb_table(fb, fields, G_N_ELEMENTS(fields), pos));
+    return pos[2];
+}
+
+/* Writes a RecordBatch. nodes and buffers hold pairs of guint64. */
+static guint
+fb_record_batch(GByteArray *fb, guint64 length, GArray *nodes, GArray *buffers)
+{
+    const fb_field fields[] = {
+        { 8, FALSE, length },               /* length */
+        { 4, TRUE, 0 },                     /* nodes */
+        { 4, TRUE, 0 },                     /* buffers */
+    };
+    guint pos[G_N_ELEMENTS(fields)];
+    guint table, vector, i;
+
+    table = fb_table(fb, fields, G_N_ELEMENTS(fields), pos);
+
+    vector = fb_vector(fb, nodes->len / 2, 8);
+    fb_link(fb, pos[1], vector - 4);
+    for (i = 0; i < nodes->len; i++) {
+        fb_put(fb, g_array_index(nodes, guint64, i), 8);
+    }
+
+    vector = fb_vector(fb, buffers->len / 2, 8);
+    fb_link(fb, pos[2], vector - 4);
+    for (i = 0; i < buffers->len; i++) {
+        fb_put(fb, g_array_index(buffers, guint64, i), 8);
+    }
+
+    return table;
+}
+
+/* Writes the Int table used for 64 bit values and dictionary indices. */
+static guint
+fb_int_type(GByteArray *fb, guint bit_width, gboolean is_signed)
+{
+    const fb_field fields[] = {
+        { 4, FALSE, bit_width },            /* bitWidth */
+        { 1, FALSE, is_signed },            /* is_signed */
+    };
+
+    return fb_table(fb, fields, G_N_ELEMENTS(fields), NULL);
+}
+
+static guint8
+arrow_type_id(const arrow_column *column)
+{
+    switch (column->type) {
+    case ARROW_TYPE_UINT64:
+    case ARROW_TYPE_INT64:
+        return ARROW_TYPE_ID_INT;
+    case ARROW_TYPE_DOUBLE:
+        return ARROW_TYPE_ID_FLOAT;
+    case ARROW_TYPE_BOOL:
+        return ARROW_TYPE_ID_BOOL;
+    case ARROW_TYPE_TIMESTAMP:
+        return ARROW_TYPE_ID_TIMESTAMP;
+    case ARROW_TYPE_DURATION:
+        return ARROW_TYPE_ID_DURATION;
+    case ARROW_TYPE_FIXED_BINARY:
+        return ARROW_TYPE_ID_FIXED_BINARY;
+    case ARROW_TYPE_BINARY:
+        return ARROW_TYPE_ID_BINARY;
+    case ARROW_TYPE_STRING:
+        return ARROW_TYPE_ID_UTF8;
+    }
+    ws_assert_not_reached();
+}
+
+static guint
+fb_type(GByteArray *fb, const arrow_column *column)
+{
+    switch (column->type) {
+    case ARROW_TYPE_UINT64:
+        return fb_int_type(fb, 64, FALSE);
+    case ARROW_TYPE_INT64:
+        return fb_int_type(fb, 64, TRUE);
+    case ARROW_TYPE_DOUBLE:
+    {
+        const fb_field fields[] = {
+            { 2, FALSE, ARROW_PRECISION_DOUBLE },   /* precision */
+        };
+        return fb_table(fb, fields, G_N_ELEMENTS(fields), NULL);
+    }
+    case ARROW_TYPE_TIMESTAMP:
+    {
+        const fb_field fields[] = {
+            { 2, FALSE, ARROW_TIME_UNIT_NANOSECOND },   /* unit */
+            { 4, TRUE, 0 },                             /* timezone */
+        };
+        guint pos[G_N_ELEMENTS(fields)];
+        guint table = fb_table(fb, fields, G_N_ELEMENTS(fields), pos);
+        fb_link(fb, pos[1], fb_string(fb, "UTC"));
+        return table;
+    }
+    case ARROW_TYPE_DURATION:
+    {
+        const fb_field fields[] = {
+            { 2, FALSE, ARROW_TIME_UNIT_NANOSECOND },   /* unit */
+        };
+        return fb_table(fb, fields, G_N_ELEMENTS(fields), NULL);
+    }
+    case ARROW_TYPE_FIXED_BINARY:
+    {
+        const fb_field fields[] = {
+            { 4, FALSE, column->width },    /* byteWidth */
+        };
+        return fb_table(fb, fields, G_N_ELEMENTS(fields), NULL);
+    }
+    case ARROW_TYPE_BOOL:
+    case ARROW_TYPE_BINARY:
+    case ARROW_TYPE_STRING:
+        break;
+    }
+    /* No parameters. */
+    return fb_table(fb, NULL, 0, NULL);
+}
+
+static guint
+fb_schema_field(GByteArray *fb, const arrow_column *column, guint index)
+{
+    gboolean is_dict = column->type == ARROW_TYPE_STRING;
+    const fb_field fields[] = {
+        { 4, TRUE, 0 },                         /* name */
+        { 1, FALSE, TRUE },                     /* nullable */
+        { 1, FALSE, arrow_type_id(column) },    /* type_type */
+        { 4, TRUE, 0 },                         /* type */
+        { is_dict ? 4 : 0, TRUE, 0 },           /* dictionary */
+        { 4, TRUE, 0 },                         /* children */
+    };
+    guint pos[G_N_ELEMENTS(fields)];
+    guint table;
+
+    table = fb_table(fb, fields, G_N_ELEMENTS(fields), pos);
+    fb_link(fb, pos[0], fb_string(fb, column->name));
+    fb_link(fb, pos[3], fb_type(fb, column));
+    if (is_dict) {
+        const fb_field dict_fields[] = {
+            { 8, FALSE, index },                /* id */
+            { 4, TRUE, 0 },                     /* indexType */
+        };
+        guint dict_pos[G_N_ELEMENTS(dict_fields)];
+        fb_link(fb, pos[4], fb_table(fb, dict_fields, G_N_ELEMENTS(dict_fields), dict_pos));
+        fb_link(fb, dict_pos[1], fb_int_type(fb, 32, TRUE));
+    }
+    fb_link(fb, pos[5], fb_vector(fb, 0, 4) - 4);
+
+    return table;
+}
+
+/*
+ * Writes an encapsulated message: continuation marker, metadata length,
+ * metadata padded to 8 bytes and the body.
+ */
+static void
+arrow_write_message(arrow_writer *writer, GByteArray *fb, GByteArray *body)
+{
+    GByteArray *prefix = g_byte_array_sized_new(8);
+
+    fb_align(fb, 8, 0);
+    fb_put(prefix, 0xFFFFFFFF, 4);
+    fb_put(prefix, fb->len, 4);
+
+    if (fwrite(prefix->data, 1, prefix->len, writer->fh) != prefix->len ||
+            fwrite(fb->data, 1, fb->len, writer->fh) != fb->len ||
+            (body && fwrite(body->data, 1, body->len, writer->fh) != body->len)) {
+        writer->error = TRUE;
+    }
+    g_byte_array_free(prefix, TRUE);
+}
+
+/* Appends a buffer to a message body, 8 byte aligned. */
+static void
+arrow_add_buffer(GByteArray *body, GArray *buffers, const GByteArray *buffer)
+{
+    guint64 entry[2] = { body->len, buffer ? buffer->len : 0 };
+
+    if (buffer) {
+        g_byte_array_append(body, buffer->data, buffer->len);
+        fb_align(body, 8, 0);
+    }
+    g_array_append_vals(buffers, entry, 2);
+}
+
+static void
+arrow_write_schema(arrow_writer *writer)
+{
+    const fb_field fields[] = {
+        { 2, FALSE, 0 },                    /* endianness: Little */
+        { 4, TRUE, 0 },                     /* fields */
+    };
+    guint pos[G_N_ELEMENTS(fields)];
+    GByteArray *fb = g_byte_array_new();
+    guint header, vector, i;
+
+    header = fb_message(fb, ARROW_HEADER_SCHEMA, 0);
+    fb_link(fb, header, fb_table(fb, fields, G_N_ELEMENTS(fields), pos));
+
+    vector = fb_vector(fb, writer->columns->len, 4);
+    fb_link(fb, pos[1], vector - 4);
+    g_byte_array_set_size(fb, fb->len + 4 * writer->columns->len);
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        fb_link(fb, vector + 4 * i, fb_schema_field(fb, column, i));
+    }
+
+    arrow_write_message(writer, fb, NULL);
+    g_byte_array_free(fb, TRUE);
+    writer->schema_written = TRUE;
+}
+
+/* Writes the dictionary entries added since the last dictionary batch. */
+static void
+arrow_write_dictionary(arrow_writer *writer, arrow_column *column, guint index)
+{
+    guint count = column->dict_offsets->len / 4 - 1;
+    const fb_field fields[] = {
+        { 8, FALSE, index },                /* id */
+        { 4, TRUE, 0 },                     /* data */
+        { 1, FALSE, column->dict_written }, /* isDelta */
+    };
+    guint pos[G_N_ELEMENTS(fields)];
+    GByteArray *fb = g_byte_array_new();
+    GByteArray *body = g_byte_array_new();
+    GArray *nodes = g_array_new(FALSE, FALSE, sizeof(guint64));
+    GArray *buffers = g_array_new(FALSE, FALSE, sizeof(guint64));
+    guint64 node[2] = { count, 0 };
+    guint header;
+
+    g_array_append_vals(nodes, node, 2);
+    arrow_add_buffer(body, buffers, NULL);
+    arrow_add_buffer(body, buffers, column->dict_offsets);
+    arrow_add_buffer(body, buffers, column->dict_data);
+
+    header = fb_message(fb, ARROW_HEADER_DICTIONARY, body->len);
+    fb_link(fb, header, fb_table(fb, fields, G_N_ELEMENTS(fields), pos));
+    fb_link(fb, pos[1], fb_record_batch(fb, count, nodes, buffers));
+    arrow_write_message(writer, fb, body);
+
+    g_array_free(buffers, TRUE);
+    g_array_free(nodes, TRUE);
+    g_byte_array_free(body, TRUE);
+    g_byte_array_free(fb, TRUE);
+
+    g_byte_array_set_size(column->dict_offsets, 0);
+    fb_put(column->dict_offsets, 0, 4);
+    g_byte_array_set_size(column->dict_data, 0);
+    column->dict_written = TRUE;
+}
+
+static void
+arrow_reset_column(arrow_column *column)
+{
+    g_byte_array_set_size(column->validity, 0);
+    g_byte_array_set_size(column->values, 0);
+    column->null_count = 0;
+    if (column->type == ARROW_TYPE_BINARY) {
+        g_byte_array_set_size(column->data, 0);
+        fb_put(column->values, 0, 4);
+    }
+}
+
+static void
+arrow_write_batch(arrow_writer *writer)
+{
+    GByteArray *fb, *body;
+    GArray *nodes, *buffers;
+    guint header, i;
+
+    if (!writer->schema_written) {
+        arrow_write_schema(writer);
+    }
+
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        if (column->type == ARROW_TYPE_STRING &&
+                (!column->dict_written || column->dict_offsets->len > 4)) {
+            arrow_write_dictionary(writer, column, i);
+        }
+    }
+
+    fb = g_byte_array_new();
+    body = g_byte_array_new();
+    nodes = g_array_new(FALSE, FALSE, sizeof(guint64));
+    buffers = g_array_new(FALSE, FALSE, sizeof(guint64));
+
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        guint64 node[2] = { writer->rows, column->null_count };
+
+        g_array_append_vals(nodes, node, 2);
+        arrow_add_buffer(body, buffers, column->null_count ? column->validity : NULL);
+        arrow_add_buffer(body, buffers, column->values);
+        if (column->type == ARROW_TYPE_BINARY) {
+            arrow_add_buffer(body, buffers, column->data);
+        }
+    }
+
+    header = fb_message(fb, ARROW_HEADER_RECORD_BATCH, body->len);
+    fb_link(fb, header, fb_record_batch(fb, writer->rows, nodes, buffers));
+    arrow_write_message(writer, fb, body);
+
+    g_array_free(buffers, TRUE);
+    g_array_free(nodes, TRUE);
+    g_byte_array_free(body, TRUE);
+    g_byte_array_free(fb, TRUE);
+
+    for (i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+        arrow_reset_column(column);
+        if (column->type == ARROW_TYPE_STRING && column->dict_size > ARROW_MAX_DICTIONARY_SIZE) {
+            /* Keep memory bounded for columns with many distinct values. */
+            g_hash_table_remove_all(column->dict);
+            column->dict_size = 0;
+            column->dict_written = FALSE;
+        }
+    }
+    writer->rows = 0;
+}
+
+static void
+bitmap_append(GByteArray *bitmap, guint row, gboolean bit)
+{
+    if (row % 8 == 0) {
+        fb_put(bitmap, 0, 1);
+    }
+    if (bit) {
+        bitmap->data[row / 8] |= 1 << (row % 8);
+    }
+}
+
+static void
+arrow_column_free(gpointer data)
+{
+    arrow_column *column = (arrow_column *)data;
+
+    g_free(column->name);
+    g_byte_array_free(column->validity, TRUE);
+    g_byte_array_free(column->values, TRUE);
+    g_byte_array_free(column->data, TRUE);
+    if (column->dict) {
+        g_hash_table_destroy(column->dict);
+        g_byte_array_free(column->dict_offsets, TRUE);
+        g_byte_array_free(column->dict_data, TRUE);
+    }
+    g_free(column);
+}
+
+arrow_writer *
+arrow_writer_new(FILE *fh, guint batch_rows)
+{
+    arrow_writer *writer = g_new0(arrow_writer, 1);
+
+    writer->fh = fh;
+    writer->batch_rows = batch_rows ? batch_rows : ARROW_DEFAULT_BATCH_ROWS;
+    writer->columns = g_ptr_array_new_with_free_func(arrow_column_free);
+    return writer;
+}
+
+void
+arrow_writer_add_column(arrow_writer *writer, const char *name, arrow_type_e type, guint width)
+{
+    arrow_column *column;
+
+    if (writer->schema_written) {
+        ws_warning("Arrow column %s added after the schema was written", name);
+        return;
+    }
+
+    column = g_new0(arrow_column, 1);
+    column->name = g_strdup(name);
+    column->type = type;
+    column->width = type == ARROW_TYPE_FIXED_BINARY ? width : 0;
+    column->validity = g_byte_array_new();
+    column->values = g_byte_array_new();
+    column->data = g_byte_array_new();
+    if (type == ARROW_TYPE_STRING) {
+        column->dict = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+        column->dict_offsets = g_byte_array_new();
+        column->dict_data = g_byte_array_new();
+        fb_put(column->dict_offsets, 0, 4);
+    }
+    arrow_reset_column(column);
+    g_ptr_array_add(writer->columns, column);
+}
+
+/*
+ * Returns the column if a value of the given type can be set in the
+ * current row and marks it as set.
+ */
+static arrow_column *
+arrow_writer_value(arrow_writer *writer, guint index, arrow_type_e type)
+{
+    arrow_column *column;
+
+    if (index >= writer->columns->len) {
+        return NULL;
+    }
+    column = (arrow_column *)g_ptr_array_index(writer->columns, index);
+    if (column->is_set || column->type != type) {
+        return NULL;
+    }
+    column->is_set = TRUE;
+    bitmap_append(column->validity, writer->rows, TRUE);
+    return column;
+}
+
+void
+arrow_writer_set_uint(arrow_writer *writer, guint column, guint64 value)
+{
+    arrow_column *col = arrow_writer_value(writer, column, ARROW_TYPE_UINT64);
+
+    if (col) {
+        fb_put(col->values, value, 8);
+    }
+}
+
+void
+arrow_writer_set_int(arrow_writer *writer, guint column, gint64 value)
+{
+    arrow_column *col = arrow_writer_value(writer, column, ARROW_TYPE_INT64);
+
+    if (col) {
+        fb_put(col->values, (guint64)value, 8);
+    }
+}
+
+void
+arrow_writer_set_double(arrow_writer *writer, guint column, double value)
+{
+    arrow_column *col = arrow_writer_value(writer, column, ARROW_TYPE_DOUBLE);
+    guint64 bits;
+
+    if (col) {
+        memcpy(&bits, &value, sizeof bits);
+        fb_put(col->values, bits, 8);
+    }
+}
+
+void
+arrow_writer_set_bool(arrow_writer *writer, guint column, gboolean value)
+{
+    arrow_column *col = arrow_writer_value(writer, column, ARROW_TYPE_BOOL);
+
+    if (col) {
+        bitmap_append(col->values, writer->rows, value);
+    }
+}
+
+void
+arrow_writer_set_time(arrow_writer *writer, guint column, gint64 nsecs)
+{
+    arrow_column *col;
+
+    if (column < writer->columns->len &&
+            ((arrow_column *)g_ptr_array_index(writer->columns, column))->type == ARROW_TYPE_DURATION) {
+        col = arrow_writer_value(writer, column, ARROW_TYPE_DURATION);
+    } else {
+        col = arrow_writer_value(writer, column, ARROW_TYPE_TIMESTAMP);
+    }
+    if (col) {
+        fb_put(col->values, (guint64)nsecs, 8);
+    }
+}
+
+void
+arrow_writer_set_bytes(arrow_writer *writer, guint column, const guint8 *value, gsize len)
+{
+    arrow_column *col;
+
+    if (column < writer->columns->len &&
+            ((arrow_column *)g_ptr_array_index(writer->columns, column))->type == ARROW_TYPE_BINARY) {
+        col = arrow_writer_value(writer, column, ARROW_TYPE_BINARY);
+        if (col) {
+            g_byte_array_append(col->data, value, (guint)len);
+            fb_put(col->values, col->data->len, 4);
+        }
+        return;
+    }
+
+    col = arrow_writer_value(writer, column, ARROW_TYPE_FIXED_BINARY);
+    if (col) {
+        guint copy = (guint)MIN(len, col->width);
+        g_byte_array_append(col->values, value, copy);
+        g_byte_array_set_size(col->values, col->values->len + col->width - copy);
+        memset(col->values->data + col->values->len - (col->width - copy), 0, col->width - copy);
+    }
+}
+
+void
+arrow_writer_set_string(arrow_writer *writer, guint column, const char *value)
+{
+    arrow_column *col = arrow_writer_value(writer, column, ARROW_TYPE_STRING);
+    gpointer index;
+
+    if (!col) {
+        return;
+    }
+
+    index = g_hash_table_lookup(col->dict, value);
+    if (!index) {
+        index = GUINT_TO_POINTER(++col->dict_size);
+        g_hash_table_insert(col->dict, g_strdup(value), index);
+        g_byte_array_append(col->dict_data, (const guint8 *)value, (guint)strlen(value));
+        fb_put(col->dict_offsets, col->dict_data->len, 4);
+    }
+    fb_put(col->values, GPOINTER_TO_UINT(index) - 1, 4);
+}
+
+void
+arrow_writer_end_row(arrow_writer *writer)
+{
+    static const guint8 zeros[8];
+
+    if (!writer->schema_written) {
+        arrow_write_schema(writer);
+    }
+
+    for (guint i = 0; i < writer->columns->len; i++) {
+        arrow_column *column = (arrow_column *)g_ptr_array_index(writer->columns, i);
+
+        if (column->is_set) {
+            column->is_set = FALSE;
+            continue;
+        }
+
+        /* Null, with a placeholder value. */
+        bitmap_append(column->validity, writer->rows, FALSE);
+        column->null_count++;
+        switch (column->type) {
+        case ARROW_TYPE_UINT64:
+        case ARROW_TYPE_INT64:
+        case ARROW_TYPE_DOUBLE:
+        case ARROW_TYPE_TIMESTAMP:
+        case ARROW_TYPE_DURATION:
+            g_byte_array_append(column->values, zeros, 8);
+            break;
+        case ARROW_TYPE_BOOL:
+            bitmap_append(column->values, writer->rows, FALSE);
+            break;
+        case ARROW_TYPE_FIXED_BINARY:
+            g_byte_array_set_size(column->values, column->values->len + column->width);
+            memset(column->values->data + column->values->len - column->width, 0, column->width);
+            break;
+        case ARROW_TYPE_BINARY:
+            fb_put(column->values, column->data->len, 4);
+            break;
+        case ARROW_TYPE_STRING:
+            g_byte_array_append(column->values, zeros, 4);
+            break;
+        }
+    }
+
+    if (++writer->rows >= writer->batch_rows) {
+        arrow_write_batch(writer);
+    }
+}
+
+gboolean
+arrow_writer_finish(arrow_writer *writer)
+{
+    gboolean ok;
+
+    if (writer->rows > 0) {
+        arrow_write_batch(writer);
+    }
+    if (!writer->schema_written) {
+        arrow_write_schema(writer);
+    }
+
+    /* End-of-stream marker */
+    {
+        GByteArray *eos = g_byte_array_sized_new(8);
+        fb_put(eos, 0xFFFFFFFF, 4);
+        fb_put(eos, 0, 4);
+        if (fwrite(eos->data, 1, eos->len, writer->fh) != eos->len) {
+            writer->error = TRUE;
+        }
+        g_byte_array_free(eos, TRUE);
+    }
+
+    ok = !writer->error;
+    g_ptr_array_free(writer->columns, TRUE);
+    g_free(writer);
+    return ok;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,133 @@
+/* arrow_ipc.h
+ * Routines for writing tables in the Apache Arrow IPC streaming format.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __ARROW_IPC_H__
+#define __ARROW_IPC_H__
+
+#include "ws_symbol_export.h"
+#include <glib.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Writes a table as an Arrow IPC stream
+ * (https://arrow.apache.org/docs/format/Columnar.html#ipc-streaming-format)
+ * which can be read by pyarrow, Polars, DuckDB and friends.
+ *
+ * Rows are collected into record batches of a fixed number of rows. All
+ * columns are nullable; a column that isn't set in a row is null. String
+ * columns are dictionary encoded, new dictionary entries are written as
+ * delta dictionary batches before each record batch.
+ *
+ * Example:
+ *
+ *  arrow_writer *writer = arrow_writer_new(stdout, 0);
+ *  arrow_writer_add_column(writer, "frame.number", ARROW_TYPE_UINT64, 0);
+ *  arrow_writer_add_column(writer, "ip.src", ARROW_TYPE_FIXED_BINARY, 4);
+ *  arrow_writer_set_uint(writer, 0, 1);
+ *  arrow_writer_set_bytes(writer, 1, addr, 4);
+ *  arrow_writer_end_row(writer);
+ *  arrow_writer_finish(writer);
+ */
+
+typedef enum {
+    ARROW_TYPE_UINT64,
+    ARROW_TYPE_INT64,
+    ARROW_TYPE_DOUBLE,
+    ARROW_TYPE_BOOL,
+    ARROW_TYPE_TIMESTAMP,       /**< Nanoseconds since the Epoch, UTC */
+    ARROW_TYPE_DURATION,        /**< Nanoseconds */
+    ARROW_TYPE_FIXED_BINARY,    /**< Fixed width byte string, e.g. addresses */
+    ARROW_TYPE_BINARY,
+    ARROW_TYPE_STRING,          /**< UTF-8, dictionary encoded */
+} arrow_type_e;
+
+typedef struct arrow_writer arrow_writer;
+
+/**
+ * Creates a writer for the given file. batch_rows is the number of rows per
+ * record batch, 0 selects a default.
+ */
+WS_DLL_PUBLIC arrow_writer *
+arrow_writer_new(FILE *fh, guint batch_rows);
+
+/**
+ * Adds a column. width is the byte width of ARROW_TYPE_FIXED_BINARY columns
+ * and is ignored otherwise. All columns must be added before the first row
+ * is ended.
+ */
+WS_DLL_PUBLIC void
+arrow_writer_add_column(arrow_writer *writer, const char *name, arrow_type_e type, guint width);
+
+/*
+ * Set the value of a column in the current row. Only the first value set
+ * for a column in a row is kept.
+ */
+WS_DLL_PUBLIC void
+arrow_writer_set_uint(arrow_writer *writer, guint column, guint64 value);
+
+WS_DLL_PUBLIC void
+arrow_writer_set_int(arrow_writer *writer, guint column, gint64 value);
+
+WS_DLL_PUBLIC void
+arrow_writer_set_double(arrow_writer *writer, guint column, double value);
+
+WS_DLL_PUBLIC void
+arrow_writer_set_bool(arrow_writer *writer, guint column, gboolean value);
+
+/** For ARROW_TYPE_TIMESTAMP and ARROW_TYPE_DURATION columns. */
+WS_DLL_PUBLIC void
+arrow_writer_set_time(arrow_writer *writer, guint column, gint64 nsecs);
+
+/**
+ * For ARROW_TYPE_FIXED_BINARY and ARROW_TYPE_BINARY columns. Values of
+ * fixed width columns are truncated or zero padded to the column width.
+ */
+WS_DLL_PUBLIC void
+arrow_writer_set_bytes(arrow_writer *writer, guint column, const guint8 *value, gsize len);
+
+WS_DLL_PUBLIC void
+arrow_writer_set_string(arrow_writer *writer, guint column, const char *value);
+
+/**
+ * Ends the current row. Writes the schema before the first row and a
+ * record batch whenever enough rows have been collected.
+ */
+WS_DLL_PUBLIC void
+arrow_writer_end_row(arrow_writer *writer);
+
+/**
+ * Writes the remaining rows and the end-of-stream marker and frees the
+ * writer. Returns FALSE if writing failed.
+ */
+WS_DLL_PUBLIC gboolean
+arrow_writer_finish(arrow_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ARROW_IPC_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
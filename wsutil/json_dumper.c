@@ -59,23 +59,34 @@ json_puts_string(FILE *fp, const char *str, gboolean dot_to_underscore)
     };
 
     fputc('"', fp);
-    for (int i = 0; str[i]; i++) {
-        if ((guint)str[i] < 0x20) {
+    /* Write the runs between characters that need special treatment in
+     * one go instead of one character at a time. */
+    const char *run = str;
+    const char *p;
+    for (p = str; *p; p++) {
+        guchar c = (guchar)*p;
+        if (c >= 0x20 && c != '\\' && c != '"' && c != '/' && !(dot_to_underscore && c == '.')) {
+            continue;
+        }
+        fwrite(run, 1, p - run, fp);
+        run = p + 1;
+        if (c < 0x20) {
             fputc('\\', fp);
-            fputs(json_cntrl[(guint)str[i]], fp);
-        } else if (i > 0 && str[i - 1] == '<' && str[i] == '/') {
+            fputs(json_cntrl[c], fp);
+        } else if (c == '/') {
             // Convert </script> to <\/script> to avoid breaking web pages.
-            fputs("\\/", fp);
-        } else {
-            if (str[i] == '\\' || str[i] == '"') {
+            if (p > str && p[-1] == '<') {
                 fputc('\\', fp);
             }
-            if (dot_to_underscore && str[i] == '.')
-                fputc('_', fp);
-            else
-                fputc(str[i], fp);
+            fputc('/', fp);
+        } else if (c == '.') {
+            fputc('_', fp);
+        } else {
+            fputc('\\', fp);
+            fputc(c, fp);
         }
     }
+    fwrite(run, 1, p - run, fp);
     fputc('"', fp);
 }
 
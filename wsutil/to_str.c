@@ -177,12 +177,26 @@ qword_to_hex_punct(char *out, guint64 qword, char punct)
 char *
 bytes_to_hexstr(char *out, const guint8 *ad, size_t len)
 {
+	/* Both digits of every octet, so that we do one lookup and one
+	   2-byte copy per octet instead of two nibble lookups. */
+	static const char hex_pairs[256][2] = {
+#define HEX_PAIRS_ROW(h) \
+		{h,'0'},{h,'1'},{h,'2'},{h,'3'},{h,'4'},{h,'5'},{h,'6'},{h,'7'}, \
+		{h,'8'},{h,'9'},{h,'a'},{h,'b'},{h,'c'},{h,'d'},{h,'e'},{h,'f'}
+		HEX_PAIRS_ROW('0'), HEX_PAIRS_ROW('1'), HEX_PAIRS_ROW('2'), HEX_PAIRS_ROW('3'),
+		HEX_PAIRS_ROW('4'), HEX_PAIRS_ROW('5'), HEX_PAIRS_ROW('6'), HEX_PAIRS_ROW('7'),
+		HEX_PAIRS_ROW('8'), HEX_PAIRS_ROW('9'), HEX_PAIRS_ROW('a'), HEX_PAIRS_ROW('b'),
+		HEX_PAIRS_ROW('c'), HEX_PAIRS_ROW('d'), HEX_PAIRS_ROW('e'), HEX_PAIRS_ROW('f')
+#undef HEX_PAIRS_ROW
+	};
 	size_t i;
 
 	ws_return_ptr_if_null(ad, NULL);
 
-	for (i = 0; i < len; i++)
-		out = byte_to_hex(out, ad[i]);
+	for (i = 0; i < len; i++) {
+		memcpy(out, hex_pairs[ad[i]], 2);
+		out += 2;
+	}
 	return out;
 }
 
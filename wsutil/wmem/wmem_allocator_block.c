@@ -199,6 +199,7 @@ typedef struct _wmem_block_allocator_t {
     wmem_block_hdr_t   *block_list;
     wmem_block_chunk_t *master_head;
     wmem_block_chunk_t *recycler_head;
+    size_t              block_count; /* regular (non-jumbo) blocks */
 } wmem_block_allocator_t;
 
 /* DEBUG AND TEST */
@@ -764,6 +765,7 @@ wmem_block_new_block(wmem_block_allocator_t *allocator)
     /* allocate the new block and add it to the block list */
     block = (wmem_block_hdr_t *)wmem_alloc(NULL, WMEM_BLOCK_SIZE);
     wmem_block_add_to_block_list(allocator, block);
+    allocator->block_count++;
 
     /* initialize it */
     wmem_block_init_block(allocator, block);
@@ -1068,6 +1070,7 @@ wmem_block_gc(void *private_data)
                 allocator->master_head = free_chunk->next;
             }
             wmem_free(NULL, cur);
+            allocator->block_count--;
         }
         else {
             /* part of this block is used, so add it to the new block list */
@@ -1109,6 +1112,17 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     block_allocator->block_list    = NULL;
     block_allocator->master_head   = NULL;
     block_allocator->recycler_head = NULL;
+    block_allocator->block_count   = 0;
+}
+
+size_t
+wmem_block_allocator_size(wmem_allocator_t *allocator)
+{
+    wmem_block_allocator_t *block_allocator =
+        (wmem_block_allocator_t*) allocator->private_data;
+
+    /* Jumbo blocks are rare and don't record their size, leave them out */
+    return block_allocator->block_count * WMEM_BLOCK_SIZE;
 }
 
 /*
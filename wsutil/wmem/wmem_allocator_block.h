@@ -21,6 +21,10 @@ extern "C" {
 void
 wmem_block_allocator_init(wmem_allocator_t *allocator);
 
+/* Size of the regular (non-jumbo) blocks held by the allocator, in bytes */
+size_t
+wmem_block_allocator_size(wmem_allocator_t *allocator);
+
 /* Exposed only for testing purposes */
 void
 wmem_block_verify(wmem_allocator_t *allocator);
@@ -116,6 +116,15 @@ wmem_gc(wmem_allocator_t *allocator)
     allocator->gc(allocator->private_data);
 }
 
+size_t
+wmem_memory_in_use(wmem_allocator_t *allocator)
+{
+    if (allocator->type == WMEM_ALLOCATOR_BLOCK) {
+        return wmem_block_allocator_size(allocator);
+    }
+    return 0;
+}
+
 void
 wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
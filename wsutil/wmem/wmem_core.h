@@ -181,6 +181,18 @@ WS_DLL_PUBLIC
 void
 wmem_gc(wmem_allocator_t *allocator);
 
+/** Returns the size of the regular blocks a block allocator currently holds
+ * from the operating system. Allocations too large for a regular block
+ * ("jumbo" allocations) are not included. Other allocator types don't keep
+ * track of this, and 0 is returned for them.
+ *
+ * @param allocator The allocator to check.
+ * @return The size in bytes.
+ */
+WS_DLL_PUBLIC
+size_t
+wmem_memory_in_use(wmem_allocator_t *allocator);
+
 /** Destroy the given allocator, freeing all memory allocated in it. Once this
  * function has been called, no memory allocated with the allocator is valid.
  *
@@ -337,12 +337,31 @@ wmem_test_allocator(wmem_allocator_type_t type, wmem_verify_func verify,
     wmem_destroy_allocator(allocator);
 }
 
+static void
+wmem_test_allocator_block_size(void)
+{
+    wmem_allocator_t *allocator;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    g_assert_true(wmem_memory_in_use(allocator) == 0);
+
+    wmem_alloc(allocator, 8);
+    g_assert_true(wmem_memory_in_use(allocator) > 0);
+
+    wmem_free_all(allocator);
+    wmem_gc(allocator);
+    g_assert_true(wmem_memory_in_use(allocator) == 0);
+
+    wmem_destroy_allocator(allocator);
+}
+
 static void
 wmem_test_allocator_block(void)
 {
     wmem_test_allocator(WMEM_ALLOCATOR_BLOCK, &wmem_block_verify,
             MAX_SIMULTANEOUS_ALLOCS*64);
     wmem_test_allocator_jumbo(WMEM_ALLOCATOR_BLOCK, &wmem_block_verify);
+    wmem_test_allocator_block_size();
 }
 
 static void
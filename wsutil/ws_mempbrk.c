@@ -23,6 +23,7 @@
 #endif
 
 #include <glib.h>
+#include <string.h>
 #include "ws_symbol_export.h"
 #include "ws_mempbrk.h"
 #include "ws_mempbrk_int.h"
@@ -36,6 +37,9 @@ ws_mempbrk_compile(ws_mempbrk_pattern* pattern, const gchar *needles)
         n++;
     }
 
+    /* memchr() is usually faster than any of the below for one needle */
+    pattern->single_needle = (n - needles == 1) ? (guchar)needles[0] : -1;
+
 #ifdef HAVE_SSE4_2
     ws_mempbrk_sse42_compile(pattern, needles);
 #endif
@@ -63,6 +67,13 @@ ws_mempbrk_portable_exec(const guint8* haystack, size_t haystacklen, const ws_me
 WS_DLL_PUBLIC const guint8 *
 ws_mempbrk_exec(const guint8* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, guchar *found_needle)
 {
+    if (pattern->single_needle >= 0) {
+        const guint8 *result = (const guint8 *)memchr(haystack, pattern->single_needle, haystacklen);
+        if (result && found_needle)
+            *found_needle = *result;
+        return result;
+    }
+
 #ifdef HAVE_SSE4_2
     if (haystacklen >= 16 && pattern->use_sse42)
         return ws_mempbrk_sse42_exec(haystack, haystacklen, pattern, found_needle);
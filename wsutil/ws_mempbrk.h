@@ -20,6 +20,7 @@
  */
 typedef struct {
     gchar patt[256];
+    gint single_needle; /* the needle if there is only one, otherwise -1 */
 #ifdef HAVE_SSE4_2
     gboolean use_sse42;
     __m128i mask;